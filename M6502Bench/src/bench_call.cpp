@@ -0,0 +1,76 @@
+/*
+ * CPU::Call against a JSR stub run with Execute
+ *
+ *  M6502BenchCall [calls]
+ *
+ * Calls a short routine many times, once through Call and once the manual
+ * way: a JSR stub followed by a jam byte, run with a guessed budget and
+ * checked for having come back. Reports nanoseconds per call.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include "../../M6502Lib/src/m6502.h"
+
+using namespace m6502;
+
+namespace
+{
+    const Byte ROUTINE[] =
+    {
+        // 0x0300
+        CPU::INS_LDA_ZPX, 0x10,
+        CPU::INS_STA_ABS, 0x00, 0x40,
+        CPU::INS_RTS,
+    };
+
+    // JSR $0300, then a jam byte so Execute ends as soon as the routine is back
+    const Byte STUB[] = { CPU::INS_JSR, 0x00, 0x03, 0x02 };
+
+    // The guessed budget, enough for the routine and the stub
+    constexpr s32 STUB_BUDGET = 64;
+
+    template <typename CallFn>
+    void Measure(const char* Name, u32 Calls, CallFn Run)
+    {
+        const auto Begin = std::chrono::steady_clock::now();
+        u32 Returned = 0;
+        for (u32 i = 0; i < Calls; i++)
+        {
+            Returned += Run((Byte)i);
+        }
+        const std::chrono::duration<double, std::nano> Elapsed = std::chrono::steady_clock::now() - Begin;
+        printf("%-14s %8.1f ns/call  %u/%u returned\n", Name, Elapsed.count() / Calls, Returned, Calls);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Calls = argc > 1 ? (u32)atoi(argv[1]) : 10000000;
+
+    auto memory = std::make_unique<Mem>();
+    CPU cpu;
+    cpu.Reset(0x0200, *memory);
+    cpu.ThrowOnIllegalOpcode = false;
+    memory->Load(0x0300, ROUTINE, sizeof(ROUTINE));
+    memory->Load(0x0200, STUB, sizeof(STUB));
+
+    Measure("JSR stub", Calls, [&](Byte X)
+    {
+        cpu.PC = 0x0200;
+        cpu.X = X;
+        cpu.Jammed = false;
+        cpu.Execute(STUB_BUDGET, *memory);
+        return cpu.Jammed && cpu.PC == 0x0203;
+    });
+
+    cpu.Jammed = false;
+    Measure("Call", Calls, [&](Byte X)
+    {
+        CPU::CallRegisters In;
+        In.X = X;
+        return cpu.Call(0x0300, In, *memory).Returned;
+    });
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * Code map and disassembly over a megabyte of images
+ *
+ *  M6502BenchDisasm [images]
+ *
+ * Generates images of random routines (loads and stores, JSRs between
+ * routines, jumps closing loops) with data tables in between and the
+ * vectors pointing at routines, then times CodeMap::Analyse and Listing
+ * over all of them. 16 images of 64 KiB make the megabyte.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../../M6502Lib/src/m6502_disasm.h"
+
+using namespace m6502;
+
+namespace
+{
+    std::vector<Byte> MakeImage(std::mt19937& Random)
+    {
+        std::vector<Byte> Image(Mem::MAX_MEM);
+        std::vector<const OpcodeInfo*> Straight;
+        for (const OpcodeInfo& Info : OpcodeInfo::All())
+        {
+            if ((Info.Type == OpcodeKind::Load || Info.Type == OpcodeKind::Store) && (Info.Variants & 1))
+            {
+                Straight.push_back(&Info);
+            }
+        }
+
+        // Routines first so calls can go to any of them
+        std::vector<Word> Routines;
+        for (u32 Address = 0x0400; Address < 0xFF00; Address += 96 + Random() % 96)
+        {
+            Routines.push_back((Word)Address);
+        }
+        for (size_t r = 0; r < Routines.size(); r++)
+        {
+            const u32 End = (r + 1 < Routines.size() ? Routines[r + 1] : 0xFFF0) - 40;
+            u32 PC = Routines[r];
+            while (PC < End)
+            {
+                const u32 Pick = Random() % 16;
+                if (Pick == 0)
+                {
+                    const Word Target = Routines[Random() % Routines.size()];
+                    Image[PC++] = CPU::INS_JSR;
+                    Image[PC++] = Target & 0xFF;
+                    Image[PC++] = Target >> 8;
+                }
+                else
+                {
+                    const OpcodeInfo& Info = *Straight[Random() % Straight.size()];
+                    Image[PC] = Info.Opcode;
+                    for (u32 i = 1; i < Info.Length(); i++)
+                    {
+                        Image[PC + i] = (Byte)Random();
+                    }
+                    PC += Info.Length();
+                }
+            }
+            // Most routines return, some loop back to their start, the rest of the gap is a table
+            if (Random() % 4)
+            {
+                Image[PC++] = CPU::INS_RTS;
+            }
+            else
+            {
+                Image[PC++] = CPU::INS_JMP_ABS;
+                Image[PC++] = Routines[r] & 0xFF;
+                Image[PC++] = Routines[r] >> 8;
+            }
+            while (PC < End + 40)
+            {
+                Image[PC++] = (Byte)Random();
+            }
+        }
+        for (Word Vector : { CodeMap::NMI_VECTOR, CodeMap::RESET_VECTOR, CodeMap::IRQ_VECTOR })
+        {
+            const Word Target = Routines[Random() % Routines.size()];
+            Image[Vector] = Target & 0xFF;
+            Image[Vector + 1] = Target >> 8;
+        }
+        return Image;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 NumImages = argc > 1 ? (u32)atoi(argv[1]) : 16;
+    std::mt19937 Random(6502);
+    std::vector<std::vector<Byte>> Images;
+    for (u32 i = 0; i < NumImages; i++)
+    {
+        Images.push_back(MakeImage(Random));
+    }
+
+    CodeMap Map;
+    size_t Blocks = 0, ListingBytes = 0;
+    using Clock = std::chrono::steady_clock;
+    Clock::duration Analysing{}, Listing{};
+    for (const std::vector<Byte>& Image : Images)
+    {
+        const Clock::time_point Begin = Clock::now();
+        Map.Analyse(Image.data(), CodeMap::VectorEntries(Image.data()));
+        const Clock::time_point Analysed = Clock::now();
+        ListingBytes += Map.Listing(Image.data()).size();
+        Listing += Clock::now() - Analysed;
+        Analysing += Analysed - Begin;
+        Blocks += Map.Blocks.size();
+    }
+
+    const double Mib = NumImages * (double)Mem::MAX_MEM / (1024 * 1024);
+    printf("%u images (%.2f MiB), %zu blocks, %zu bytes of listing\n", NumImages, Mib, Blocks, ListingBytes);
+    printf("analyse  %8.2f ms\n", std::chrono::duration<double, std::milli>(Analysing).count());
+    printf("listing  %8.2f ms\n", std::chrono::duration<double, std::milli>(Listing).count());
+    return 0;
+}
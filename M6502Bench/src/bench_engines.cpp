@@ -0,0 +1,75 @@
+/*
+ * Cost of switching engines
+ *
+ *  M6502BenchEngines [slices]
+ *
+ * Runs short slices of a store loop through an EngineSwitch without
+ * switching, with a switch between the fast and the exact engine in every
+ * slice, with a switch at a PC armed (the engine runs in its stopping form,
+ * with a PC compare per instruction) and with a switch in and out of the
+ * ticked engine, and reports
+ * the time per slice. The difference to the first is what a switch costs.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../../M6502Lib/src/m6502_engines.h"
+
+using namespace m6502;
+
+namespace
+{
+    constexpr s32 SLICE = 100;
+
+    const Byte PROGRAM[] =
+    {
+        CPU::INS_LDA_IM, 0x42,
+        CPU::INS_STA_ZP, 0x10,
+        CPU::INS_LDA_ABS, 0x00, 0x30,
+        CPU::INS_STA_ABS, 0x00, 0x40,
+        CPU::INS_JMP_ABS, 0x00, 0x02,
+    };
+
+    template <typename SliceFn>
+    void Measure(const char* Name, u32 Slices, SliceFn Slice)
+    {
+        const auto Begin = std::chrono::steady_clock::now();
+        for (u32 i = 0; i < Slices; i++)
+        {
+            Slice(i);
+        }
+        const std::chrono::duration<double, std::nano> Elapsed = std::chrono::steady_clock::now() - Begin;
+        printf("%-28s %8.1f ns per slice\n", Name, Elapsed.count() / Slices);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Slices = argc > 1 ? (u32)atoi(argv[1]) : 1000000;
+    Mem memory;
+    CPU cpu;
+    cpu.Reset(0x0200, memory);
+    memory.Load(0x0200, PROGRAM, sizeof(PROGRAM));
+    EngineSwitch Machine(cpu, memory, Engine::Fast);
+
+    Measure("no switch", Slices, [&](u32) { Machine.Run(SLICE); });
+    Measure("fast <-> exact each slice", Slices, [&](u32 i)
+    {
+        Machine.SwitchAtCycle(i & 1 ? Engine::Fast : Engine::Exact, Machine.Cycles + SLICE / 2);
+        Machine.Run(SLICE);
+    });
+    Measure("switch at a PC armed", Slices, [&](u32)
+    {
+        // Never reached, so every slice runs ExecuteFusedTo
+        Machine.SwitchAtPC(Engine::Exact, 0x0300);
+        Machine.Run(SLICE);
+    });
+    Machine.SwitchAtPC(Engine::Fast, 0x0300);
+    Measure("ticked <-> exact", Slices, [&](u32 i)
+    {
+        Machine.SwitchAtCycle(i & 1 ? Engine::Ticked : Engine::Exact, Machine.Cycles + SLICE / 2);
+        Machine.Run(SLICE);
+    });
+    printf("%llu switches\n", (unsigned long long)Machine.Switches);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * CPU::ExecuteFused against CPU::Execute
+ *
+ *  M6502BenchFusion [cycles]
+ *
+ * Runs a copy loop built from the fused patterns (set up registers, call a
+ * routine that moves bytes with immediate/absolute loads and stores) on both
+ * engines, checks they end in the same state and reports emulated MHz. Also
+ * prints the hottest opcode pairs of the workload as OpcodeProfile sees them.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_opcodeprofile.h"
+
+using namespace m6502;
+
+namespace
+{
+    const Byte PROGRAM[] =
+    {
+        // 0x0200
+        CPU::INS_LDX_IM, 0x04,
+        CPU::INS_LDY_IM, 0x10,
+        CPU::INS_JSR, 0x00, 0x03,
+        CPU::INS_JMP_ABS, 0x00, 0x02,
+    };
+
+    const Byte ROUTINE[] =
+    {
+        // 0x0300
+        CPU::INS_LDA_IM, 0x01,
+        CPU::INS_STA_ZP, 0x20,
+        CPU::INS_LDA_IM, 0x02,
+        CPU::INS_STA_ABS, 0x00, 0x40,
+        CPU::INS_LDA_ZPX, 0x1C,
+        CPU::INS_STA_ABSY, 0x00, 0x41,
+        CPU::INS_LDA_ABS, 0x00, 0x40,
+        CPU::INS_STA_ABS, 0x01, 0x40,
+        CPU::INS_RTS,
+    };
+
+    void Setup(CPU& cpu, Mem& memory)
+    {
+        cpu.Reset(0x0200, memory);
+        memory.Load(0x0200, PROGRAM, sizeof(PROGRAM));
+        memory.Load(0x0300, ROUTINE, sizeof(ROUTINE));
+    }
+
+    template <typename RunFn>
+    double Measure(const char* Name, s32 Cycles, CPU& cpu, Mem& memory, RunFn Run)
+    {
+        Setup(cpu, memory);
+        const auto Begin = std::chrono::steady_clock::now();
+        const s32 Used = Run(cpu, memory, Cycles);
+        const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Begin;
+        const double Mhz = Used / Elapsed.count() / 1e6;
+        printf("%-14s %9.1f ms %8.1f MHz\n", Name, Elapsed.count() * 1e3, Mhz);
+        return Mhz;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const s32 Cycles = argc > 1 ? atoi(argv[1]) : 200000000;
+
+    auto PlainMem = std::make_unique<Mem>();
+    auto FusedMem = std::make_unique<Mem>();
+    CPU Plain, Fused;
+
+    const double PlainMhz = Measure("Execute", Cycles, Plain, *PlainMem,
+        [](CPU& cpu, Mem& memory, s32 Budget) { return cpu.Execute(Budget, memory); });
+    const double FusedMhz = Measure("ExecuteFused", Cycles, Fused, *FusedMem,
+        [](CPU& cpu, Mem& memory, s32 Budget) { return cpu.ExecuteFused(Budget, memory); });
+    printf("speedup %.2fx\n", FusedMhz / PlainMhz);
+
+    const bool Same = Plain.PC == Fused.PC && Plain.SP == Fused.SP && Plain.A == Fused.A
+        && Plain.X == Fused.X && Plain.Y == Fused.Y && Plain.PS == Fused.PS
+        && memcmp(PlainMem->Data, FusedMem->Data, Mem::MAX_MEM) == 0;
+    if (!Same)
+    {
+        printf("MISMATCH between Execute and ExecuteFused\n");
+        return 1;
+    }
+
+    auto Profile = std::make_unique<OpcodeProfile>();
+    Setup(Plain, *PlainMem);
+    Profile->Record(Plain, *PlainMem, 1000000);
+    printf("top pairs:\n");
+    for (const OpcodeProfile::PairCount& Pair : Profile->TopPairs(8))
+    {
+        printf("  %02X %02X %10llu\n", Pair.First, Pair.Second, (unsigned long long)Pair.Count);
+    }
+    return 0;
+}
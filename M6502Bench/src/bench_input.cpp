@@ -0,0 +1,79 @@
+/*
+ * Cost of running slices through an InputQueue
+ *
+ *  M6502BenchInput [slices]
+ *
+ * Runs the same copy loop with plain Execute, through an empty queue, and
+ * through a queue fed by a producer thread with an event every 1000
+ * emulated cycles, and reports emulated MHz for each.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "../../M6502Lib/src/m6502_input.h"
+
+using namespace m6502;
+
+namespace
+{
+    constexpr s32 SLICE = 10000;
+    constexpr u64 EVENT_SPACING = 1000;
+
+    const Byte PROGRAM[] =
+    {
+        CPU::INS_LDA_ABS, 0x00, 0x40,
+        CPU::INS_STA_ABS, 0x00, 0x50,
+        CPU::INS_JMP_ABS, 0x00, 0x02,
+    };
+
+    template <typename RunFn>
+    void Measure(const char* Name, u32 Slices, RunFn Run)
+    {
+        const auto Begin = std::chrono::steady_clock::now();
+        u64 Cycles = 0;
+        for (u32 i = 0; i < Slices; i++)
+        {
+            Cycles += Run();
+        }
+        const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Begin;
+        printf("%-20s %8.1f MHz\n", Name, Cycles / Elapsed.count() / 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Slices = argc > 1 ? (u32)atoi(argv[1]) : 20000;
+    Mem memory;
+    CPU cpu;
+    cpu.Reset(0x0200, memory);
+    memory.Load(0x0200, PROGRAM, sizeof(PROGRAM));
+
+    Measure("Execute", Slices, [&] { return cpu.Execute(SLICE, memory); });
+
+    InputQueue Empty;
+    Measure("empty queue", Slices, [&] { return Empty.Execute(cpu, memory, SLICE); });
+
+    InputQueue Fed;
+    std::atomic<bool> Done{ false };
+    std::thread Producer([&]
+    {
+        u64 Cycle = 0;
+        while (!Done)
+        {
+            if (Fed.Push({ Cycle, 0x4000, (Byte)Cycle }))
+            {
+                Cycle += EVENT_SPACING;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    Measure("event every 1000", Slices, [&] { return Fed.Execute(cpu, memory, SLICE); });
+    Done = true;
+    Producer.join();
+    return 0;
+}
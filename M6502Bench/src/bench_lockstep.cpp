@@ -0,0 +1,91 @@
+/*
+ * LockstepSystem, a thread per CPU against the serial reference
+ *
+ *  M6502BenchLockstep [cpus] [total cycles per cpu]
+ *
+ * Runs CPUs that keep reading each other's writes for a range of quantum
+ * sizes, threaded and serial, checks both end with the same memory and
+ * reports the combined emulated MHz. Threaded runs only scale up to the
+ * number of cores.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_lockstep.h"
+
+using namespace m6502;
+
+namespace
+{
+    void Load(Mem& memory, u32 NumCpus)
+    {
+        memory.Initialise();
+        for (u32 Index = 0; Index < NumCpus; Index++)
+        {
+            const Byte Program[] =
+            {
+                CPU::INS_LDX_ZP, (Byte)(0x20 + Index),
+                CPU::INS_STX_ZP, (Byte)(0x21 + Index),
+                CPU::INS_LDA_ABS, (Byte)(Index * 16), 0x30,
+                CPU::INS_STA_ABS, (Byte)(Index * 16 + 1), 0x30,
+                CPU::INS_LDY_ZP, 0x20,
+                CPU::INS_STY_ZPX, 0x40,
+                CPU::INS_JMP_ABS, 0x00, (Byte)(0x10 + Index),
+            };
+            memory.Load((Word)((0x10 + Index) << 8), Program, sizeof(Program));
+        }
+    }
+
+    template <typename RunFn>
+    double Measure(const char* Name, u32 NumCpus, s32 Quantum, u32 Quanta, Mem& memory, RunFn Run)
+    {
+        Load(memory, NumCpus);
+        LockstepSystem System(memory, Quantum);
+        for (u32 Index = 0; Index < NumCpus; Index++)
+        {
+            CPU cpu;
+            cpu.PC = (Word)((0x10 + Index) << 8);
+            cpu.SP = 0xFF;
+            cpu.PS = 0;
+            cpu.A = cpu.X = cpu.Y = 0;
+            System.Add(cpu);
+        }
+        const auto Begin = std::chrono::steady_clock::now();
+        Run(System, Quanta);
+        const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Begin;
+        const double Mhz = (double)Quantum * Quanta * NumCpus / Elapsed.count() / 1e6;
+        printf("  %-8s %9.1f ms %8.1f MHz\n", Name, Elapsed.count() * 1e3, Mhz);
+        return Mhz;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 NumCpus = argc > 1 ? (u32)atoi(argv[1]) : 2;
+    const u64 Cycles = argc > 2 ? strtoull(argv[2], nullptr, 10) : 20000000;
+    printf("%u CPUs, %u hardware threads\n", NumCpus, std::thread::hardware_concurrency());
+
+    auto Threaded = std::make_unique<Mem>();
+    auto Serial = std::make_unique<Mem>();
+    for (s32 Quantum : { 100, 1000, 10000, 100000 })
+    {
+        const u32 Quanta = (u32)(Cycles / Quantum);
+        printf("quantum %d\n", Quantum);
+        const double SerialMhz = Measure("serial", NumCpus, Quantum, Quanta, *Serial,
+            [](LockstepSystem& System, u32 Quanta) { System.RunSerial(Quanta); });
+        const double ThreadedMhz = Measure("threaded", NumCpus, Quantum, Quanta, *Threaded,
+            [](LockstepSystem& System, u32 Quanta) { System.Run(Quanta); });
+        printf("  speedup %.2fx\n", ThreadedMhz / SerialMhz);
+
+        if (memcmp(Threaded->Data, Serial->Data, Mem::MAX_MEM) != 0)
+        {
+            printf("MISMATCH between the threaded and serial runs\n");
+            return 1;
+        }
+    }
+    return 0;
+}
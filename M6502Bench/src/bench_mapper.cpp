@@ -0,0 +1,71 @@
+/*
+ * Bank switch heavy guest code, with and without a mapper attached
+ *
+ *  M6502BenchMapper [cycles]
+ *
+ * The loop selects a RAM bank, reads from the banked window and selects
+ * another bank, two switches per 23 cycle iteration. The flat run executes
+ * the same code with the bank register as plain RAM, so the difference is
+ * the cost of the switches and the mapped read path.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_mapper.h"
+
+using namespace m6502;
+
+namespace
+{
+    constexpr s32 SLICE = 100000;
+    constexpr s32 LOOP_CYCLES = 23;
+
+    double Run(Mem& memory, long long Cycles)
+    {
+        CPU cpu;
+        cpu.Reset(0x0200, memory);
+        const Byte Program[] =
+        {
+            CPU::INS_LDA_IM, 0x01,
+            CPU::INS_STA_ABS, 0x61, 0x9F,
+            CPU::INS_LDA_ABS, 0x00, 0xA0,
+            CPU::INS_LDA_IM, 0x02,
+            CPU::INS_STA_ABS, 0x61, 0x9F,
+            CPU::INS_LDA_ABS, 0x00, 0xA0,
+            CPU::INS_JMP_ABS, 0x00, 0x02,
+        };
+        for (u32 i = 0; i < sizeof(Program); i++)
+        {
+            memory[0x0200 + i] = Program[i];
+        }
+
+        const auto Start = std::chrono::steady_clock::now();
+        for (long long Done = 0; Done < Cycles; )
+        {
+            Done += cpu.Execute(SLICE, memory);
+        }
+        const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+        return Elapsed.count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const long long Cycles = argc > 1 ? atoll(argv[1]) : 200000000;
+    const double Switches = 2.0 * Cycles / LOOP_CYCLES;
+
+    Mem Flat;
+    const double FlatSeconds = Run(Flat, Cycles);
+
+    Mem Banked;
+    RamBankMapper Mapper(256);
+    Mapper.Attach(Banked);
+    const double BankedSeconds = Run(Banked, Cycles);
+
+    printf("flat:   %8.1f MHz\n", Cycles / FlatSeconds / 1e6);
+    printf("banked: %8.1f MHz, %.1f M switches/s, %.1f ns per switch over flat\n",
+           Cycles / BankedSeconds / 1e6, Switches / BankedSeconds / 1e6,
+           (BankedSeconds - FlatSeconds) / Switches * 1e9);
+    return 0;
+}
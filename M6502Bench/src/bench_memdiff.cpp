@@ -0,0 +1,114 @@
+/*
+ * MemDiff kernels against the byte loop
+ *
+ *  M6502BenchMemDiff [changed bytes] [iterations]
+ *
+ * Diffs two images that differ in a few random bytes, with the plain
+ * 65536 iteration byte loop and with each MemDiff kernel, for the page
+ * bitmap, the changed ranges and the ranges restricted to dirty pages.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_memdiff.h"
+
+using namespace m6502;
+
+namespace
+{
+    std::vector<MemDiff::Range> ByteLoop(const Mem& A, const Mem& B)
+    {
+        std::vector<MemDiff::Range> Result;
+        for (u32 i = 0; i < Mem::MAX_MEM; i++)
+        {
+            if (A.Data[i] == B.Data[i])
+            {
+                continue;
+            }
+            if (!Result.empty() && Result.back().Start + Result.back().Length == i)
+            {
+                Result.back().Length++;
+            }
+            else
+            {
+                Result.push_back({ (Word)i, 1 });
+            }
+        }
+        return Result;
+    }
+
+    template <typename Fn>
+    void Time(const char* Name, u32 Iterations, Fn Run)
+    {
+        // Keeps the results alive so the diffs are not optimised away
+        volatile size_t Sink = 0;
+        const auto Begin = std::chrono::steady_clock::now();
+        for (u32 i = 0; i < Iterations; i++)
+        {
+            Sink = Sink + Run();
+        }
+        const std::chrono::duration<double, std::micro> Elapsed = std::chrono::steady_clock::now() - Begin;
+        const double Each = Elapsed.count() / Iterations;
+        printf("%-28s %9.2f us  %7.1f GB/s\n", Name, Each, 2.0 * Mem::MAX_MEM / Each / 1e3);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Changes = argc > 1 ? (u32)atoi(argv[1]) : 64;
+    const u32 Iterations = argc > 2 ? (u32)atoi(argv[2]) : 20000;
+
+    auto A = std::make_unique<Mem>();
+    auto B = std::make_unique<Mem>();
+    A->Initialise();
+    std::mt19937 Random(6502);
+    for (Byte& Value : A->Data)
+    {
+        Value = (Byte)Random();
+    }
+    *B = *A;
+    for (u32 i = 0; i < Changes; i++)
+    {
+        const Word Address = (Word)Random();
+        B->Data[Address] ^= 0x5A;
+        B->MarkDirty(Address);
+    }
+
+    const size_t Expected = ByteLoop(*A, *B).size();
+    printf("%u changed bytes, %zu ranges, %u iterations\n", Changes, Expected, Iterations);
+
+    Time("byte loop", Iterations, [&] { return ByteLoop(*A, *B).size(); });
+
+    const struct { MemDiff::Kernel Use; const char* Name; } KERNELS[] =
+    {
+        { MemDiff::Kernel::Scalar, "scalar" },
+        { MemDiff::Kernel::SSE2, "sse2" },
+        { MemDiff::Kernel::AVX2, "avx2" },
+    };
+    for (const auto& Kernel : KERNELS)
+    {
+        if (Kernel.Use > MemDiff::Best())
+        {
+            continue;
+        }
+        char Label[64];
+        u64 Changed[MemDiff::BITMAP_WORDS];
+        snprintf(Label, sizeof(Label), "%s pages", Kernel.Name);
+        Time(Label, Iterations, [&] { MemDiff::Pages(*A, *B, Changed, nullptr, Kernel.Use); return (size_t)Changed[0]; });
+        snprintf(Label, sizeof(Label), "%s ranges", Kernel.Name);
+        Time(Label, Iterations, [&] { return MemDiff::Ranges(*A, *B, nullptr, Kernel.Use).size(); });
+        snprintf(Label, sizeof(Label), "%s ranges, dirty pages", Kernel.Name);
+        Time(Label, Iterations, [&] { return MemDiff::Ranges(*A, *B, B->DirtyPages, Kernel.Use).size(); });
+
+        if (MemDiff::Ranges(*A, *B, nullptr, Kernel.Use).size() != Expected)
+        {
+            printf("MISMATCH in the %s kernel\n", Kernel.Name);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * MemPool against one heap allocated Mem per machine
+ *
+ *  M6502BenchMemPool [instances]
+ *
+ * Sets up a fleet of machines, runs each for a short slice, then tears the
+ * fleet down and builds it again, the way fleet code recycles machines.
+ * Reports wall time, minor page faults and dTLB load misses (when perf
+ * events are available) for each phase. 100k instances need about 7 GiB.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_mempool.h"
+
+using namespace m6502;
+
+namespace
+{
+    struct Counters
+    {
+        int TlbFd = -1;
+
+        Counters()
+        {
+            perf_event_attr Attr;
+            memset(&Attr, 0, sizeof(Attr));
+            Attr.size = sizeof(Attr);
+            Attr.type = PERF_TYPE_HW_CACHE;
+            Attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            Attr.disabled = 1;
+            Attr.exclude_kernel = 1;
+            TlbFd = (int)syscall(SYS_perf_event_open, &Attr, 0, -1, -1, 0);
+        }
+
+        ~Counters()
+        {
+            if (TlbFd >= 0)
+            {
+                close(TlbFd);
+            }
+        }
+
+        struct Sample
+        {
+            std::chrono::steady_clock::time_point Time;
+            long MinorFaults;
+            long long TlbMisses;
+        };
+
+        Sample Read() const
+        {
+            rusage Usage;
+            getrusage(RUSAGE_SELF, &Usage);
+            long long Misses = -1;
+            if (TlbFd >= 0 && read(TlbFd, &Misses, sizeof(Misses)) != sizeof(Misses))
+            {
+                Misses = -1;
+            }
+            return { std::chrono::steady_clock::now(), Usage.ru_minflt, Misses };
+        }
+
+        void Start() const
+        {
+            if (TlbFd >= 0)
+            {
+                ioctl(TlbFd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(TlbFd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+
+        void Report(const char* Name, const Sample& Begin) const
+        {
+            const Sample End = Read();
+            const std::chrono::duration<double> Elapsed = End.Time - Begin.Time;
+            printf("%-22s %9.1f ms %10ld faults", Name, Elapsed.count() * 1e3, End.MinorFaults - Begin.MinorFaults);
+            if (End.TlbMisses >= 0)
+            {
+                printf(" %12lld dTLB misses\n", End.TlbMisses);
+            }
+            else
+            {
+                printf("      dTLB n/a\n");
+            }
+        }
+    };
+
+    // A small program touching the zero page, the stack and its own page
+    const Byte PROGRAM[] =
+    {
+        CPU::INS_LDA_IM, 0x42,
+        CPU::INS_STA_ZP, 0x10,
+        CPU::INS_JSR, 0x0A, 0x02,
+        CPU::INS_JMP_ABS, 0x00, 0x02,
+        CPU::INS_STA_ABS, 0x00, 0x03,
+        CPU::INS_RTS,
+    };
+
+    void RunMachine(Mem& memory)
+    {
+        CPU cpu;
+        cpu.PC = 0x0200;
+        cpu.SP = 0xFF;
+        cpu.PS = 0;
+        cpu.A = cpu.X = cpu.Y = 0;
+        memory.Load(0x0200, PROGRAM, sizeof(PROGRAM));
+        cpu.Execute(200, memory);
+    }
+
+    template <typename AcquireFn, typename ReleaseFn>
+    void Phase(const char* Name, const Counters& Perf, u32 Instances, AcquireFn Acquire, ReleaseFn Release)
+    {
+        std::vector<Mem*> Fleet(Instances);
+        char Label[64];
+
+        snprintf(Label, sizeof(Label), "%s setup+run", Name);
+        Counters::Sample Begin = Perf.Read();
+        Perf.Start();
+        for (Mem*& memory : Fleet)
+        {
+            memory = Acquire();
+            RunMachine(*memory);
+        }
+        Perf.Report(Label, Begin);
+
+        snprintf(Label, sizeof(Label), "%s recycle+run", Name);
+        Begin = Perf.Read();
+        Perf.Start();
+        for (Mem*& memory : Fleet)
+        {
+            Release(memory);
+            memory = Acquire();
+            RunMachine(*memory);
+        }
+        Perf.Report(Label, Begin);
+
+        for (Mem* memory : Fleet)
+        {
+            Release(memory);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Instances = argc > 1 ? (u32)atoi(argv[1]) : 100000;
+    const Counters Perf;
+    printf("%u instances, %zu byte images\n", Instances, sizeof(Mem));
+
+    Phase("new Mem", Perf, Instances,
+          []
+          {
+              Mem* memory = new Mem();
+              memory->Initialise();
+              return memory;
+          },
+          [](Mem* memory) { delete memory; });
+
+    MemPool Pool(Instances);
+    printf("pool: %s\n", Pool.ExplicitHugePages ? "explicit huge pages" : "transparent huge pages requested");
+    Phase("MemPool", Perf, Instances,
+          [&Pool] { return Pool.Acquire(); },
+          [&Pool](Mem* memory) { Pool.Release(memory); });
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Real time pacing of a fleet of machines on one thread
+ *
+ *  M6502BenchPacer [machines] [seconds]
+ *
+ * Paces machines running a store and call loop at the Apple II clock and
+ * prints the pacer's report: lateness of the wake-ups, the period it
+ * settled on, utilisation of the thread and the worst drift.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../../M6502Lib/src/m6502_pacer.h"
+
+using namespace m6502;
+
+namespace
+{
+    const Byte PROGRAM[] =
+    {
+        CPU::INS_LDA_IM, 0x42,
+        CPU::INS_STA_ZP, 0x10,
+        CPU::INS_JSR, 0x0A, 0x02,
+        CPU::INS_JMP_ABS, 0x00, 0x02,
+        CPU::INS_STA_ABS, 0x00, 0x03,
+        CPU::INS_RTS,
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Machines = argc > 1 ? (u32)atoi(argv[1]) : 500;
+    const double Seconds = argc > 2 ? atof(argv[2]) : 2.0;
+
+    std::vector<Mem> Memories(Machines);
+    Pacer pacer;
+    for (Mem& memory : Memories)
+    {
+        CPU cpu;
+        cpu.Reset(0x0200, memory);
+        memory.Load(0x0200, PROGRAM, sizeof(PROGRAM));
+        pacer.Add(cpu, memory, Pacer::APPLE_II_HZ);
+    }
+
+    printf("%u machines at %.0f Hz for %.1f s\n", Machines, Pacer::APPLE_II_HZ, Seconds);
+    pacer.RunFor(std::chrono::duration_cast<Pacer::Clock::duration>(std::chrono::duration<double>(Seconds)));
+    pacer.WriteReport(std::cout);
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * Scheduler with many machines on one thread
+ *
+ *  M6502BenchScheduler [machines] [latency us] [seconds]
+ *
+ * Runs a fleet of small machines out of a MemPool under the cooperative
+ * Scheduler and reports the aggregate emulated MHz, the per machine MHz
+ * spread and how long machines waited between slices against the target.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_mempool.h"
+#include "../../M6502Lib/src/m6502_scheduler.h"
+
+using namespace m6502;
+
+namespace
+{
+    const Byte PROGRAM[] =
+    {
+        CPU::INS_LDA_IM, 0x42,
+        CPU::INS_STA_ZP, 0x10,
+        CPU::INS_JSR, 0x0A, 0x02,
+        CPU::INS_JMP_ABS, 0x00, 0x02,
+        CPU::INS_STA_ABS, 0x00, 0x03,
+        CPU::INS_RTS,
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Machines = argc > 1 ? (u32)atoi(argv[1]) : 1000;
+    const auto Latency = std::chrono::microseconds(argc > 2 ? atoi(argv[2]) : 10000);
+    const double Seconds = argc > 3 ? atof(argv[3]) : 2.0;
+
+    MemPool Pool(Machines);
+    Scheduler Sched(Latency);
+    for (u32 Machine = 0; Machine < Machines; Machine++)
+    {
+        Mem* memory = Pool.Acquire();
+        CPU cpu;
+        cpu.Reset(0x0200, *memory);
+        memory->Load(0x0200, PROGRAM, sizeof(PROGRAM));
+        Sched.Add(cpu, *memory);
+    }
+
+    Sched.RunFor(std::chrono::duration_cast<Scheduler::Clock::duration>(std::chrono::duration<double>(Seconds)));
+
+    double Total = 0, Slowest = 1e30, Fastest = 0, MeanDelay = 0;
+    Scheduler::Clock::duration MaxDelay{};
+    for (u32 Machine = 0; Machine < Machines; Machine++)
+    {
+        const double Mhz = Sched.AchievedMHz(Machine);
+        Total += Mhz;
+        Slowest = std::min(Slowest, Mhz);
+        Fastest = std::max(Fastest, Mhz);
+        MeanDelay += Sched.Stats[Machine].MeanDelayMicroseconds() / Machines;
+        MaxDelay = std::max(MaxDelay, Sched.Stats[Machine].MaxDelay);
+    }
+    printf("%u machines, %zu byte CPU state, target latency %lld us\n", Machines, sizeof(CPU), (long long)Latency.count());
+    printf("aggregate %8.1f MHz, per machine %.3f..%.3f MHz\n", Total, Slowest, Fastest);
+    printf("delay between slices: mean %.1f us, max %.1f us\n", MeanDelay,
+           std::chrono::duration<double, std::micro>(MaxDelay).count());
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Watching a machine from another process: shared segment against a pipe
+ *
+ *  M6502BenchShared [snapshots]
+ *
+ * Times a monitor taking snapshots of a running machine two ways: reading
+ * the published registers and one byte of the shared Data, and the old
+ * way of copying Mem::Data into a pipe and reading it out at the other
+ * end. Also times Publish() on the emulation side.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../../M6502Lib/src/m6502_shared.h"
+
+using namespace m6502;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double NsPer(Clock::time_point Begin, u32 Count)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - Begin).count() / Count;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const u32 Snapshots = argc > 1 ? (u32)atoi(argv[1]) : 20000;
+    const std::string Name = "/m6502bench." + std::to_string(getpid());
+
+    SharedMachine Machine(Name);
+    SharedMachineView View(Name);
+    CPU cpu;
+    cpu.Reset(0x0200, *Machine.Memory);
+
+    Clock::time_point Begin = Clock::now();
+    for (u32 i = 0; i < Snapshots; i++)
+    {
+        cpu.A = (Byte)i;
+        Machine.Publish(cpu, i);
+    }
+    printf("Publish            %8.1f ns\n", NsPer(Begin, Snapshots));
+
+    volatile u64 Sink = 0;
+    SharedMachine::Registers Registers;
+    Begin = Clock::now();
+    for (u32 i = 0; i < Snapshots; i++)
+    {
+        View.Read(Registers);
+        Sink = Sink + Registers.Cycles + View.Data[i & (Mem::MAX_MEM - 1)];
+    }
+    printf("shared snapshot    %8.1f ns\n", NsPer(Begin, Snapshots));
+
+    int Pipe[2];
+    if (pipe(Pipe) != 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+    std::vector<Byte> Received(Mem::MAX_MEM);
+    Begin = Clock::now();
+    for (u32 i = 0; i < Snapshots; i++)
+    {
+        // Chunks the pipe buffer can take, so one thread can play both ends
+        for (u32 Offset = 0; Offset < Mem::MAX_MEM; Offset += 16384)
+        {
+            if (write(Pipe[1], Machine.Memory->Data + Offset, 16384) != 16384
+                || read(Pipe[0], Received.data() + Offset, 16384) != 16384)
+            {
+                perror("pipe");
+                return 1;
+            }
+        }
+        Sink = Sink + Received[i & (Mem::MAX_MEM - 1)];
+    }
+    printf("pipe snapshot      %8.1f ns\n", NsPer(Begin, Snapshots));
+    close(Pipe[0]);
+    close(Pipe[1]);
+    return 0;
+}
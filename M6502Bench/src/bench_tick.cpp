@@ -0,0 +1,96 @@
+/*
+ * CPU::Tick against CPU::Execute
+ *
+ *  M6502BenchTick [cycles]
+ *
+ * Runs the copy loop of M6502BenchFusion once instruction by instruction
+ * with Execute and once a cycle at a time with Tick, each tick running one
+ * micro-op (bus cycle) of the instruction, with a stand-in for a device
+ * stepped on every cycle, checks both end in the same state and reports
+ * emulated MHz and the slowdown of ticking.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "../../M6502Lib/src/m6502.h"
+
+using namespace m6502;
+
+namespace
+{
+    const Byte PROGRAM[] =
+    {
+        // 0x0200
+        CPU::INS_LDX_IM, 0x04,
+        CPU::INS_LDY_IM, 0x10,
+        CPU::INS_JSR, 0x00, 0x03,
+        CPU::INS_JMP_ABS, 0x00, 0x02,
+    };
+
+    const Byte ROUTINE[] =
+    {
+        // 0x0300
+        CPU::INS_LDA_IM, 0x01,
+        CPU::INS_STA_ZP, 0x20,
+        CPU::INS_LDA_IM, 0x02,
+        CPU::INS_STA_ABS, 0x00, 0x40,
+        CPU::INS_LDA_ZPX, 0x1C,
+        CPU::INS_STA_ABSY, 0x00, 0x41,
+        CPU::INS_LDA_ABS, 0x00, 0x40,
+        CPU::INS_STA_ABS, 0x01, 0x40,
+        CPU::INS_RTS,
+    };
+
+    void Setup(CPU& cpu, Mem& memory)
+    {
+        cpu.Reset(0x0200, memory);
+        memory.Load(0x0200, PROGRAM, sizeof(PROGRAM));
+        memory.Load(0x0300, ROUTINE, sizeof(ROUTINE));
+    }
+
+    double Report(const char* Name, s64 Cycles, std::chrono::steady_clock::time_point Begin)
+    {
+        const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Begin;
+        const double Mhz = Cycles / Elapsed.count() / 1e6;
+        printf("%-8s %9.1f ms %8.1f MHz\n", Name, Elapsed.count() * 1e3, Mhz);
+        return Mhz;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const s32 Cycles = argc > 1 ? atoi(argv[1]) : 200000000;
+
+    auto ExecuteMem = std::make_unique<Mem>();
+    auto TickMem = std::make_unique<Mem>();
+    CPU Stepped, Ticked;
+    Setup(Stepped, *ExecuteMem);
+    Setup(Ticked, *TickMem);
+
+    auto Begin = std::chrono::steady_clock::now();
+    const s32 Used = Stepped.Execute(Cycles, *ExecuteMem);
+    const double ExecuteMhz = Report("Execute", Used, Begin);
+
+    // A device clocked with the CPU, e.g. a video chip counting its dots
+    volatile u32 DeviceClock = 0;
+    Begin = std::chrono::steady_clock::now();
+    for (s32 i = 0; i < Used; i++)
+    {
+        Ticked.Tick(*TickMem);
+        DeviceClock = DeviceClock + 1;
+    }
+    const double TickMhz = Report("Tick", Used, Begin);
+    printf("ticking is %.2fx slower\n", ExecuteMhz / TickMhz);
+
+    const bool Same = Stepped.PC == Ticked.PC && Stepped.A == Ticked.A && Stepped.X == Ticked.X
+        && Stepped.Y == Ticked.Y && Stepped.SP == Ticked.SP && Ticked.AtInstructionBoundary()
+        && memcmp(ExecuteMem->Data, TickMem->Data, Mem::MAX_MEM) == 0;
+    if (!Same)
+    {
+        printf("MISMATCH between Execute and Tick\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Disassembler and code map for 6502 binaries
+ *
+ *  M6502Disasm [-b load address] [-e entry]... [-cpu nmos|cmos|nes]
+ *              [-dot graph.dot] [-o listing.s] <image.bin>
+ *
+ *  M6502Disasm -b C000 -dot rom.dot rom.bin
+ *
+ * Loads the image at its address (0 by default) and traces its code from
+ * the entry points, by default the NMI, reset and IRQ vectors when the
+ * image holds them, otherwise its start. Writes the listing (code with a
+ * label per basic block, everything never reached as .byte rows) to -o or
+ * stdout, the block graph to -dot, and a summary to stderr.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../../M6502Lib/src/m6502_disasm.h"
+
+using namespace m6502;
+
+namespace
+{
+    void Usage(const char* Name)
+    {
+        fprintf(stderr, "Usage: %s [-b load address] [-e entry]... [-cpu nmos|cmos|nes] "
+                        "[-dot graph.dot] [-o listing.s] <image.bin>\n", Name);
+    }
+
+    bool ParseVariant(const char* Text, CPUVariant& Out)
+    {
+        if (strcmp(Text, "nmos") == 0)
+        {
+            Out = CPUVariant::NMOS6502;
+        }
+        else if (strcmp(Text, "cmos") == 0)
+        {
+            Out = CPUVariant::CMOS65C02;
+        }
+        else if (strcmp(Text, "nes") == 0)
+        {
+            Out = CPUVariant::RP2A03;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    u32 Base = 0;
+    CPUVariant Variant = CPUVariant::NMOS6502;
+    std::vector<Word> Entries;
+    std::string OutPath, DotPath, ImagePath;
+    for (int i = 1; i < argc; i++)
+    {
+        const bool HasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-b") == 0 && HasValue)
+        {
+            Base = (Word)strtoul(argv[++i], nullptr, 16);
+        }
+        else if (strcmp(argv[i], "-e") == 0 && HasValue)
+        {
+            Entries.push_back((Word)strtoul(argv[++i], nullptr, 16));
+        }
+        else if (strcmp(argv[i], "-cpu") == 0 && HasValue)
+        {
+            if (!ParseVariant(argv[++i], Variant))
+            {
+                fprintf(stderr, "unknown cpu %s, expected nmos, cmos or nes\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "-dot") == 0 && HasValue)
+        {
+            DotPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "-o") == 0 && HasValue)
+        {
+            OutPath = argv[++i];
+        }
+        else if (argv[i][0] != '-' && ImagePath.empty())
+        {
+            ImagePath = argv[i];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+    if (ImagePath.empty())
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    std::ifstream ImageFile(ImagePath, std::ios::binary);
+    if (!ImageFile)
+    {
+        fprintf(stderr, "cannot read %s\n", ImagePath.c_str());
+        return 1;
+    }
+    const std::vector<Byte> Bytes((std::istreambuf_iterator<char>(ImageFile)), std::istreambuf_iterator<char>());
+    if (Bytes.empty() || Base + Bytes.size() > Mem::MAX_MEM)
+    {
+        fprintf(stderr, "%s is empty or does not fit at $%04X\n", ImagePath.c_str(), Base);
+        return 1;
+    }
+    std::vector<Byte> Image(Mem::MAX_MEM);
+    memcpy(Image.data() + Base, Bytes.data(), Bytes.size());
+    const u32 End = Base + (u32)Bytes.size();
+
+    if (Entries.empty())
+    {
+        // Only vectors the image holds all of, the rest of the buffer is zero filled
+        const bool HasVectors = Base <= CodeMap::NMI_VECTOR && End == Mem::MAX_MEM;
+        Entries = HasVectors ? CodeMap::VectorEntries(Image.data()) : std::vector<Word>{ (Word)Base };
+    }
+
+    const auto Begin = std::chrono::steady_clock::now();
+    CodeMap Map;
+    Map.Analyse(Image.data(), Entries, Variant, Base, End);
+    const std::string Listing = Map.Listing(Image.data());
+    const std::chrono::duration<double, std::milli> Elapsed = std::chrono::steady_clock::now() - Begin;
+
+    if (OutPath.empty())
+    {
+        fwrite(Listing.data(), 1, Listing.size(), stdout);
+    }
+    else
+    {
+        std::ofstream Out(OutPath, std::ios::binary);
+        Out.write(Listing.data(), (std::streamsize)Listing.size());
+        if (!Out)
+        {
+            fprintf(stderr, "cannot write %s\n", OutPath.c_str());
+            return 1;
+        }
+    }
+    if (!DotPath.empty())
+    {
+        std::ofstream Dot(DotPath);
+        Map.WriteGraph(Dot);
+        if (!Dot)
+        {
+            fprintf(stderr, "cannot write %s\n", DotPath.c_str());
+            return 1;
+        }
+    }
+
+    u32 CodeBytes = 0;
+    for (u32 Address = Base; Address < End; Address++)
+    {
+        CodeBytes += Map.Types[Address] != CodeMap::ByteType::Data;
+    }
+    fprintf(stderr, "%zu blocks, %zu subroutines, %u code and %u data bytes, %u overlaps, %.2f ms\n",
+            Map.Blocks.size(), Map.Subroutines.size(), CodeBytes, (u32)Bytes.size() - CodeBytes, Map.Overlaps,
+            Elapsed.count());
+    return 0;
+}
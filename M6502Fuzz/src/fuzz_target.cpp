@@ -0,0 +1,152 @@
+/*
+ * Differential fuzz target for CPU::Execute
+ *
+ * Each input describes one case:
+ *  - [0..7]  A, X, Y, SP, PS, PC lo, PC hi, cycle budget - 1
+ *  - [8]     program length (low 5 bits), followed by the program bytes placed at PC
+ *  - rest    (address lo, address hi, value) triples poked into memory first
+ *
+ * The case is run through the reference model and then through the core,
+ * and any difference in registers, cycles, jam state or memory aborts.
+ * Works as a libFuzzer / AFL++ persistent mode target, memory is recycled
+ * between cases by clearing only the pages that were dirtied.
+ */
+#include <cstdint>
+#include <cstdlib>
+#include "reference_model.h"
+
+using namespace m6502;
+using namespace m6502fuzz;
+
+namespace
+{
+    constexpr size_t HEADER_SIZE = 9;
+
+    /*
+     * Opcode x page cross x wrap bitmap, gives the fuzzer feedback on guest
+     * behaviour that host code coverage alone cannot see (every page cross
+     * runs the same host branch no matter which instruction caused it)
+     */
+    __attribute__((used, section("__libfuzzer_extra_counters")))
+    uint8_t ModeCoverage[256][4];
+
+    void RecordCoverage(Byte Opcode, bool PageCrossed, bool Wrapped)
+    {
+        uint8_t& Counter = ModeCoverage[Opcode][(PageCrossed ? 1 : 0) | (Wrapped ? 2 : 0)];
+        if (Counter != 0xFF)
+        {
+            Counter++;
+        }
+    }
+
+    Mem memory;
+    CPU cpu;
+
+    [[noreturn]] void ReportMismatch(const char* What, const ReferenceModel& Ref)
+    {
+        fprintf(stderr, "Mismatch in %s\n", What);
+        fprintf(stderr, " core: PC=%04X SP=%02X A=%02X X=%02X Y=%02X PS=%02X Jammed=%d\n",
+                cpu.PC, cpu.SP, cpu.A, cpu.X, cpu.Y, cpu.PS, cpu.Jammed);
+        fprintf(stderr, " ref:  PC=%04X SP=%02X A=%02X X=%02X Y=%02X PS=%02X Jammed=%d\n",
+                Ref.PC, Ref.SP, Ref.A, Ref.X, Ref.Y, Ref.PS, Ref.Jammed);
+        abort();
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* Data, size_t Size)
+{
+    if (Size < HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    memory.ClearDirty();
+
+    const size_t ProgramSize = Data[8] & 31;
+    const uint8_t* Program = Data + HEADER_SIZE;
+    const uint8_t* Patches = Program + ProgramSize;
+    if (Size < HEADER_SIZE + ProgramSize)
+    {
+        return 0;
+    }
+    for (const uint8_t* Patch = Patches; Patch + 3 <= Data + Size; Patch += 3)
+    {
+        const Word Address = Patch[0] | (Patch[1] << 8);
+        memory[Address] = Patch[2];
+        memory.MarkDirty(Address);
+    }
+
+    const Word StartPC = Data[5] | (Data[6] << 8);
+    for (size_t i = 0; i < ProgramSize; i++)
+    {
+        const Word Address = StartPC + i;
+        memory[Address] = Program[i];
+        memory.MarkDirty(Address);
+    }
+
+    cpu.A = Data[0];
+    cpu.X = Data[1];
+    cpu.Y = Data[2];
+    cpu.SP = Data[3];
+    cpu.PS = Data[4];
+    cpu.PC = StartPC;
+    cpu.ThrowOnIllegalOpcode = false;
+    cpu.Jammed = false;
+
+    ReferenceModel Ref(memory);
+    Ref.A = cpu.A;
+    Ref.X = cpu.X;
+    Ref.Y = cpu.Y;
+    Ref.SP = cpu.SP;
+    Ref.PS = cpu.PS;
+    Ref.PC = cpu.PC;
+
+    const s32 Budget = 1 + Data[7];
+    const s32 RefCycles = Ref.Run(Budget, RecordCoverage);
+    if (RefCycles < 0)
+    {
+        return 0;
+    }
+
+    // Pages the core is allowed to dirty: the ones set up above plus the reference's writes
+    u64 ExpectedDirty[Mem::NUM_PAGES / 64];
+    for (u32 i = 0; i < Mem::NUM_PAGES / 64; i++)
+    {
+        ExpectedDirty[i] = memory.DirtyPages[i];
+    }
+    for (u32 i = 0; i < Ref.NumWrites; i++)
+    {
+        const Word Address = Ref.WriteAddress[i];
+        ExpectedDirty[Address >> 14] |= 1ull << ((Address >> 8) & 63);
+    }
+
+    const s32 CoreCycles = cpu.Execute(Budget, memory);
+
+    if (CoreCycles != RefCycles)
+    {
+        fprintf(stderr, "core used %d cycles, reference used %d\n", CoreCycles, RefCycles);
+        ReportMismatch("cycles", Ref);
+    }
+    if (cpu.PC != Ref.PC || cpu.SP != Ref.SP || cpu.A != Ref.A || cpu.X != Ref.X || cpu.Y != Ref.Y
+        || cpu.PS != Ref.PS || cpu.Jammed != Ref.Jammed)
+    {
+        ReportMismatch("registers", Ref);
+    }
+    for (u32 i = 0; i < Ref.NumWrites; i++)
+    {
+        const Word Address = Ref.WriteAddress[i];
+        if (memory[Address] != Ref.Read(Address))
+        {
+            fprintf(stderr, "address %04X: core %02X, reference %02X\n", Address, memory[Address], Ref.Read(Address));
+            ReportMismatch("memory", Ref);
+        }
+    }
+    for (u32 i = 0; i < Mem::NUM_PAGES / 64; i++)
+    {
+        if (memory.DirtyPages[i] != ExpectedDirty[i])
+        {
+            ReportMismatch("pages written", Ref);
+        }
+    }
+    return 0;
+}
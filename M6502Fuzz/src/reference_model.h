@@ -0,0 +1,275 @@
+/*
+ * Reference model for differential fuzzing
+ *
+ * A deliberately separate, table driven implementation of the instructions
+ * the emulator supports. It shares nothing with CPU::Execute except the
+ * opcode values, so a mismatch between the two points at a real bug in one
+ * of them. Writes go to a small overlay so the core can run afterwards on
+ * the untouched Mem image.
+ */
+#pragma once
+
+#include "../../M6502Lib/src/m6502.h"
+
+namespace m6502fuzz
+{
+    using namespace m6502;
+
+    enum class Mode : Byte
+    {
+        None, Imm, Zp, ZpX, ZpY, Abs, AbsX, AbsY, IndX, IndY, Jsr, Rts, JmpAbs, JmpInd
+    };
+
+    enum class Op : Byte
+    {
+        Illegal, Load, Store, Jump
+    };
+
+    enum class Reg : Byte
+    {
+        A, X, Y
+    };
+
+    struct OpInfo
+    {
+        Op Kind;
+        Mode AddrMode;
+        Reg Register;
+        Byte BaseCycles;
+        bool PageCrossPenalty;
+    };
+
+    struct OpTable
+    {
+        OpInfo Info[256];
+
+        void Set(Byte Opcode, Op Kind, Mode AddrMode, Reg Register, Byte BaseCycles, bool PageCrossPenalty)
+        {
+            Info[Opcode] = { Kind, AddrMode, Register, BaseCycles, PageCrossPenalty };
+        }
+
+        OpTable() : Info()
+        {
+            Set(CPU::INS_LDA_IM,   Op::Load,  Mode::Imm,  Reg::A, 2, false);
+            Set(CPU::INS_LDA_ZP,   Op::Load,  Mode::Zp,   Reg::A, 3, false);
+            Set(CPU::INS_LDA_ZPX,  Op::Load,  Mode::ZpX,  Reg::A, 4, false);
+            Set(CPU::INS_LDA_ABS,  Op::Load,  Mode::Abs,  Reg::A, 4, false);
+            Set(CPU::INS_LDA_ABSX, Op::Load,  Mode::AbsX, Reg::A, 4, true);
+            Set(CPU::INS_LDA_ABSY, Op::Load,  Mode::AbsY, Reg::A, 4, true);
+            Set(CPU::INS_LDA_INDX, Op::Load,  Mode::IndX, Reg::A, 6, false);
+            Set(CPU::INS_LDA_INDY, Op::Load,  Mode::IndY, Reg::A, 5, true);
+            Set(CPU::INS_LDX_IM,   Op::Load,  Mode::Imm,  Reg::X, 2, false);
+            Set(CPU::INS_LDX_ZP,   Op::Load,  Mode::Zp,   Reg::X, 3, false);
+            Set(CPU::INS_LDX_ZPY,  Op::Load,  Mode::ZpY,  Reg::X, 4, false);
+            Set(CPU::INS_LDX_ABS,  Op::Load,  Mode::Abs,  Reg::X, 4, false);
+            Set(CPU::INS_LDX_ABSY, Op::Load,  Mode::AbsY, Reg::X, 4, true);
+            Set(CPU::INS_LDY_IM,   Op::Load,  Mode::Imm,  Reg::Y, 2, false);
+            Set(CPU::INS_LDY_ZP,   Op::Load,  Mode::Zp,   Reg::Y, 3, false);
+            Set(CPU::INS_LDY_ZPX,  Op::Load,  Mode::ZpX,  Reg::Y, 4, false);
+            Set(CPU::INS_LDY_ABS,  Op::Load,  Mode::Abs,  Reg::Y, 4, false);
+            Set(CPU::INS_LDY_ABSX, Op::Load,  Mode::AbsX, Reg::Y, 4, true);
+            Set(CPU::INS_STA_ZP,   Op::Store, Mode::Zp,   Reg::A, 3, false);
+            Set(CPU::INS_STA_ZPX,  Op::Store, Mode::ZpX,  Reg::A, 4, false);
+            Set(CPU::INS_STA_ABS,  Op::Store, Mode::Abs,  Reg::A, 4, false);
+            Set(CPU::INS_STA_ABSX, Op::Store, Mode::AbsX, Reg::A, 5, false);
+            Set(CPU::INS_STA_ABSY, Op::Store, Mode::AbsY, Reg::A, 5, false);
+            Set(CPU::INS_STA_INDX, Op::Store, Mode::IndX, Reg::A, 6, false);
+            Set(CPU::INS_STA_INDY, Op::Store, Mode::IndY, Reg::A, 6, false);
+            Set(CPU::INS_STX_ZP,   Op::Store, Mode::Zp,   Reg::X, 3, false);
+            Set(CPU::INS_STX_ZPY,  Op::Store, Mode::ZpY,  Reg::X, 4, false);
+            Set(CPU::INS_STX_ABS,  Op::Store, Mode::Abs,  Reg::X, 4, false);
+            Set(CPU::INS_STY_ZP,   Op::Store, Mode::Zp,   Reg::Y, 3, false);
+            Set(CPU::INS_STY_ZPX,  Op::Store, Mode::ZpX,  Reg::Y, 4, false);
+            Set(CPU::INS_STY_ABS,  Op::Store, Mode::Abs,  Reg::Y, 4, false);
+            Set(CPU::INS_JSR,      Op::Jump,  Mode::Jsr,    Reg::A, 6, false);
+            Set(CPU::INS_RTS,      Op::Jump,  Mode::Rts,    Reg::A, 6, false);
+            Set(CPU::INS_JMP_ABS,  Op::Jump,  Mode::JmpAbs, Reg::A, 3, false);
+            Set(CPU::INS_JMP_IND,  Op::Jump,  Mode::JmpInd, Reg::A, 5, false);
+        }
+    };
+
+    inline const OpTable OPCODES;
+
+    // Called once per executed instruction, used to feed the coverage bitmap
+    using InstructionObserver = void (*)(Byte Opcode, bool PageCrossed, bool Wrapped);
+
+    struct ReferenceModel
+    {
+        static constexpr u32 MAX_WRITES = 256;
+
+        Word PC;
+        Byte SP, A, X, Y, PS;
+        bool Jammed = false;
+
+        const Mem& Memory;
+        Word WriteAddress[MAX_WRITES];
+        Byte WriteValue[MAX_WRITES];
+        u32 NumWrites = 0;
+
+        explicit ReferenceModel(const Mem& memory) : Memory(memory) {}
+
+        Byte Read(Word Address) const
+        {
+            // Latest write wins
+            for (u32 i = NumWrites; i > 0; i--)
+            {
+                if (WriteAddress[i - 1] == Address)
+                {
+                    return WriteValue[i - 1];
+                }
+            }
+            return Memory[Address];
+        }
+
+        // @return false if the overlay is full and the case has to be discarded
+        bool Write(Word Address, Byte Value)
+        {
+            if (NumWrites == MAX_WRITES)
+            {
+                return false;
+            }
+            WriteAddress[NumWrites] = Address;
+            WriteValue[NumWrites] = Value;
+            NumWrites++;
+            return true;
+        }
+
+        Byte& Register(Reg R)
+        {
+            return R == Reg::A ? A : (R == Reg::X ? X : Y);
+        }
+
+        Byte Next()
+        {
+            return Read(PC++);
+        }
+
+        /*
+         * Run until the budget is used up, with the same instruction granular
+         * overshoot rules as CPU::Execute.
+         * @return the number of cycles used, or -1 if the write overlay overflowed
+         */
+        s32 Run(s32 Cycles, InstructionObserver Observer)
+        {
+            const s32 CyclesRequested = Cycles;
+            while (Cycles > 0)
+            {
+                const Byte Opcode = Next();
+                const OpInfo& Info = OPCODES.Info[Opcode];
+                if (Info.Kind == Op::Illegal)
+                {
+                    Jammed = true;
+                    PC--;
+                    return CyclesRequested - Cycles + 1;
+                }
+
+                Word Address = 0;
+                bool PageCrossed = false;
+                bool Wrapped = false;
+                switch (Info.AddrMode)
+                {
+                    case Mode::Imm: Address = PC++; break;
+                    case Mode::Zp: Address = Next(); break;
+                    case Mode::ZpX: { Byte Base = Next(); Address = (Byte)(Base + X); Wrapped = Address < Base; } break;
+                    case Mode::ZpY: { Byte Base = Next(); Address = (Byte)(Base + Y); Wrapped = Address < Base; } break;
+                    // The high byte is fetched after the pushes, see Op::Jump
+                    case Mode::Jsr: Address = Next(); break;
+                    case Mode::Abs:
+                    case Mode::JmpAbs:
+                    case Mode::JmpInd:
+                    {
+                        Address = Next();
+                        Address |= Next() << 8;
+                    } break;
+                    case Mode::AbsX:
+                    case Mode::AbsY:
+                    {
+                        Word Base = Next();
+                        Base |= Next() << 8;
+                        Address = Base + (Info.AddrMode == Mode::AbsX ? X : Y);
+                        PageCrossed = (Base & 0xFF00) != (Address & 0xFF00);
+                    } break;
+                    case Mode::IndX:
+                    {
+                        Byte Pointer = Next() + X;
+                        Wrapped = Pointer == 0xFF;
+                        Address = Read(Pointer) | (Read((Byte)(Pointer + 1)) << 8);
+                    } break;
+                    case Mode::IndY:
+                    {
+                        Byte Pointer = Next();
+                        Wrapped = Pointer == 0xFF;
+                        Word Base = Read(Pointer) | (Read((Byte)(Pointer + 1)) << 8);
+                        Address = Base + Y;
+                        PageCrossed = (Base & 0xFF00) != (Address & 0xFF00);
+                    } break;
+                    default: break;
+                }
+
+                Cycles -= Info.BaseCycles;
+                if (Info.PageCrossPenalty && PageCrossed)
+                {
+                    Cycles--;
+                }
+
+                switch (Info.Kind)
+                {
+                    case Op::Load:
+                    {
+                        Byte Value = Read(Address);
+                        Register(Info.Register) = Value;
+                        PS = (PS & ~0b10000010) | (Value & 0b10000000) | (Value == 0 ? 0b00000010 : 0);
+                    } break;
+                    case Op::Store:
+                    {
+                        if (!Write(Address, Register(Info.Register)))
+                        {
+                            return -1;
+                        }
+                    } break;
+                    case Op::Jump:
+                    {
+                        if (Info.AddrMode == Mode::Jsr)
+                        {
+                            // PC is on the operand's high byte, which a push can overwrite before it is read
+                            Word Return = PC;
+                            Wrapped = SP < 2;
+                            if (!Write(0x100 | SP, Return >> 8)) return -1;
+                            SP--;
+                            if (!Write(0x100 | SP, Return & 0xFF)) return -1;
+                            SP--;
+                            Address |= Next() << 8;
+                            PC = Address;
+                        }
+                        else if (Info.AddrMode == Mode::Rts)
+                        {
+                            Wrapped = SP > 0xFD;
+                            SP++;
+                            Word Return = Read(0x100 | SP);
+                            SP++;
+                            Return |= Read(0x100 | SP) << 8;
+                            PC = Return + 1;
+                        }
+                        else if (Info.AddrMode == Mode::JmpInd)
+                        {
+                            // NMOS page boundary bug, the MSB comes from the start of the vector's page
+                            Wrapped = (Address & 0xFF) == 0xFF;
+                            PC = Read(Address) | (Read((Address & 0xFF00) | ((Address + 1) & 0x00FF)) << 8);
+                        }
+                        else
+                        {
+                            PC = Address;
+                        }
+                    } break;
+                    default: break;
+                }
+
+                if (Observer)
+                {
+                    Observer(Opcode, PageCrossed, Wrapped);
+                }
+            }
+            return CyclesRequested - Cycles;
+        }
+    };
+}
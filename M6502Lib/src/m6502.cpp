@@ -1,337 +1,1014 @@
 #include "m6502.h"
+#include "m6502_profiler.h"
+#include "m6502_traps.h"
 
 /*
  * Addressing Modes
+ *
+ * Micro-ops: one case per cycle, counted from the opcode fetch as cycle 1.
+ * END_CYCLE closes a cycle. A tick stops there and resumes at the next
+ * case, Execute falls straight through: its MicroOps is a local starting at
+ * cycle 2, so the switches fold away and it runs the cycles in a line.
  */
+#define END_CYCLE \
+    M.Cycle++; \
+    if constexpr (Ticked) return true
 
-// Addressing mode - Zero Page
-m6502::Word m6502::CPU::AddrZeroPage(s32& Cycles, const Mem& memory)
+// Addressing mode - Immediate
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrImmediate(MicroOps& M)
 {
-    Byte ZeroPageAddr = FetchByte(Cycles, memory);
-    return ZeroPageAddr;
+    if (M.Cycle == 1)
+    {
+        END_CYCLE;
+    }
+    M.Address = PC++;
+    return false;
 }
 
-// Addressing mode - Zero Page with X Offset
-m6502::Word m6502::CPU::AddrZeroPageX(s32& Cycles, const Mem& memory)
+// Addressing mode - Zero Page
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrZeroPage(MicroOps& M, s32& Cycles, const Mem& memory)
 {
-    Byte ZeroPageAddr = FetchByte(Cycles, memory);
-    ZeroPageAddr += X;
-    Cycles--;
-    return ZeroPageAddr;
+    switch (M.Cycle)
+    {
+        case 1:
+            END_CYCLE;
+            [[fallthrough]];
+        case 2:
+            M.Address = BusFetch<Ticked>(Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        default:
+            return false;
+    }
 }
 
-// Addressing mode - Zero page with Y offset
-m6502::Word m6502::CPU::AddrZeroPageY(s32& Cycles, const Mem& memory)
+// Addressing mode - Zero Page with X or Y Offset
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrZeroPageIndexed(MicroOps& M, Byte Index, s32& Cycles, const Mem& memory)
 {
-    Byte ZeroPageAddr = FetchByte(Cycles, memory);
-    ZeroPageAddr += Y;
-    Cycles--;
-    return ZeroPageAddr;
+    switch (M.Cycle)
+    {
+        case 1:
+            END_CYCLE;
+            [[fallthrough]];
+        case 2:
+            M.Address = BusFetch<Ticked>(Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 3:
+            // Reads the unindexed address while adding (the 65C02 its operand again)
+            BusIdle<Ticked>(Variant == CPUVariant::CMOS65C02 ? (Word)(PC - 1) : M.Address, Cycles, memory);
+            M.Address = (Byte)(M.Address + Index);
+            END_CYCLE;
+            [[fallthrough]];
+        default:
+            return false;
+    }
 }
 
 // Addressing mode - Absolute
-m6502::Word m6502::CPU::AddrAbsolute(s32& Cycles, const Mem& memory)
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrAbsolute(MicroOps& M, s32& Cycles, const Mem& memory)
 {
-    Word AbsAddress = FetchWord(Cycles, memory);
-    return AbsAddress;
+    switch (M.Cycle)
+    {
+        case 1:
+            END_CYCLE;
+            [[fallthrough]];
+        case 2:
+            M.Address = BusFetch<Ticked>(Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 3:
+            M.Address |= BusFetch<Ticked>(Cycles, memory) << 8;
+            END_CYCLE;
+            [[fallthrough]];
+        default:
+            return false;
+    }
 }
 
-// Addressing mode - Absolute with X offset
-m6502::Word m6502::CPU::AddrAbsoluteX(s32& Cycles, const Mem& memory)
+// The indexed modes' extra cycle, while the high byte is fixed
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline void m6502::CPU::FixHighByte(const MicroOps& M, s32& Cycles, const Mem& memory)
 {
-    Word AbsAddress = FetchWord(Cycles, memory);
-    Word AbsAddressX = AbsAddress + X;
-    if (AbsAddressX - AbsAddress >= 0xFF)
+    const bool Crossed = (M.Address ^ M.Base) >> 8;
+    if (Variant == CPUVariant::CMOS65C02 && Crossed)
+    {
+        BusIdle<Ticked>(PC - 1, Cycles, memory);
+    }
+    else
     {
-        Cycles--;
+        BusIdle<Ticked>((M.Base & 0xFF00) | (M.Address & 0x00FF), Cycles, memory);
     }
-    return AbsAddressX;
 }
 
 /*
-* Addressing mode - Absolute with X offset (5 cycles)
-*  - See "STA Absolute, X"
-*/
-m6502::Word m6502::CPU::AddrAbsoluteX_5(s32& Cycles, const Mem& memory)
+ * Addressing mode - Absolute with X or Y offset
+ *  - See "STA Absolute, X"
+ */
+template <m6502::CPUVariant Variant, bool Ticked, bool Write>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrAbsoluteIndexed(MicroOps& M, Byte Index, s32& Cycles, const Mem& memory)
 {
-    Word AbsAddress = FetchWord(Cycles, memory);
-    Word AbsAddressX = AbsAddress + X;
-    Cycles--;
-    return AbsAddressX;
+    switch (M.Cycle)
+    {
+        case 1:
+            END_CYCLE;
+            [[fallthrough]];
+        case 2:
+            M.Base = BusFetch<Ticked>(Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 3:
+            M.Base |= BusFetch<Ticked>(Cycles, memory) << 8;
+            M.Address = M.Base + Index;
+            END_CYCLE;
+            [[fallthrough]];
+        case 4:
+            // A read that stays in the page is done on this cycle
+            if (Write || (M.Address ^ M.Base) >> 8)
+            {
+                FixHighByte<Variant, Ticked>(M, Cycles, memory);
+                END_CYCLE;
+            }
+            [[fallthrough]];
+        default:
+            return false;
+    }
 }
 
-// Addressing mode - Absolute with Y offset
-m6502::Word m6502::CPU::AddrAbsoluteY(s32& Cycles, const Mem& memory)
+// Addressing mode - Indirect X | Indexed Indirect
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrIndirectX(MicroOps& M, s32& Cycles, const Mem& memory)
 {
-    Word AbsAddress = FetchWord(Cycles, memory);
-    Word AbsAddressY = AbsAddress + Y;
-    if (AbsAddressY - AbsAddress >= 0xFF)
+    switch (M.Cycle)
     {
-        Cycles--;
+        case 1:
+            END_CYCLE;
+            [[fallthrough]];
+        case 2:
+            M.Base = BusFetch<Ticked>(Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 3:
+            BusIdle<Ticked>(Variant == CPUVariant::CMOS65C02 ? (Word)(PC - 1) : M.Base, Cycles, memory);
+            M.Base = (Byte)(M.Base + X);
+            END_CYCLE;
+            [[fallthrough]];
+        case 4:
+            M.Address = BusRead<Ticked>(M.Base, Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 5:
+            // The pointer's high byte wraps to 0x00 rather than 0x100
+            M.Address |= BusRead<Ticked>((Byte)(M.Base + 1), Cycles, memory) << 8;
+            END_CYCLE;
+            [[fallthrough]];
+        default:
+            return false;
     }
-    return AbsAddressY;
 }
 
 /*
-* Addressing mode - Absolute with Y offset (5 cycles)
-*  - See "STA Absolute, Y"
-*/
-m6502::Word m6502::CPU::AddrAbsoluteY_5(s32& Cycles, const Mem& memory)
+ * Addressing mode - Indirect Y | Indirect Indexed
+ *  - See "STA Indirect, Y"
+ */
+template <m6502::CPUVariant Variant, bool Ticked, bool Write>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrIndirectY(MicroOps& M, s32& Cycles, const Mem& memory)
 {
-    Word AbsAddress = FetchWord(Cycles, memory);
-    Word AbsAddressY = AbsAddress + Y;
-    Cycles--;
-    return AbsAddressY;
+    switch (M.Cycle)
+    {
+        case 1:
+            END_CYCLE;
+            [[fallthrough]];
+        case 2:
+            M.Base = BusFetch<Ticked>(Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 3:
+            M.Address = BusRead<Ticked>(M.Base, Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 4:
+            M.Address |= BusRead<Ticked>((Byte)(M.Base + 1), Cycles, memory) << 8;
+            M.Base = M.Address;
+            M.Address += Y;
+            END_CYCLE;
+            [[fallthrough]];
+        case 5:
+            if (Write || (M.Address ^ M.Base) >> 8)
+            {
+                FixHighByte<Variant, Ticked>(M, Cycles, memory);
+                END_CYCLE;
+            }
+            [[fallthrough]];
+        default:
+            return false;
+    }
 }
 
-// Addressing mode - Indirect X | Indexed Indirect
-m6502::Word m6502::CPU::AddrIndirectX(s32& Cycles, const Mem& memory)
+// Addressing mode - Zero page indirect (65C02)
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline bool m6502::CPU::AddrIndirectZeroPage(MicroOps& M, s32& Cycles, const Mem& memory)
 {
-    Byte ZPAddress = FetchByte(Cycles, memory);
-    ZPAddress += X;
-    Cycles--;
-    Word EffectiveAddr = ReadWord(Cycles, ZPAddress, memory);
-    return EffectiveAddr;
+    switch (M.Cycle)
+    {
+        case 1:
+            END_CYCLE;
+            [[fallthrough]];
+        case 2:
+            M.Base = BusFetch<Ticked>(Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 3:
+            M.Address = BusRead<Ticked>(M.Base, Cycles, memory);
+            END_CYCLE;
+            [[fallthrough]];
+        case 4:
+            M.Address |= BusRead<Ticked>((Byte)(M.Base + 1), Cycles, memory) << 8;
+            END_CYCLE;
+            [[fallthrough]];
+        default:
+            return false;
+    }
 }
 
-// Addressing mode - Indirect Y | Indirect Indexed
-m6502::Word m6502::CPU::AddrIndirectY(s32& Cycles, const Mem& memory)
+
+/*
+ * Idle loops
+ */
+
+namespace
 {
-    Byte ZPAddress = FetchByte(Cycles, memory);
-    Word EffectiveAddr = ReadWord(Cycles, ZPAddress, memory);
-    Word EffectiveAddrY = EffectiveAddr + Y;
-    if (EffectiveAddrY - EffectiveAddr >= 0xFF)
+    // @return true if Start up to End is nothing but load instructions
+    bool IsLoadOnlyBody(m6502::Word Start, m6502::Word End, const m6502::Mem& memory)
     {
-        Cycles--;
+        using m6502::CPU;
+        m6502::Word Address = Start;
+        while (Address < End)
+        {
+            switch (memory[Address])
+            {
+                case CPU::INS_LDA_IM: case CPU::INS_LDA_ZP: case CPU::INS_LDA_ZPX:
+                case CPU::INS_LDA_INDX: case CPU::INS_LDA_INDY:
+                case CPU::INS_LDX_IM: case CPU::INS_LDX_ZP: case CPU::INS_LDX_ZPY:
+                case CPU::INS_LDY_IM: case CPU::INS_LDY_ZP: case CPU::INS_LDY_ZPX:
+                    Address += 2;
+                    break;
+                case CPU::INS_LDA_ABS: case CPU::INS_LDA_ABSX: case CPU::INS_LDA_ABSY:
+                case CPU::INS_LDX_ABS: case CPU::INS_LDX_ABSY:
+                case CPU::INS_LDY_ABS: case CPU::INS_LDY_ABSX:
+                    Address += 3;
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return Address == End;
     }
-    return EffectiveAddrY;
 }
 
-// Addressing mode - Indirect Y | Indirect Indexed
-m6502::Word m6502::CPU::AddrIndirectY_6(s32& Cycles, const Mem& memory)
+inline void m6502::CPU::FastForwardIdleLoop(Word JumpPC, s32& Cycles, const Mem& memory)
 {
-    Byte ZPAddress = FetchByte(Cycles, memory);
-    Word EffectiveAddr = ReadWord(Cycles, ZPAddress, memory);
-    Word EffectiveAddrY = EffectiveAddr + Y;
-    Cycles--;
-    return EffectiveAddrY;
+    // Forward jumps and long loops pay just this check
+    if (PC > JumpPC || JumpPC - PC > MAX_IDLE_LOOP_BYTES || Cycles <= 0)
+    {
+        return;
+    }
+
+    if (IdleLoop.Armed && IdleLoop.JumpPC == JumpPC
+        && IdleLoop.A == A && IdleLoop.X == X && IdleLoop.Y == Y && IdleLoop.PS == PS
+        && IsLoadOnlyBody(PC, JumpPC, memory))
+    {
+        // Leave between 1 and one pass worth of cycles for the last pass
+        const s32 PassCycles = IdleLoop.Cycles - Cycles;
+        Cycles -= (Cycles - 1) / PassCycles * PassCycles;
+    }
+
+    IdleLoop.Armed = true;
+    IdleLoop.JumpPC = JumpPC;
+    IdleLoop.A = A;
+    IdleLoop.X = X;
+    IdleLoop.Y = Y;
+    IdleLoop.PS = PS;
+    IdleLoop.Cycles = Cycles;
 }
 
 /*
  * Execute Instructions!
  */
-m6502::s32 m6502::CPU::Execute(m6502::s32 Cycles, m6502::Mem &memory)
+
+/*
+ * Run the instruction for an opcode that has already been fetched, or
+ * when Ticked only its cycle Micro.Cycle
+ *  - Always inlined, so callers that pass a constant opcode (the fused
+ *    handlers) get just that case and no dispatch
+ *  - Loads and stores are an addressing mode's cycles then one for the
+ *    access, jumps spell their cycles out
+ * @return false if the CPU jammed on an illegal opcode
+ */
+template <m6502::CPUVariant Variant, bool Ticked>
+__attribute__((always_inline)) inline bool m6502::CPU::ExecuteOpcode(Byte Ins, s32& Cycles, Mem& memory)
 {
+    MicroOps Straight{ .Cycle = 2 };
+    MicroOps& M = Ticked ? Micro : Straight;
+
     // Load a register with the value from the memory address
     auto LoadRegister = [&Cycles,&memory,this](Word Address, Byte& Register)
     {
-        Register = ReadByte(Cycles, Address, memory);
+        Register = BusRead<Ticked>(Address, Cycles, memory);
         LoadRegisterSetStatus(Register);
     };
 
+    if (!Ticked || M.Cycle == 1)
+    {
+        M6502_PROBE2(dispatch, (Word)(PC - 1), Ins);
+    }
+    switch (Ins)
+    {
+        // LOAD REGISTER IMMEDIATE
+        case INS_LDA_IM:
+        {
+            if (AddrImmediate<Variant, Ticked>(M)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        case INS_LDX_IM:
+        {
+            if (AddrImmediate<Variant, Ticked>(M)) return true;
+            LoadRegister(M.Address, X);
+        } break;
+        case INS_LDY_IM:
+        {
+            if (AddrImmediate<Variant, Ticked>(M)) return true;
+            LoadRegister(M.Address, Y);
+        } break;
+        // LOAD REGISTER ZERO PAGE (X Y)
+        case INS_LDA_ZP:
+        {
+            if (AddrZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        case INS_LDX_ZP:
+        {
+            if (AddrZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, X);
+        } break;
+        case INS_LDY_ZP:
+        {
+            if (AddrZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, Y);
+        } break;
+        case INS_LDA_ZPX:
+        {
+            if (AddrZeroPageIndexed<Variant, Ticked>(M, X, Cycles, memory)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        case INS_LDY_ZPX:
+        {
+            if (AddrZeroPageIndexed<Variant, Ticked>(M, X, Cycles, memory)) return true;
+            LoadRegister(M.Address, Y);
+        } break;
+        case INS_LDX_ZPY:
+        {
+            if (AddrZeroPageIndexed<Variant, Ticked>(M, Y, Cycles, memory)) return true;
+            LoadRegister(M.Address, X);
+        } break;
+        // LOAD REGISTER ABSOLUTE (X Y)
+        case INS_LDA_ABS:
+        {
+            if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        case INS_LDX_ABS:
+        {
+            if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, X);
+        } break;
+        case INS_LDY_ABS:
+        {
+            if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, Y);
+        } break;
+        case INS_LDA_ABSX:
+        {
+            if (AddrAbsoluteIndexed<Variant, Ticked, false>(M, X, Cycles, memory)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        case INS_LDY_ABSX:
+        {
+            if (AddrAbsoluteIndexed<Variant, Ticked, false>(M, X, Cycles, memory)) return true;
+            LoadRegister(M.Address, Y);
+        } break;
+        case INS_LDA_ABSY:
+        {
+            if (AddrAbsoluteIndexed<Variant, Ticked, false>(M, Y, Cycles, memory)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        case INS_LDX_ABSY:
+        {
+            if (AddrAbsoluteIndexed<Variant, Ticked, false>(M, Y, Cycles, memory)) return true;
+            LoadRegister(M.Address, X);
+        } break;
+        // LOAD REGISTER INDIRECT (X Y)
+        case INS_LDA_INDX:
+        {
+            if (AddrIndirectX<Variant, Ticked>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        case INS_LDA_INDY:
+        {
+            if (AddrIndirectY<Variant, Ticked, false>(M, Cycles, memory)) return true;
+            LoadRegister(M.Address, A);
+        } break;
+        // STORE REGISTER ZERO PAGE (Y)
+        case INS_STA_ZP:
+        {
+            if (AddrZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(A, M.Address, Cycles, memory);
+        } break;
+        case INS_STX_ZP:
+        {
+            if (AddrZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(X, M.Address, Cycles, memory);
+        } break;
+        case INS_STY_ZP:
+        {
+            if (AddrZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(Y, M.Address, Cycles, memory);
+        } break;
+        case INS_STA_ZPX:
+        {
+            if (AddrZeroPageIndexed<Variant, Ticked>(M, X, Cycles, memory)) return true;
+            BusWrite<Ticked>(A, M.Address, Cycles, memory);
+        } break;
+        case INS_STY_ZPX:
+        {
+            if (AddrZeroPageIndexed<Variant, Ticked>(M, X, Cycles, memory)) return true;
+            BusWrite<Ticked>(Y, M.Address, Cycles, memory);
+        } break;
+        case INS_STX_ZPY:
+        {
+            if (AddrZeroPageIndexed<Variant, Ticked>(M, Y, Cycles, memory)) return true;
+            BusWrite<Ticked>(X, M.Address, Cycles, memory);
+        } break;
+        // STORE REGISTER ABSOLUTE (X Y)
+        case INS_STA_ABS:
+        {
+            if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(A, M.Address, Cycles, memory);
+        } break;
+        case INS_STX_ABS:
+        {
+            if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(X, M.Address, Cycles, memory);
+        } break;
+        case INS_STY_ABS:
+        {
+            if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(Y, M.Address, Cycles, memory);
+        } break;
+        case INS_STA_ABSX:
+        {
+            if (AddrAbsoluteIndexed<Variant, Ticked, true>(M, X, Cycles, memory)) return true;
+            BusWrite<Ticked>(A, M.Address, Cycles, memory);
+        } break;
+        case INS_STA_ABSY:
+        {
+            if (AddrAbsoluteIndexed<Variant, Ticked, true>(M, Y, Cycles, memory)) return true;
+            BusWrite<Ticked>(A, M.Address, Cycles, memory);
+        } break;
+        // STORE REGISTER INDIRECT (X Y)
+        case INS_STA_INDX:
+        {
+            if (AddrIndirectX<Variant, Ticked>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(A, M.Address, Cycles, memory);
+        } break;
+        case INS_STA_INDY:
+        {
+            if (AddrIndirectY<Variant, Ticked, true>(M, Cycles, memory)) return true;
+            BusWrite<Ticked>(A, M.Address, Cycles, memory);
+        } break;
+        // JUMP COMMANDS
+        /*
+         * The return address (PC - 1, on the operand's high byte) is pushed
+         * before that byte is fetched. A trap is found by looking at the
+         * byte without a bus cycle and replaces the whole call
+         */
+        case INS_JSR:
+        {
+            switch (M.Cycle)
+            {
+                case 1:
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 2:
+                    M.Address = BusFetch<Ticked>(Cycles, memory);
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 3:
+                    if (Traps && Traps->Contains(M.Address | (memory[PC] << 8)))
+                    {
+                        M.Address |= BusFetch<Ticked>(Cycles, memory) << 8;
+                        M6502_PROBE3(jsr, (Word)(PC - 3), M.Address, SP);
+                        // The JSR's push and jump cycles, then the replaced routine
+                        Cycles -= 3;
+                        Cycles -= Traps->Run(M.Address, *this, memory);
+                        break;
+                    }
+                    BusIdle<Ticked>(SPToAddress(), Cycles, memory);
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 4:
+                    BusWrite<Ticked>(PC >> 8, SPToAddress(), Cycles, memory);
+                    SP--;
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 5:
+                    BusWrite<Ticked>(PC & 0xFF, SPToAddress(), Cycles, memory);
+                    SP--;
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 6:
+                    M.Address |= BusFetch<Ticked>(Cycles, memory) << 8;
+                    M6502_PROBE3(jsr, (Word)(PC - 3), M.Address, (Byte)(SP + 2));
+                    if (CallProfiler)
+                    {
+                        CallProfiler->OnCall(M.Address, (Byte)(SP + 2));
+                    }
+                    PC = M.Address;
+            }
+        } break;
+        case INS_RTS:
+        {
+            switch (M.Cycle)
+            {
+                case 1:
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 2:
+                    BusIdle<Ticked>(PC, Cycles, memory);
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 3:
+                    BusIdle<Ticked>(SPToAddress(), Cycles, memory);
+                    SP++;
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 4:
+                    M.Address = BusRead<Ticked>(SPToAddress(), Cycles, memory);
+                    SP++;
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 5:
+                    M.Address |= BusRead<Ticked>(SPToAddress(), Cycles, memory) << 8;
+                    PC = M.Address;
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 6:
+                    BusIdle<Ticked>(PC, Cycles, memory);
+                    PC++;
+                    M6502_PROBE2(rts, PC, SP);
+                    if (CallProfiler)
+                    {
+                        CallProfiler->OnReturn(SP);
+                    }
+                    if (SP == CallReturnSP && PC == CallReturnPC)
+                    {
+                        Stop(StopReason::Returned, Cycles);
+                    }
+            }
+        } break;
+        case INS_JMP_ABS:
+        {
+            switch (M.Cycle)
+            {
+                case 1:
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 2:
+                    M.Address = BusFetch<Ticked>(Cycles, memory);
+                    END_CYCLE;
+                    [[fallthrough]];
+                case 3:
+                {
+                    M.Address |= BusFetch<Ticked>(Cycles, memory) << 8;
+                    const Word JumpPC = PC - 3;
+                    PC = M.Address;
+                    FastForwardIdleLoop(JumpPC, Cycles, memory);
+                }
+            }
+        } break;
+        /*
+         * When the indirect vector falls on a page boundary (0x__FF)
+         *  - NMOS fetches the LSB from 0x__FF but the MSB from 0x__00
+         *  - Fixed in the 65C02, which takes an extra cycle
+         */
+        case INS_JMP_IND:
+        {
+            if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+            if constexpr (Variant == CPUVariant::CMOS65C02)
+            {
+                switch (M.Cycle)
+                {
+                    case 4:
+                        M.Base = M.Address;
+                        BusIdle<Ticked>(PC - 1, Cycles, memory);
+                        END_CYCLE;
+                        [[fallthrough]];
+                    case 5:
+                        M.Address = BusRead<Ticked>(M.Base, Cycles, memory);
+                        END_CYCLE;
+                        [[fallthrough]];
+                    case 6:
+                        M.Address |= BusRead<Ticked>(M.Base + 1, Cycles, memory) << 8;
+                }
+            }
+            else
+            {
+                switch (M.Cycle)
+                {
+                    case 4:
+                        M.Base = M.Address;
+                        M.Address = BusRead<Ticked>(M.Base, Cycles, memory);
+                        END_CYCLE;
+                        [[fallthrough]];
+                    case 5:
+                        M.Address |= BusRead<Ticked>((M.Base & 0xFF00) | ((M.Base + 1) & 0x00FF), Cycles, memory) << 8;
+                }
+            }
+            const Word JumpPC = PC - 3;
+            PC = M.Address;
+            FastForwardIdleLoop(JumpPC, Cycles, memory);
+        } break;
+        default:
+        {
+            // The 65C02 fills some of the NMOS part's illegal opcodes
+            if constexpr (Variant == CPUVariant::CMOS65C02)
+            {
+                switch (Ins)
+                {
+                    case INS_LDA_INDZP:
+                    {
+                        if (AddrIndirectZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+                        LoadRegister(M.Address, A);
+                    } return true;
+                    case INS_STA_INDZP:
+                    {
+                        if (AddrIndirectZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+                        BusWrite<Ticked>(A, M.Address, Cycles, memory);
+                    } return true;
+                    case INS_STZ_ZP:
+                    {
+                        if (AddrZeroPage<Variant, Ticked>(M, Cycles, memory)) return true;
+                        BusWrite<Ticked>(0, M.Address, Cycles, memory);
+                    } return true;
+                    case INS_STZ_ZPX:
+                    {
+                        if (AddrZeroPageIndexed<Variant, Ticked>(M, X, Cycles, memory)) return true;
+                        BusWrite<Ticked>(0, M.Address, Cycles, memory);
+                    } return true;
+                    case INS_STZ_ABS:
+                    {
+                        if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+                        BusWrite<Ticked>(0, M.Address, Cycles, memory);
+                    } return true;
+                    case INS_STZ_ABSX:
+                    {
+                        if (AddrAbsoluteIndexed<Variant, Ticked, true>(M, X, Cycles, memory)) return true;
+                        BusWrite<Ticked>(0, M.Address, Cycles, memory);
+                    } return true;
+                    case INS_JMP_ABSX_IND:
+                    {
+                        if (AddrAbsolute<Variant, Ticked>(M, Cycles, memory)) return true;
+                        switch (M.Cycle)
+                        {
+                            case 4:
+                                M.Base = M.Address + X;
+                                BusIdle<Ticked>(PC - 1, Cycles, memory);
+                                END_CYCLE;
+                                [[fallthrough]];
+                            case 5:
+                                M.Address = BusRead<Ticked>(M.Base, Cycles, memory);
+                                END_CYCLE;
+                                [[fallthrough]];
+                            case 6:
+                                M.Address |= BusRead<Ticked>(M.Base + 1, Cycles, memory) << 8;
+                                PC = M.Address;
+                        }
+                    } return true;
+                    default:
+                        break;
+                }
+            }
+            M6502_PROBE2(illegal, (Word)(PC - 1), Ins);
+            if (ThrowOnIllegalOpcode)
+            {
+                printf("Instruction not handled %d\n", Ins);
+                throw -1;
+            }
+            Jammed = true;
+            PC--;
+            return false;
+        }
+    }
+    return true;
+}
+
+#undef END_CYCLE
+
+template <m6502::CPUVariant Variant>
+m6502::s32 m6502::CPU::Execute(m6502::s32 Cycles, m6502::Mem &memory)
+{
     const s32 CyclesRequested = Cycles;
+    IdleLoop.Armed = false;
+    Stopped = StopReason::None;
     while (Cycles > 0)
     {
         Byte Ins = FetchByte(Cycles, memory);
-        switch (Ins)
+        if (!ExecuteOpcode<Variant>(Ins, Cycles, memory))
         {
-            // LOAD REGISTER IMMEDIATE
-            case INS_LDA_IM:
-            {
-                A = FetchByte(Cycles, memory);
-                LoadRegisterSetStatus(A);
-            } break;
-            case INS_LDX_IM:
-            {
-                X = FetchByte(Cycles, memory);
-                LoadRegisterSetStatus(X);
-            } break;
-            case INS_LDY_IM:
-            {
-                Y = FetchByte(Cycles, memory);
-                LoadRegisterSetStatus(Y);
-            } break;
-            // LOAD REGISTER ZERO PAGE (X Y)
-            case INS_LDA_ZP:
-            {
-                Word Address = AddrZeroPage(Cycles, memory);
-                LoadRegister(Address, A);
-            } break;
-            case INS_LDX_ZP:
-            {
-                Word Address = AddrZeroPage(Cycles, memory);
-                LoadRegister(Address, X);
-            } break;
-            case INS_LDY_ZP:
-            {
-                Word Address = AddrZeroPage(Cycles, memory);
-                LoadRegister(Address, Y);
-            } break;
-            case INS_LDA_ZPX:
-            {
-                Word Address = AddrZeroPageX(Cycles, memory);
-                LoadRegister(Address, A);
-            } break;
-            case INS_LDY_ZPX:
-            {
-                Word Address = AddrZeroPageX(Cycles, memory);
-                LoadRegister(Address, Y);
-            } break;
-            case INS_LDX_ZPY:
-            {
-                Word Address = AddrZeroPageY(Cycles, memory);
-                LoadRegister(Address, X);
-            } break;
-            // LOAD REGISTER ABSOLUTE (X Y)
-            case INS_LDA_ABS:
-            {
-                Word Address = AddrAbsolute(Cycles, memory);
-                LoadRegister(Address, A);
-            } break;
-            case INS_LDX_ABS:
-            {
-                Word Address = AddrAbsolute(Cycles, memory);
-                LoadRegister(Address, X);
-            } break;
-            case INS_LDY_ABS:
-            {
-                Word Address = AddrAbsolute(Cycles, memory);
-                LoadRegister(Address, Y);
-            } break;
-            case INS_LDA_ABSX:
-            {
-                Word Address = AddrAbsoluteX(Cycles, memory);
-                LoadRegister(Address, A);
-            } break;
-            case INS_LDY_ABSX:
-            {
-                Word Address = AddrAbsoluteX(Cycles, memory);
-                LoadRegister(Address, Y);
-            } break;
-            case INS_LDA_ABSY:
-            {
-                Word Address = AddrAbsoluteY(Cycles, memory);
-                LoadRegister(Address, A);
-            } break;
-            case INS_LDX_ABSY:
-            {
-                Word Address = AddrAbsoluteY(Cycles, memory);
-                LoadRegister(Address, X);
-            } break;
-            // LOAD REGISTER INDIRECT (X Y)
-            case INS_LDA_INDX:
-            {
-                Word Address = AddrIndirectX(Cycles, memory);
-                LoadRegister(Address, A);
-            } break;
-            case INS_LDA_INDY:
-            {
-                Word Address = AddrIndirectY(Cycles, memory);
-                LoadRegister(Address, A);
-            } break;
-            // STORE REGISTER ZERO PAGE (Y)
-            case INS_STA_ZP:
-            {
-                Word Address = AddrZeroPage(Cycles, memory);
-                WriteByte(A, Cycles, Address, memory);
-            } break;
-            case INS_STX_ZP:
-            {
-                Word Address = AddrZeroPage(Cycles, memory);
-                WriteByte(X, Cycles, Address, memory);
-            } break;
-            case INS_STY_ZP:
-            {
-                Word Address = AddrZeroPage(Cycles, memory);
-                WriteByte(Y, Cycles, Address, memory);
-            } break;
-            case INS_STA_ZPX:
-            {
-                Word Address = AddrZeroPageX(Cycles, memory);
-                WriteByte(A, Cycles, Address, memory);
-            } break;
-            case INS_STY_ZPX:
+            break;
+        }
+    }
+
+    return CyclesUsed(CyclesRequested, Cycles);
+}
+
+template <m6502::CPUVariant Variant>
+m6502::s32 m6502::CPU::ExecuteTo(m6502::Word StopPC, m6502::s32 Cycles, m6502::Mem &memory)
+{
+    const s32 CyclesRequested = Cycles;
+    IdleLoop.Armed = false;
+    Stopped = StopReason::None;
+    while (Cycles > 0)
+    {
+        if (PC == StopPC)
+        {
+            Stop(StopReason::ReachedPC, Cycles);
+            break;
+        }
+        Byte Ins = FetchByte(Cycles, memory);
+        if (!ExecuteOpcode<Variant>(Ins, Cycles, memory))
+        {
+            break;
+        }
+    }
+
+    return CyclesUsed(CyclesRequested, Cycles);
+}
+
+template <m6502::CPUVariant Variant>
+__attribute__((noinline)) void m6502::CPU::TickCycle(Mem& memory)
+{
+    if (Jammed)
+    {
+        return;
+    }
+    s32 Cycles = 0;
+    if (Micro.Cycle == 0)
+    {
+        Stopped = StopReason::None;
+        Micro.Opcode = BusFetch<true>(Cycles, memory);
+        Micro.Cycle = 1;
+    }
+    const Byte Cycle = Micro.Cycle;
+    ExecuteOpcode<Variant, true>(Micro.Opcode, Cycles, memory);
+    // A cycle that did not end with END_CYCLE was the instruction's last
+    if (Micro.Cycle == Cycle)
+    {
+        Micro.Cycle = 0;
+    }
+    // A Stop() moved the count into StoppedCycles, only a trapped JSR leaves cycles to tick out
+    Cycles += StoppedCycles;
+    StoppedCycles = 0;
+    TickCyclesLeft = -Cycles - 1;
+}
+
+template <m6502::CPUVariant Variant>
+m6502::CPU::CallResult m6502::CPU::Call(Word Address, CallRegisters In, Mem& memory, s32 MaxCycles)
+{
+    // Saved for calls made while another one is running, and put back even if an illegal opcode throws
+    struct OuterCall
+    {
+        CPU& Cpu;
+        const s32 ReturnSP = Cpu.CallReturnSP;
+        const Word ReturnPC = Cpu.CallReturnPC;
+        const StopReason Stopped = Cpu.Stopped;
+
+        ~OuterCall()
+        {
+            Cpu.CallReturnSP = ReturnSP;
+            Cpu.CallReturnPC = ReturnPC;
+            Cpu.Stopped = Stopped;
+        }
+    } Outer{ *this };
+
+    A = In.A;
+    X = In.X;
+    Y = In.Y;
+    PS = In.PS;
+    if (Traps && Traps->Contains(Address))
+    {
+        const s32 Used = Traps->Run(Address, *this, memory);
+        return { A, X, Y, PS, Used, true };
+    }
+
+    s32 PushCycles = 0;
+    CallReturnPC = PC;
+    PushPCToStack(PushCycles, memory);
+    CallReturnSP = (Byte)(SP + 2);
+    PC = Address;
+
+    s32 Used = 0;
+    bool Returned = false;
+    while (Used < MaxCycles && !Jammed)
+    {
+        Used += Execute<Variant>(MaxCycles - Used, memory);
+        if (Stopped == StopReason::Returned)
+        {
+            Returned = true;
+            break;
+        }
+    }
+
+    return { A, X, Y, PS, Used, Returned };
+}
+
+/*
+ * Fused execution
+ */
+
+namespace
+{
+    using namespace m6502;
+
+    enum Fusion : Byte
+    {
+        FUSE_NONE,
+        FUSE_LDA_IM_STA_ABS,    // LDA #imm; STA abs
+        FUSE_LDA_IM_STA_ZP,     // LDA #imm; STA zp
+        FUSE_LDA_ZPX_STA_ABSY,  // LDA zp,X; STA abs,Y
+        FUSE_LDA_ABS_STA_ABS,   // LDA abs;  STA abs
+        FUSE_LDX_IM_LDY_IM,     // LDX #imm; LDY #imm (; JSR abs)
+    };
+
+    /*
+     * Opcode pairs worth fusing, picked from the opcode pair profiles of our
+     * workloads (see OpcodeProfile). Indexed by the first opcode's slot so
+     * the table stays a couple of KiB.
+     */
+    struct FusionTable
+    {
+        static constexpr u32 MAX_HEADS = 8;
+
+        Byte HeadSlot[256] = {};
+        Byte HeadLength[MAX_HEADS] = {};
+        Byte Pair[MAX_HEADS][256] = {};
+        u32 NumHeads = 1;
+
+        // Furthest after its first opcode that a fused run starts another instruction (LDX #; LDY #; JSR)
+        static constexpr Word MAX_INNER_OFFSET = 4;
+
+        void Add(Byte First, Byte Length, Byte Second, Fusion Fused)
+        {
+            if (HeadSlot[First] == 0)
             {
-                Word Address = AddrZeroPageX(Cycles, memory);
-                WriteByte(Y, Cycles, Address, memory);
-            } break;
-            // STORE REGISTER ABSOLUTE (X Y)
-            case INS_STA_ABS:
+                HeadSlot[First] = NumHeads;
+                HeadLength[NumHeads] = Length;
+                NumHeads++;
+            }
+            Pair[HeadSlot[First]][Second] = Fused;
+        }
+
+        FusionTable()
+        {
+            Add(CPU::INS_LDA_IM, 2, CPU::INS_STA_ABS, FUSE_LDA_IM_STA_ABS);
+            Add(CPU::INS_LDA_IM, 2, CPU::INS_STA_ZP, FUSE_LDA_IM_STA_ZP);
+            Add(CPU::INS_LDA_ZPX, 2, CPU::INS_STA_ABSY, FUSE_LDA_ZPX_STA_ABSY);
+            Add(CPU::INS_LDA_ABS, 3, CPU::INS_STA_ABS, FUSE_LDA_ABS_STA_ABS);
+            Add(CPU::INS_LDX_IM, 2, CPU::INS_LDY_IM, FUSE_LDX_IM_LDY_IM);
+        }
+    };
+
+    const FusionTable FUSIONS;
+}
+
+/*
+ * Fused version of one opcode: skip the dispatch but keep the opcode fetch's
+ * PC increment and cycle, and stop where Execute would if the budget runs out
+ */
+#define FUSED_STEP(Opcode) \
+    if (Cycles <= 0) break; \
+    PC++; \
+    Cycles--; \
+    ExecuteOpcode<Variant>(Opcode, Cycles, memory);
+
+template <m6502::CPUVariant Variant>
+m6502::s32 m6502::CPU::ExecuteFused(m6502::s32 Cycles, m6502::Mem &memory)
+{
+    return ExecuteFusedLoop<Variant, false>(0, Cycles, memory);
+}
+
+template <m6502::CPUVariant Variant>
+m6502::s32 m6502::CPU::ExecuteFusedTo(m6502::Word StopPC, m6502::s32 Cycles, m6502::Mem &memory)
+{
+    return ExecuteFusedLoop<Variant, true>(StopPC, Cycles, memory);
+}
+
+template <m6502::CPUVariant Variant, bool StopAtPC>
+m6502::s32 m6502::CPU::ExecuteFusedLoop(m6502::Word StopPC, m6502::s32 Cycles, m6502::Mem &memory)
+{
+    const s32 CyclesRequested = Cycles;
+    IdleLoop.Armed = false;
+    Stopped = StopReason::None;
+    while (Cycles > 0)
+    {
+        const Byte Ins = memory[PC];
+        const Byte Slot = FUSIONS.HeadSlot[Ins];
+        Byte Fused = Slot ? FUSIONS.Pair[Slot][memory[(Word)(PC + FUSIONS.HeadLength[Slot])]] : (Byte)FUSE_NONE;
+        if constexpr (StopAtPC)
+        {
+            if (PC == StopPC)
             {
-                Word Address = AddrAbsolute(Cycles, memory);
-                WriteByte(A, Cycles, Address, memory);
-            } break;
-            case INS_STX_ABS:
+                Stop(StopReason::ReachedPC, Cycles);
+                break;
+            }
+            // Close to StopPC, step one instruction at a time so none of them starts on it unchecked
+            if ((Word)(StopPC - PC) <= FusionTable::MAX_INNER_OFFSET)
             {
-                Word Address = AddrAbsolute(Cycles, memory);
-                WriteByte(X, Cycles, Address, memory);
-            } break;
-            case INS_STY_ABS:
+                Fused = FUSE_NONE;
+            }
+        }
+        switch (Fused)
+        {
+            case FUSE_LDA_IM_STA_ABS:
             {
-                Word Address = AddrAbsolute(Cycles, memory);
-                WriteByte(Y, Cycles, Address, memory);
+                FUSED_STEP(INS_LDA_IM);
+                FUSED_STEP(INS_STA_ABS);
             } break;
-            case INS_STA_ABSX:
+            case FUSE_LDA_IM_STA_ZP:
             {
-                Word Address = AddrAbsoluteX_5(Cycles, memory);
-                WriteByte(A, Cycles, Address, memory);
+                FUSED_STEP(INS_LDA_IM);
+                FUSED_STEP(INS_STA_ZP);
             } break;
-            case INS_STA_ABSY:
+            case FUSE_LDA_ZPX_STA_ABSY:
             {
-                Word Address = AddrAbsoluteY_5(Cycles, memory);
-                WriteByte(A, Cycles, Address, memory);
+                FUSED_STEP(INS_LDA_ZPX);
+                FUSED_STEP(INS_STA_ABSY);
             } break;
-            // STORE REGISTER INDIRECT (X Y)
-            case INS_STA_INDX:
+            case FUSE_LDA_ABS_STA_ABS:
             {
-                Word Address = AddrIndirectX(Cycles, memory);
-                WriteByte(A, Cycles, Address, memory);
+                FUSED_STEP(INS_LDA_ABS);
+                FUSED_STEP(INS_STA_ABS);
             } break;
-            case INS_STA_INDY:
+            case FUSE_LDX_IM_LDY_IM:
             {
-                Word Address = AddrIndirectY_6(Cycles, memory);
-                WriteByte(A, Cycles, Address, memory);
+                FUSED_STEP(INS_LDX_IM);
+                FUSED_STEP(INS_LDY_IM);
+                // Loading the arguments for a call is usually followed by the call
+                if (memory[PC] == INS_JSR)
+                {
+                    FUSED_STEP(INS_JSR);
+                }
             } break;
-            // JUMP COMMANDS
-            case INS_JSR:
+            default:
             {
-                Word SubAddr = FetchWord(Cycles, memory);
-                PushPCToStack(Cycles, memory);
-                PC = SubAddr;
+                PC++;
                 Cycles--;
+                if (!ExecuteOpcode<Variant>(Ins, Cycles, memory))
+                {
+                    return CyclesUsed(CyclesRequested, Cycles);
+                }
             } break;
-            case INS_RTS:
-            {
-                Word ReturnAddress = PopWordFromStack(Cycles, memory);
-                PC = ReturnAddress + 1;
-                Cycles -= 2;
-            } break;
-            case INS_JMP_ABS:
-            {
-                Word Address = AddrAbsolute(Cycles, memory);
-                PC = Address;
-            } break;
-            /*
-             * TODO: Add case for when the indirect vector falls on a page boundary
-             *  - (e.g. 0x__FF where __ is any value from 0x00 to 0xFF)
-             *  - Fetches the LSB from 0x__FF (as expected)
-             *  - Fetches the MSB from 0x__00 (different)
-             *  - Fixed in later chips such as the 65SC02 (read from header file)
-             */
-            case INS_JMP_IND:
-            {
-                Word Address = AddrAbsolute(Cycles, memory);
-                Address = ReadWord(Cycles, Address, memory);
-                PC = Address;
-            } break;
-            default:
-            {
-                printf("Instruction not handled %d\n", Ins);
-                throw -1;
-            }
         }
     }
 
-    const s32 NumCyclesUsed = CyclesRequested - Cycles;
-    return NumCyclesUsed;
+    return CyclesUsed(CyclesRequested, Cycles);
 }
+
+#undef FUSED_STEP
+
+/*
+ * One Execute, ExecuteTo, ExecuteFused and ExecuteFusedTo per variant
+ */
+
+template m6502::s32 m6502::CPU::Execute<m6502::CPUVariant::NMOS6502>(m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::Execute<m6502::CPUVariant::CMOS65C02>(m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::Execute<m6502::CPUVariant::RP2A03>(m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteFused<m6502::CPUVariant::NMOS6502>(m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteFused<m6502::CPUVariant::CMOS65C02>(m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteFused<m6502::CPUVariant::RP2A03>(m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteTo<m6502::CPUVariant::NMOS6502>(m6502::Word, m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteTo<m6502::CPUVariant::CMOS65C02>(m6502::Word, m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteTo<m6502::CPUVariant::RP2A03>(m6502::Word, m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteFusedTo<m6502::CPUVariant::NMOS6502>(m6502::Word, m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteFusedTo<m6502::CPUVariant::CMOS65C02>(m6502::Word, m6502::s32, m6502::Mem&);
+template m6502::s32 m6502::CPU::ExecuteFusedTo<m6502::CPUVariant::RP2A03>(m6502::Word, m6502::s32, m6502::Mem&);
+template void m6502::CPU::TickCycle<m6502::CPUVariant::NMOS6502>(m6502::Mem&);
+template void m6502::CPU::TickCycle<m6502::CPUVariant::CMOS65C02>(m6502::Mem&);
+template void m6502::CPU::TickCycle<m6502::CPUVariant::RP2A03>(m6502::Mem&);
+template m6502::CPU::CallResult m6502::CPU::Call<m6502::CPUVariant::NMOS6502>(m6502::Word, m6502::CPU::CallRegisters, m6502::Mem&, m6502::s32);
+template m6502::CPU::CallResult m6502::CPU::Call<m6502::CPUVariant::CMOS65C02>(m6502::Word, m6502::CPU::CallRegisters, m6502::Mem&, m6502::s32);
+template m6502::CPU::CallResult m6502::CPU::Call<m6502::CPUVariant::RP2A03>(m6502::Word, m6502::CPU::CallRegisters, m6502::Mem&, m6502::s32);
@@ -12,6 +12,7 @@
 
 #include <cstdio>
 #include <iostream>
+#include "m6502_probes.h"
 
 namespace m6502
 {
@@ -20,17 +21,136 @@ namespace m6502
 
     using u32 = unsigned int;
     using s32 = signed int;
+    using u64 = unsigned long long;
+    using s64 = signed long long;
 
+    /*
+     * CPU families, picked at compile time with CPU::Execute<Variant>
+     *  - NMOS6502: the original part, JMP (ind) keeps the page boundary bug
+     *  - CMOS65C02: JMP (ind) fixed (one cycle slower), adds LDA/STA (zp),
+     *    STZ and JMP (abs,X)
+     *  - RP2A03: the NES CPU, an NMOS core with decimal mode removed
+     */
+    enum class CPUVariant : Byte
+    {
+        NMOS6502,
+        CMOS65C02,
+        RP2A03,
+    };
+
+    struct Mapper;
+    struct Profiler;
+    struct TrapTable;
     struct Mem;
     struct CPU;
     struct StatusFlags;
 }
 
+/*
+ * Handles CPU writes to windows that have no write target, e.g. ROM with
+ * bank select registers mapped over it. Mappers switch banks by pointing
+ * windows somewhere else with Mem::MapWindow, see m6502_mapper.h
+ */
+struct m6502::Mapper
+{
+    virtual ~Mapper() = default;
+
+    virtual void Write(Mem& memory, Word Address, Byte Value) = 0;
+};
+
 struct m6502::Mem
 {
     static constexpr u32 MAX_MEM = 1024 * 64;
+    static constexpr u32 PAGE_SIZE = 256;
+    static constexpr u32 NUM_PAGES = MAX_MEM / PAGE_SIZE;
+    static constexpr u32 WINDOW_SHIFT = 12;
+    static constexpr u32 WINDOW_SIZE = 1 << WINDOW_SHIFT;
+    static constexpr u32 NUM_WINDOWS = MAX_MEM / WINDOW_SIZE;
     Byte Data[MAX_MEM];
 
+    // One bit per 256 byte page written by the CPU since the last clear
+    u64 DirtyPages[NUM_PAGES / 64];
+
+    /*
+     * Where each 4 KiB window of the address space lives, Data by default.
+     *  - A nullptr write window sends writes to AttachedMapper (or drops them)
+     *  - Switching a bank only swaps these pointers, nothing is copied
+     */
+    Byte* ReadMap[NUM_WINDOWS];
+    Byte* WriteMap[NUM_WINDOWS];
+    Mapper* AttachedMapper = nullptr;
+
+#ifdef M6502_STATE_HASH
+    /*
+     * Zobrist style hash of Data, the XOR of HashKey(Address, Data[Address])
+     *  - Updated by every write that goes through Store(), so reading it is O(1)
+     *  - Host writes through operator[] bypass it, call RecomputeHash() after them
+     */
+    u64 Hash = 0;
+
+    // splitmix64 finaliser, stands in for a table of random keys
+    static u64 HashMix(u64 Key)
+    {
+        Key += 0x9E3779B97F4A7C15ull;
+        Key = (Key ^ (Key >> 30)) * 0xBF58476D1CE4E5B9ull;
+        Key = (Key ^ (Key >> 27)) * 0x94D049BB133111EBull;
+        return Key ^ (Key >> 31);
+    }
+
+    // Zero bytes hash to 0 so that cleared memory has a hash of 0
+    static u64 HashKey(u32 Address, Byte Value)
+    {
+        return Value ? HashMix(((u64)Address << 8) | Value) : 0;
+    }
+
+    void RecomputeHash()
+    {
+        Hash = 0;
+        for (u32 i = 0; i < MAX_MEM; i++)
+        {
+            Hash ^= HashKey(i, Data[i]);
+        }
+    }
+#endif
+
+    Mem() : DirtyPages()
+    {
+        UnmapAll();
+    }
+
+    Mem(const Mem& Other)
+    {
+        *this = Other;
+    }
+
+    // Windows that point into the other Data are rebound to our own Data
+    Mem& operator=(const Mem& Other)
+    {
+        for (u32 i = 0; i < MAX_MEM; i++)
+        {
+            Data[i] = Other.Data[i];
+        }
+        for (u32 i = 0; i < NUM_PAGES / 64; i++)
+        {
+            DirtyPages[i] = Other.DirtyPages[i];
+        }
+        auto Rebind = [this, &Other](Byte* Window) -> Byte*
+        {
+            const bool InOther = Window >= Other.Data && Window < Other.Data + MAX_MEM;
+            return InOther ? Data + (Window - Other.Data) : Window;
+        };
+        for (u32 i = 0; i < NUM_WINDOWS; i++)
+        {
+            ReadMap[i] = Rebind(Other.ReadMap[i]);
+            WriteMap[i] = Rebind(Other.WriteMap[i]);
+        }
+        AttachedMapper = Other.AttachedMapper;
+#ifdef M6502_STATE_HASH
+        Hash = Other.Hash;
+#endif
+        return *this;
+    }
+
     // Clear Memory
     void Initialise()
     {
@@ -38,20 +158,157 @@ struct m6502::Mem
         {
             Data[i] = 0;
         }
+        for (u64& Bits : DirtyPages)
+        {
+            Bits = 0;
+        }
+#ifdef M6502_STATE_HASH
+        Hash = 0;
+#endif
+    }
+
+    // Point a window at external storage, Write may be nullptr for read only windows
+    void MapWindow(u32 Window, Byte* Read, Byte* Write)
+    {
+        ReadMap[Window] = Read;
+        WriteMap[Window] = Write;
+    }
+
+    // Map Size bytes (a multiple of WINDOW_SIZE) starting at Address onto contiguous storage
+    void MapRange(Word Address, u32 Size, Byte* Read, Byte* Write)
+    {
+        for (u32 Offset = 0; Offset < Size; Offset += WINDOW_SIZE)
+        {
+            MapWindow((Address + Offset) >> WINDOW_SHIFT, Read + Offset, Write ? Write + Offset : nullptr);
+        }
+    }
+
+    // Back to a flat 64 KiB of Data with no mapper
+    void UnmapAll()
+    {
+        for (u32 i = 0; i < NUM_WINDOWS; i++)
+        {
+            ReadMap[i] = WriteMap[i] = Data + i * WINDOW_SIZE;
+        }
+        AttachedMapper = nullptr;
+    }
+
+    void MarkDirty(u32 Address)
+    {
+        DirtyPages[Address >> 14] |= 1ull << ((Address >> 8) & 63);
+    }
+
+    bool IsPageDirty(u32 Page) const
+    {
+        return (DirtyPages[Page >> 6] >> (Page & 63)) & 1;
+    }
+
+    /*
+     * Zero only the pages marked dirty, leaving the rest untouched.
+     *  - Much cheaper than Initialise() when only a few pages were written
+     *  - Host writes through operator[] must be marked with MarkDirty()
+     *  - Pages are cleared in whatever bank is currently mapped
+     */
+    void ClearDirty()
+    {
+        for (u32 Word64 = 0; Word64 < NUM_PAGES / 64; Word64++)
+        {
+            // Visit only the set bits, a fuzz case or a slice typically dirties a few pages of 256
+            for (u64 Bits = DirtyPages[Word64]; Bits; Bits &= Bits - 1)
+            {
+                const u32 Page = Word64 * 64 + __builtin_ctzll(Bits);
+                if (Byte* Window = WriteMap[Page / (WINDOW_SIZE / PAGE_SIZE)])
+                {
+                    ClearPage(Window, Page * PAGE_SIZE);
+                }
+            }
+            DirtyPages[Word64] = 0;
+        }
+    }
+
+    // Zero the page at Address inside Window, a plain memset unless the hash has to follow every byte
+    void ClearPage(Byte* Window, u32 Address)
+    {
+#ifdef M6502_STATE_HASH
+        for (u32 i = 0; i < PAGE_SIZE; i++)
+        {
+            Store(Window, Address + i, 0);
+        }
+#else
+        Byte* Target = Window + (Address & (WINDOW_SIZE - 1));
+        for (u32 i = 0; i < PAGE_SIZE; i++)
+        {
+            Target[i] = 0;
+        }
+#endif
+    }
+
+    // Copy a block in from the host (e.g. a program), marking the pages dirty
+    void Load(Word Address, const Byte* Bytes, u32 Size)
+    {
+        for (u32 i = 0; i < Size; i++)
+        {
+            const Word Target = Address + i;
+            Store(ReadMap[Target >> WINDOW_SHIFT], Target, Bytes[i]);
+            MarkDirty(Target);
+        }
+    }
+
+    // Store a byte into the window mapped at Address, keeping the hash up to date when that is Data
+    void Store(Byte* Window, u32 Address, Byte Value)
+    {
+        Byte& Target = Window[Address & (WINDOW_SIZE - 1)];
+#ifdef M6502_STATE_HASH
+        if (Window == Data + (Address & ~(WINDOW_SIZE - 1)))
+        {
+            Hash ^= HashKey(Address, Target) ^ HashKey(Address, Value);
+        }
+#endif
+        Target = Value;
+    }
+
+    // Store a byte straight into Data, bypassing the window tables (for mappers)
+    void StoreData(u32 Address, Byte Value)
+    {
+        Store(Data + (Address & ~(WINDOW_SIZE - 1)), Address, Value);
+    }
+
+    /*
+     * CPU write, goes through the mapper for windows without a write target
+     * @return true if the mapper handled the write
+     */
+    bool Write(Word Address, Byte Value)
+    {
+        Byte* Window = WriteMap[Address >> WINDOW_SHIFT];
+        if (Window)
+        {
+            Store(Window, Address, Value);
+            MarkDirty(Address);
+            return false;
+        }
+        if (AttachedMapper)
+        {
+            AttachedMapper->Write(*this, Address, Value);
+            return true;
+        }
+        return false;
     }
 
     // Read 1 Byte
     Byte operator[](u32 Address) const
     {
         // TODO: ASSERT that Address is < MAX_MEM
-        return Data[Address];
+        return ReadMap[Address >> WINDOW_SHIFT][Address & (WINDOW_SIZE - 1)];
     }
 
-    // Write 1 Byte
+    /*
+     * Write 1 Byte
+     *  - Host access, writes straight into the mapped read window (e.g. to load a ROM bank)
+     */
     Byte& operator[](u32 Address)
     {
         // TODO: ASSERT that Address is < MAX_MEM
-        return Data[Address];
+        return ReadMap[Address >> WINDOW_SHIFT][Address & (WINDOW_SIZE - 1)];
     }
 };
 
@@ -81,6 +338,111 @@ struct m6502::CPU
         StatusFlags Flag;
     };
 
+    /*
+     * Illegal opcodes throw by default.
+     *  - When cleared the CPU jams instead: Jammed is set, PC is left on the
+     *    offending opcode and Execute returns early (see the fuzzer)
+     */
+    bool ThrowOnIllegalOpcode = true;
+    bool Jammed = false;
+
+    /*
+     * Idle loop fast-forward
+     *  - A JMP to itself, or back over at most MAX_IDLE_LOOP_BYTES of loads,
+     *    is a spin loop with no side effects
+     *  - Once a pass ends with A, X, Y and PS as the pass before it did,
+     *    every further pass is identical, so whole passes are skipped by
+     *    only counting down their cycles. The last pass still runs, so PC,
+     *    registers and the cycles used match stepping through the loop
+     *  - Execute's budget is the next scheduled event, the skip never
+     *    crosses it. The snapshot is dropped at the start of each Execute,
+     *    as the host may change memory between calls
+     */
+    static constexpr Word MAX_IDLE_LOOP_BYTES = 32;
+
+    struct IdleLoopSnapshot
+    {
+        bool Armed = false;
+        Word JumpPC;    // Address of the loop's JMP
+        Byte A, X, Y, PS;
+        s32 Cycles;     // Cycles left after the JMP
+    };
+
+    IdleLoopSnapshot IdleLoop;
+
+    /*
+     * Ending a slice early
+     *  - Stop() zeroes the budget so Execute returns after the current
+     *    instruction, StopReason says why. The cut off budget is kept in
+     *    StoppedCycles and given back when Execute counts the cycles used,
+     *    so the instruction loop itself never checks for stops
+     *  - StopOnMapperWrite stops after any write handled by the mapper
+     *    (device I/O), checked on the mapper path only
+     *  - ExecuteTo() and ExecuteFusedTo() stop before the instruction at a
+     *    given PC
+     */
+    enum class StopReason : Byte
+    {
+        None,
+        MapperWrite,
+        Returned,
+        ReachedPC,
+    };
+
+    bool StopOnMapperWrite = false;
+    StopReason Stopped = StopReason::None;
+    s32 StoppedCycles = 0;
+
+    void Stop(StopReason Reason, s32& Cycles)
+    {
+        Stopped = Reason;
+        StoppedCycles += Cycles;
+        Cycles = 0;
+    }
+
+    /*
+     * Host calls into guest routines
+     *  - Call() pushes the caller's PC through PushPCToStack as the return
+     *    address, as JSR would, and runs the routine until the RTS that pops
+     *    it (SP back at CallReturnSP and PC back at CallReturnPC)
+     *  - Only RTS checks for the return, with one compare while no call is
+     *    active, and ends the slice through Stop()
+     *  - PC is back at the caller's on return, the registers are as the
+     *    routine left them. Calls nest, e.g. from a trap inside a routine
+     *  - A trapped Address runs its native handler instead (see TrapTable)
+     */
+    static constexpr s32 DEFAULT_CALL_CYCLES = 1000000;
+
+    struct CallRegisters
+    {
+        Byte A = 0, X = 0, Y = 0;
+        Byte PS = 0;
+    };
+
+    struct CallResult
+    {
+        Byte A, X, Y, PS;
+        s32 Cycles;     // Cycles used by the routine, up to and including its RTS
+        bool Returned;  // false if the budget ran out or the CPU jammed first
+    };
+
+    s32 CallReturnSP = -1;  // -1 while no call is active, never matches SP
+    Word CallReturnPC = 0;
+
+    /*
+     * Run the routine at Address like a function
+     * @MaxCycles Budget for the whole call, the routine is abandoned (with
+     *            its return address still on the stack) when it runs out
+     */
+    template <CPUVariant Variant = CPUVariant::NMOS6502>
+    CallResult Call(Word Address, CallRegisters In, Mem& memory, s32 MaxCycles = DEFAULT_CALL_CYCLES);
+
+    // Shadow call stack for guest profiling, JSR and RTS report to it when set
+    Profiler* CallProfiler = nullptr;
+
+    // Native replacements for guest subroutines, checked by JSR (and Call) when set
+    TrapTable* Traps = nullptr;
+
     // Reset Registers, Flags, and the Memory
     void Reset(Word ResetVector, Mem &memory)
     {
@@ -88,7 +450,11 @@ struct m6502::CPU
         SP = 0xFF;
         Flag.C = Flag.Z = Flag.I = Flag.D = Flag.B = Flag.V = Flag.N = 0;
         A = X = Y = 0;
+        Jammed = false;
+        Micro = {};
+        TickCyclesLeft = 0;
         memory.Initialise();
+        M6502_PROBE1(reset, PC);
     }
 
     Byte FetchByte(s32& Cycles, const Mem &memory)
@@ -127,19 +493,76 @@ struct m6502::CPU
         return LoByte | (HiByte << 8);
     }
 
+    // Read a pointer from the zero page, the high byte wraps to 0x00 rather than 0x100
+    Word ReadZeroPageWord(s32& Cycles, Byte Address, const Mem& memory)
+    {
+        Byte LoByte = ReadByte(Cycles, Address, memory);
+        Byte HiByte = ReadByte(Cycles, (Byte)(Address + 1), memory);
+        return LoByte | (HiByte << 8);
+    }
+
     // Write 1 byte to memory
     void WriteByte(Byte Value, s32& Cycles, Word Address, Mem& memory)
     {
-        memory[Address] = Value;
+        const bool ToMapper = memory.Write(Address, Value);
         Cycles--;
+        if (ToMapper && StopOnMapperWrite)
+        {
+            Stop(StopReason::MapperWrite, Cycles);
+        }
+    }
+
+    // A read cycle of an instruction, kept in Bus while ticking
+    template <bool Ticked>
+    Byte BusRead(Word Address, s32& Cycles, const Mem& memory)
+    {
+        const Byte Data = ReadByte(Cycles, Address, memory);
+        if constexpr (Ticked)
+        {
+            Bus = { Address, Data, false };
+        }
+        return Data;
+    }
+
+    template <bool Ticked>
+    Byte BusFetch(s32& Cycles, const Mem& memory)
+    {
+        return BusRead<Ticked>(PC++, Cycles, memory);
+    }
+
+    /*
+     * An internal cycle, on which the 6502 puts a read nobody uses on the bus
+     *  - Only kept in Bus while ticking, Execute just counts the cycle
+     */
+    template <bool Ticked>
+    void BusIdle(Word Address, s32& Cycles, const Mem& memory)
+    {
+        if constexpr (Ticked)
+        {
+            BusRead<Ticked>(Address, Cycles, memory);
+        }
+        else
+        {
+            Cycles--;
+        }
+    }
+
+    // A write cycle of an instruction, kept in Bus while ticking
+    template <bool Ticked>
+    void BusWrite(Byte Value, Word Address, s32& Cycles, Mem& memory)
+    {
+        if constexpr (Ticked)
+        {
+            Bus = { Address, Value, true };
+        }
+        WriteByte(Value, Cycles, Address, memory);
     }
 
     // Write 2 bytes to memory
     void WriteWord(Word Value, s32& Cycles, Word Address, Mem& memory)
     {
-        memory[Address] = Value & 0xFF;
-        memory[Address + 1] = (Value >> 8);
-        Cycles -= 2;
+        WriteByte(Value & 0xFF, Cycles, Address, memory);
+        WriteByte(Value >> 8, Cycles, Address + 1, memory);
     }
 
     // @returns the stack pointer as a full 16-bit address
@@ -148,19 +571,37 @@ struct m6502::CPU
         return 0x100 | SP;
     }
 
-    // Push the PC-1 onto the stack
+    /*
+     * Push the PC-1 onto the stack
+     *  - One byte at a time, the stack wraps around within page 1
+     */
     void PushPCToStack( s32& Cycles, Mem& memory)
     {
-        WriteWord(PC - 1, Cycles, SPToAddress() - 1,  memory);
-        SP -= 2;
+        Word Value = PC - 1;
+        WriteByte(Value >> 8, Cycles, SPToAddress(), memory);
+        SP--;
+        WriteByte(Value & 0xFF, Cycles, SPToAddress(), memory);
+        SP--;
     }
 
+#ifdef M6502_STATE_HASH
+    // Hash of the registers and memory, O(1) as the memory part is kept by Mem
+    u64 StateHash(const Mem& memory) const
+    {
+        const u64 Registers = PC | ((u64)SP << 16) | ((u64)A << 24) | ((u64)X << 32) | ((u64)Y << 40) | ((u64)PS << 48);
+        // The top bit keeps register keys apart from memory keys
+        return memory.Hash ^ Mem::HashMix(Registers | (1ull << 63));
+    }
+#endif
+
     Word PopWordFromStack( s32& Cycles, Mem& memory)
     {
-        Word Value = ReadWord(Cycles, SPToAddress() + 1, memory);
-        SP += 2;
+        SP++;
+        Byte LoByte = ReadByte(Cycles, SPToAddress(), memory);
+        SP++;
+        Byte HiByte = ReadByte(Cycles, SPToAddress(), memory);
         Cycles--;
-        return Value;
+        return LoByte | (HiByte << 8);
     }
 
     /*
@@ -212,6 +653,16 @@ struct m6502::CPU
         INS_JMP_ABS = 0x4C,
         INS_JMP_IND = 0x6C;
 
+    // 65C02 only
+    static constexpr Byte
+        INS_LDA_INDZP = 0xB2,
+        INS_STA_INDZP = 0x92,
+        INS_STZ_ZP = 0x64,
+        INS_STZ_ZPX = 0x74,
+        INS_STZ_ABS = 0x9C,
+        INS_STZ_ABSX = 0x9E,
+        INS_JMP_ABSX_IND = 0x7C;
+
     /*
      * Sets the correct process status after a load register instruction.
      * - LDA, LDX, LDY
@@ -223,50 +674,168 @@ struct m6502::CPU
         Flag.N = (Register & 0b10000000) > 0;
     }
 
-    // @return the number of cycles used
+    /*
+     * Run instructions until the budget is used up (the last one may
+     * overrun it), the CPU jams or Stop() is called
+     *  - Variant is resolved at compile time, each one gets its own
+     *    dispatch switch (instantiated in m6502.cpp)
+     * @return the number of cycles used
+     */
+    template <CPUVariant Variant = CPUVariant::NMOS6502>
     s32 Execute(s32 Cycles, Mem& memory);
 
-    // Addressing mode - Zero page
-    Word AddrZeroPage(s32& Cycles, const Mem& memory);
+    /*
+     * Execute, but stop (StopReason::ReachedPC) before running the
+     * instruction at StopPC, even the first one
+     *  - One PC compare per instruction, in its own instantiation so
+     *    Execute never pays for it. Memory is not touched to catch the PC
+     */
+    template <CPUVariant Variant = CPUVariant::NMOS6502>
+    s32 ExecuteTo(Word StopPC, s32 Cycles, Mem& memory);
 
-    // Addressing mode - Zero page with X offset
-    Word AddrZeroPageX(s32& Cycles, const Mem& memory);
+    // Cycles used by a slice, folding back what a Stop() cut off
+    s32 CyclesUsed(s32 CyclesRequested, s32 Cycles)
+    {
+        Cycles += StoppedCycles;
+        StoppedCycles = 0;
+        M6502_PROBE3(slice_end, CyclesRequested, CyclesRequested - Cycles, PC);
+        return CyclesRequested - Cycles;
+    }
 
-    // Addressing mode - Zero page with Y offset
-    Word AddrZeroPageY(s32& Cycles, const Mem& memory);
+    // Body of Execute for one fetched opcode, or one cycle of it for Tick, only defined in m6502.cpp
+    template <CPUVariant Variant, bool Ticked = false>
+    bool ExecuteOpcode(Byte Ins, s32& Cycles, Mem& memory);
 
-    // Addressing mode - Absolute
-    Word AddrAbsolute(s32& Cycles, const Mem& memory);
+    // Called after a JMP at JumpPC, see IdleLoopSnapshot
+    void FastForwardIdleLoop(Word JumpPC, s32& Cycles, const Mem& memory);
+
+    /*
+     * Same results and cycle counts as Execute, but common opcode pairs
+     * (and the LDX #; LDY #; JSR triple) run as single fused handlers
+     * @return the number of cycles used
+     */
+    template <CPUVariant Variant = CPUVariant::NMOS6502>
+    s32 ExecuteFused(s32 Cycles, Mem& memory);
 
-    // Addressing mode - Absolute with X offset
-    Word AddrAbsoluteX(s32& Cycles, const Mem& memory);
+    // ExecuteFused stopping as ExecuteTo, fused runs that would step over StopPC run unfused
+    template <CPUVariant Variant = CPUVariant::NMOS6502>
+    s32 ExecuteFusedTo(Word StopPC, s32 Cycles, Mem& memory);
+
+    // Body of ExecuteFused and ExecuteFusedTo, only defined in m6502.cpp
+    template <CPUVariant Variant, bool StopAtPC>
+    s32 ExecuteFusedLoop(Word StopPC, s32 Cycles, Mem& memory);
 
     /*
-     * Addressing mode - Absolute with X offset (5 cycles)
-     *  - See "STA Absolute, X"
+     * Cycle stepping
+     *  - Every instruction is defined once, as micro-ops: its addressing
+     *    mode and operation are split into bus cycles, with the dummy reads
+     *    the 6502 makes on its internal cycles. Execute runs all of an
+     *    instruction's micro-ops straight through, Tick() runs one
+     *  - So each read and write lands on its own cycle: a device stepped
+     *    between ticks sees PC move with every fetch, and a store's memory
+     *    change only on its last cycle. Bus holds the last tick's access
+     *  - The instruction in flight is kept in Micro, a Cycle of 0 is an
+     *    instruction boundary
+     *  - A trapped JSR runs its native routine on the JSR's third cycle,
+     *    the rest of the JSR and the routine's cycles tick out idle
+     *    (TickCyclesLeft)
+     *  - Stopped is set by the instruction that stopped, until the next one
+     *    starts. A jammed CPU keeps ticking without doing anything
      */
-    Word AddrAbsoluteX_5(s32& Cycles, const Mem& memory);
+    struct MicroOps
+    {
+        Byte Opcode = 0;
+        Byte Cycle = 0;     // Of the instruction, 1 is the opcode fetch
+        Word Base = 0;      // The zero page pointer, then the address before indexing
+        Word Address = 0;   // The effective address, built up over the cycles
+    };
+
+    struct BusCycle
+    {
+        Word Address = 0;
+        Byte Data = 0;
+        bool Write = false;
+    };
+
+    MicroOps Micro;
+    BusCycle Bus;
+    s32 TickCyclesLeft = 0;
 
-    // Addressing mode - Absolute with Y offset
-    Word AddrAbsoluteY(s32& Cycles, const Mem& memory);
+    template <CPUVariant Variant = CPUVariant::NMOS6502>
+    void Tick(Mem& memory)
+    {
+        if (TickCyclesLeft > 0)
+        {
+            TickCyclesLeft--;
+            return;
+        }
+        TickCycle<Variant>(memory);
+    }
+
+    // true when the next Tick() starts a new instruction
+    bool AtInstructionBoundary() const
+    {
+        return Micro.Cycle == 0 && TickCyclesLeft == 0;
+    }
+
+    // One micro-op, out of line so Tick() stays small
+    template <CPUVariant Variant>
+    void TickCycle(Mem& memory);
 
     /*
-     * Addressing mode - Absolute with Y offset (5 cycles)
-     *  - Takes extra cycle for page boundary
-     *  - See "STA Absolute, Y"
+     * Addressing modes as micro-ops, only defined in m6502.cpp
+     *  - Each runs M's cycles from M.Cycle on: all of them for Execute,
+     *    the current one when Ticked
+     *  - @return true when a tick ended inside the mode, false once
+     *    M.Address is the effective address and the current cycle is the
+     *    operation's
      */
-    Word AddrAbsoluteY_5(s32& Cycles, const Mem& memory);
+
+    // Addressing mode - Immediate, the operand's own address
+    template <CPUVariant Variant, bool Ticked>
+    bool AddrImmediate(MicroOps& M);
+
+    // Addressing mode - Zero page
+    template <CPUVariant Variant, bool Ticked>
+    bool AddrZeroPage(MicroOps& M, s32& Cycles, const Mem& memory);
+
+    // Addressing mode - Zero page with X or Y offset, wrapping within the zero page
+    template <CPUVariant Variant, bool Ticked>
+    bool AddrZeroPageIndexed(MicroOps& M, Byte Index, s32& Cycles, const Mem& memory);
+
+    // Addressing mode - Absolute
+    template <CPUVariant Variant, bool Ticked>
+    bool AddrAbsolute(MicroOps& M, s32& Cycles, const Mem& memory);
+
+    /*
+     * Addressing mode - Absolute with X or Y offset
+     *  - Reads take an extra cycle for a page boundary, writes always do
+     *    (see "STA Absolute, X")
+     */
+    template <CPUVariant Variant, bool Ticked, bool Write>
+    bool AddrAbsoluteIndexed(MicroOps& M, Byte Index, s32& Cycles, const Mem& memory);
 
     // Addressing mode - Indirect X | Indexed Indirect
-    Word AddrIndirectX(s32& Cycles, const Mem& memory);
+    template <CPUVariant Variant, bool Ticked>
+    bool AddrIndirectX(MicroOps& M, s32& Cycles, const Mem& memory);
+
+    /*
+     * Addressing mode - Indirect Y | Indirect Indexed
+     *  - Reads take an extra cycle for a page boundary, writes always do
+     *    (see "STA Indirect, Y")
+     */
+    template <CPUVariant Variant, bool Ticked, bool Write>
+    bool AddrIndirectY(MicroOps& M, s32& Cycles, const Mem& memory);
 
-    // Addressing mode - Indirect Y | Indirect Indexed
-    Word AddrIndirectY(s32& Cycles, const Mem& memory);
+    // Addressing mode - Zero page indirect (65C02)
+    template <CPUVariant Variant, bool Ticked>
+    bool AddrIndirectZeroPage(MicroOps& M, s32& Cycles, const Mem& memory);
 
     /*
-     * Addressing mode - Indirect Y | Indirect Indexed (6 cycles)
-     *  - Takes extra cycle for page boundary
-     *  - See "STA Indirect, Y"
+     * The extra cycle of an indexed address while its high byte is fixed
+     *  - NMOS reads the address before the fix, the 65C02 reads the last
+     *    operand byte again rather than a stray address
      */
-    Word AddrIndirectY_6(s32& Cycles, const Mem& memory);
+    template <CPUVariant Variant, bool Ticked>
+    void FixHighByte(const MicroOps& M, s32& Cycles, const Mem& memory);
 };
@@ -0,0 +1,139 @@
+#include "m6502_c.h"
+
+#include <new>
+#include "m6502.h"
+
+struct m6502_machine
+{
+    m6502::CPU cpu;
+    m6502::Mem memory;
+    int variant;
+};
+
+uint32_t m6502_abi_version(void)
+{
+    return M6502_ABI_VERSION;
+}
+
+m6502_machine* m6502_create(int variant)
+{
+    if (variant < M6502_VARIANT_NMOS6502 || variant > M6502_VARIANT_RP2A03)
+    {
+        return nullptr;
+    }
+    m6502_machine* machine = new (std::nothrow) m6502_machine;
+    if (!machine)
+    {
+        return nullptr;
+    }
+    machine->variant = variant;
+    machine->cpu.ThrowOnIllegalOpcode = false;
+    machine->cpu.Reset(0, machine->memory);
+    return machine;
+}
+
+void m6502_destroy(m6502_machine* machine)
+{
+    delete machine;
+}
+
+void m6502_reset(m6502_machine* machine, uint16_t pc)
+{
+    machine->cpu.Reset(pc, machine->memory);
+}
+
+int m6502_load(m6502_machine* machine, uint16_t address, const uint8_t* data, uint32_t size)
+{
+    // address is at most 0xFFFF, so this cannot wrap as address + size would
+    if (size > m6502::Mem::MAX_MEM - address)
+    {
+        return -1;
+    }
+    machine->memory.Load(address, data, size);
+    return 0;
+}
+
+int32_t m6502_run(m6502_machine* machine, int32_t cycles)
+{
+    using m6502::CPUVariant;
+    switch (machine->variant)
+    {
+        case M6502_VARIANT_CMOS65C02:
+            return machine->cpu.Execute<CPUVariant::CMOS65C02>(cycles, machine->memory);
+        case M6502_VARIANT_RP2A03:
+            return machine->cpu.Execute<CPUVariant::RP2A03>(cycles, machine->memory);
+        default:
+            return machine->cpu.Execute<CPUVariant::NMOS6502>(cycles, machine->memory);
+    }
+}
+
+void m6502_get_state(const m6502_machine* machine, m6502_state* state)
+{
+    const m6502::CPU& cpu = machine->cpu;
+    state->pc = cpu.PC;
+    state->sp = cpu.SP;
+    state->a = cpu.A;
+    state->x = cpu.X;
+    state->y = cpu.Y;
+    state->ps = cpu.PS;
+    state->jammed = cpu.Jammed;
+}
+
+void m6502_set_state(m6502_machine* machine, const m6502_state* state)
+{
+    m6502::CPU& cpu = machine->cpu;
+    cpu.PC = state->pc;
+    cpu.SP = state->sp;
+    cpu.A = state->a;
+    cpu.X = state->x;
+    cpu.Y = state->y;
+    cpu.PS = state->ps;
+    cpu.Jammed = state->jammed != 0;
+}
+
+uint8_t m6502_read(const m6502_machine* machine, uint16_t address)
+{
+    return machine->memory[address];
+}
+
+void m6502_write(m6502_machine* machine, uint16_t address, uint8_t value)
+{
+    machine->memory.Load(address, &value, 1);
+}
+
+uint8_t* m6502_memory(m6502_machine* machine, uint32_t* size)
+{
+    if (size)
+    {
+        *size = m6502::Mem::MAX_MEM;
+    }
+    return machine->memory.Data;
+}
+
+void m6502_run_batch(m6502_machine* const* machines, uint32_t count, int32_t cycles, int32_t* cycles_used)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const int32_t Used = m6502_run(machines[i], cycles);
+        if (cycles_used)
+        {
+            cycles_used[i] = Used;
+        }
+    }
+}
+
+void m6502_get_state_batch(m6502_machine* const* machines, uint32_t count, m6502_state* states)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m6502_get_state(machines[i], &states[i]);
+    }
+}
+
+void m6502_set_state_batch(m6502_machine* const* machines, uint32_t count, const m6502_state* states)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m6502_set_state(machines[i], &states[i]);
+    }
+}
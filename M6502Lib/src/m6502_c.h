@@ -0,0 +1,93 @@
+/*
+ * C ABI for embedding from other runtimes (ctypes/cffi, Rust, ...)
+ *
+ * Built into libm6502.so by the M6502Shared target. Machines are opaque
+ * handles, nothing here throws: illegal opcodes jam the CPU (see
+ * m6502_state.jammed). The batch calls take arrays of handles so callers
+ * cross the FFI boundary once per slice rather than once per machine.
+ *
+ *  lib = ctypes.CDLL("libm6502.so")
+ *  lib.m6502_create.restype = ctypes.c_void_p
+ *  machine = ctypes.c_void_p(lib.m6502_create(0))
+ *  lib.m6502_reset(machine, 0x0200)
+ *  lib.m6502_load(machine, 0x0200, program, len(program))
+ *  lib.m6502_run(machine, 10000)
+ *
+ * Only append to this header, M6502_ABI_VERSION goes up when something
+ * existing changes.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define M6502_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(M6502_SHARED_BUILD)
+#define M6502_API __attribute__((visibility("default")))
+#else
+#define M6502_API
+#endif
+
+typedef struct m6502_machine m6502_machine;
+
+enum m6502_variant
+{
+    M6502_VARIANT_NMOS6502 = 0,
+    M6502_VARIANT_CMOS65C02 = 1,
+    M6502_VARIANT_RP2A03 = 2,
+};
+
+typedef struct m6502_state
+{
+    uint16_t pc;
+    uint8_t sp;
+    uint8_t a;
+    uint8_t x;
+    uint8_t y;
+    uint8_t ps;
+    uint8_t jammed;
+} m6502_state;
+
+M6502_API uint32_t m6502_abi_version(void);
+
+// @return a machine with zeroed memory, or NULL for an unknown variant or out of memory
+M6502_API m6502_machine* m6502_create(int variant);
+M6502_API void m6502_destroy(m6502_machine* machine);
+
+// Reset registers to PC = pc and clear the memory
+M6502_API void m6502_reset(m6502_machine* machine, uint16_t pc);
+
+// @return 0, or -1 if the image runs past the end of memory
+M6502_API int m6502_load(m6502_machine* machine, uint16_t address, const uint8_t* data, uint32_t size);
+
+// @return the number of cycles used
+M6502_API int32_t m6502_run(m6502_machine* machine, int32_t cycles);
+
+M6502_API void m6502_get_state(const m6502_machine* machine, m6502_state* state);
+M6502_API void m6502_set_state(m6502_machine* machine, const m6502_state* state);
+
+M6502_API uint8_t m6502_read(const m6502_machine* machine, uint16_t address);
+M6502_API void m6502_write(m6502_machine* machine, uint16_t address, uint8_t value);
+
+/*
+ * Zero-copy view of the 64 KiB memory image, valid until m6502_destroy
+ *  - Writes through it are not tracked as dirty, use m6502_load or
+ *    m6502_write when that matters
+ */
+M6502_API uint8_t* m6502_memory(m6502_machine* machine, uint32_t* size);
+
+/*
+ * Batches
+ *  - cycles_used may be NULL
+ */
+M6502_API void m6502_run_batch(m6502_machine* const* machines, uint32_t count, int32_t cycles, int32_t* cycles_used);
+M6502_API void m6502_get_state_batch(m6502_machine* const* machines, uint32_t count, m6502_state* states);
+M6502_API void m6502_set_state_batch(m6502_machine* const* machines, uint32_t count, const m6502_state* states);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,79 @@
+#include "m6502_coroutine.h"
+#include <algorithm>
+
+std::coroutine_handle<> m6502::ExecutionTask::TransferToResumer::await_suspend(Handle Task) noexcept
+{
+    // Resume() has no continuation, returning to it is returning from resume()
+    std::coroutine_handle<> Continuation = Task.promise().Continuation;
+    Task.promise().Continuation = nullptr;
+    return Continuation ? Continuation : std::noop_coroutine();
+}
+
+m6502::YieldPoint m6502::ExecutionTask::Awaiter::await_resume() const
+{
+    if (Task.promise().Exception)
+    {
+        std::rethrow_exception(Task.promise().Exception);
+    }
+    return Task.promise().Last;
+}
+
+m6502::ExecutionTask& m6502::ExecutionTask::operator=(ExecutionTask&& Other) noexcept
+{
+    if (this != &Other)
+    {
+        if (Task)
+        {
+            Task.destroy();
+        }
+        Task = Other.Task;
+        Other.Task = nullptr;
+    }
+    return *this;
+}
+
+m6502::ExecutionTask::~ExecutionTask()
+{
+    if (Task)
+    {
+        Task.destroy();
+    }
+}
+
+m6502::YieldPoint m6502::ExecutionTask::Resume()
+{
+    if (!Done())
+    {
+        Task.resume();
+    }
+    return Awaiter{ Task }.await_resume();
+}
+
+m6502::ExecutionTask m6502::RunAsCoroutine(CPU& cpu, Mem& memory, YieldPolicy Policy)
+{
+    cpu.StopOnMapperWrite = Policy.YieldOnMapperWrite;
+    // A non-positive quantum would yield empty slices forever
+    const s32 Quantum = std::max(Policy.Quantum, 1);
+    s64 Remaining = Policy.TotalCycles;
+    while (Policy.TotalCycles < 0 || Remaining > 0)
+    {
+        const s32 Slice = (Policy.TotalCycles < 0 || Remaining > Quantum) ? Quantum : (s32)Remaining;
+        const s32 Used = cpu.Execute(Slice, memory);
+        Remaining -= Used;
+
+        if (cpu.Jammed)
+        {
+            co_yield YieldPoint{ YieldReason::Halt, Used };
+            cpu.Jammed = false;
+        }
+        else if (cpu.Stopped == CPU::StopReason::MapperWrite)
+        {
+            co_yield YieldPoint{ YieldReason::MapperWrite, Used };
+        }
+        else
+        {
+            co_yield YieldPoint{ YieldReason::Quantum, Used };
+        }
+    }
+    cpu.StopOnMapperWrite = false;
+}
@@ -0,0 +1,118 @@
+/*
+ * Running a machine as a C++20 coroutine
+ *
+ * For hosts with an async event loop: instead of blocking in Execute with a
+ * guessed budget, the machine runs as a coroutine that yields back to the
+ * host at instruction boundaries
+ *  - Every YieldPolicy::Quantum cycles
+ *  - After a write handled by the mapper (device I/O), if enabled
+ *  - When the CPU jams (halt); resuming clears Jammed and retries
+ * All state lives in the CPU and Mem, so nothing is lost across yields and
+ * the host may inspect or change them while the task is suspended. Between
+ * yields the task is just a plain Execute call.
+ *
+ * Drive it with Resume() from ordinary code, or co_await it from a host
+ * coroutine: that resumes the machine and continues the awaiting coroutine
+ * (by symmetric transfer, on the same thread) at the next yield, so it works
+ * with any executor that resumes coroutine handles.
+ */
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct YieldPolicy;
+    struct YieldPoint;
+    struct ExecutionTask;
+
+    enum class YieldReason : Byte
+    {
+        Quantum,        // Used up a quantum
+        MapperWrite,    // Wrote through the mapper, PC is past the writing instruction
+        Halt,           // Jammed on an illegal opcode, PC is on the opcode
+        Finished,       // Ran TotalCycles, the task is done
+    };
+
+    // Run cpu on memory until Policy.TotalCycles have been used (forever if negative)
+    ExecutionTask RunAsCoroutine(CPU& cpu, Mem& memory, YieldPolicy Policy);
+}
+
+struct m6502::YieldPolicy
+{
+    s32 Quantum = 10000;            // Raised to 1 if not positive
+    bool YieldOnMapperWrite = false;
+    s64 TotalCycles = -1;
+};
+
+struct m6502::YieldPoint
+{
+    YieldReason Reason;
+    s32 Cycles;     // Cycles run since the previous yield
+};
+
+struct m6502::ExecutionTask
+{
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    // Hands control back to whoever resumed the task
+    struct TransferToResumer
+    {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle Task) noexcept;
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type
+    {
+        YieldPoint Last = { YieldReason::Quantum, 0 };
+        std::coroutine_handle<> Continuation;
+        std::exception_ptr Exception;
+
+        ExecutionTask get_return_object() { return ExecutionTask(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        TransferToResumer final_suspend() const noexcept { return {}; }
+        TransferToResumer yield_value(YieldPoint Point) noexcept
+        {
+            Last = Point;
+            return {};
+        }
+        void return_void() { Last = { YieldReason::Finished, 0 }; }
+        void unhandled_exception() { Exception = std::current_exception(); }
+    };
+
+    struct Awaiter
+    {
+        Handle Task;
+
+        bool await_ready() const noexcept { return Task.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> Awaiting) noexcept
+        {
+            Task.promise().Continuation = Awaiting;
+            return Task;
+        }
+        YieldPoint await_resume() const;
+    };
+
+    explicit ExecutionTask(Handle Task) : Task(Task) {}
+    ExecutionTask(ExecutionTask&& Other) noexcept : Task(Other.Task) { Other.Task = nullptr; }
+    ExecutionTask& operator=(ExecutionTask&& Other) noexcept;
+    ExecutionTask(const ExecutionTask&) = delete;
+    ExecutionTask& operator=(const ExecutionTask&) = delete;
+    ~ExecutionTask();
+
+    bool Done() const { return !Task || Task.done(); }
+
+    /*
+     * Run until the next yield (for hosts without coroutines)
+     *  - Rethrows what the CPU threw, e.g. on an illegal opcode
+     */
+    YieldPoint Resume();
+
+    Awaiter operator co_await() const noexcept { return { Task }; }
+
+    Handle Task;
+};
@@ -0,0 +1,358 @@
+#include "m6502_disasm.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    using namespace m6502;
+
+    Word OperandAt(const Byte* Image, u32 Address, const OpcodeInfo& Info)
+    {
+        const u32 Length = Info.Length();
+        if (Length == 1)
+        {
+            return 0;
+        }
+        const Byte Lo = Image[(Word)(Address + 1)];
+        return Length == 2 ? Lo : (Word)(Lo | (Image[(Word)(Address + 2)] << 8));
+    }
+
+    // Where a JMP (abs) at Address goes, with the NMOS page wrap of the pointer's high byte
+    Word IndirectTarget(const Byte* Image, Word Pointer, CPUVariant Variant)
+    {
+        const Word HiAddress = Variant == CPUVariant::CMOS65C02 ? (Word)(Pointer + 1)
+                                                                : (Word)((Pointer & 0xFF00) | ((Pointer + 1) & 0x00FF));
+        return (Word)(Image[Pointer] | (Image[HiAddress] << 8));
+    }
+}
+
+std::vector<m6502::Word> m6502::CodeMap::VectorEntries(const Byte* Image)
+{
+    std::vector<Word> Entries;
+    for (Word Vector : { NMI_VECTOR, RESET_VECTOR, IRQ_VECTOR })
+    {
+        Entries.push_back((Word)(Image[Vector] | (Image[Vector + 1] << 8)));
+    }
+    return Entries;
+}
+
+const m6502::OpcodeInfo* m6502::CodeMap::DecodeAt(const Byte* Image, u32 Address) const
+{
+    const OpcodeInfo* Info = OpcodeInfo::Decode(Image[Address], Variant);
+    return Info && InRegion(Address + Info->Length() - 1) ? Info : nullptr;
+}
+
+void m6502::CodeMap::Analyse(const Byte* Image, const std::vector<Word>& Entries, CPUVariant CpuVariant,
+                             u32 Start, u32 End)
+{
+    Variant = CpuVariant;
+    // Clamp to the image; an empty region maps nothing
+    RegionEnd = std::min<u32>(End, Mem::MAX_MEM);
+    RegionStart = std::min(Start, RegionEnd);
+    memset(Types, (int)ByteType::Data, sizeof(Types));
+    memset(Leaders, 0, sizeof(Leaders));
+    Blocks.clear();
+    Subroutines.clear();
+    Overlaps = 0;
+
+    std::vector<Word> Work(Entries.rbegin(), Entries.rend());
+    Trace(Image, Work);
+    BuildBlocks(Image);
+}
+
+void m6502::CodeMap::Trace(const Byte* Image, std::vector<Word>& Work)
+{
+    auto Follow = [this, &Work](u32 Target)
+    {
+        if (InRegion(Target) && !IsLeader(Target))
+        {
+            Leaders[Target >> 6] |= 1ull << (Target & 63);
+            Work.push_back((Word)Target);
+        }
+    };
+
+    while (!Work.empty())
+    {
+        u32 PC = Work.back();
+        Work.pop_back();
+        if (!InRegion(PC))
+        {
+            continue;
+        }
+        Leaders[PC >> 6] |= 1ull << (PC & 63);
+
+        // Decode straight on until control leaves or joins code already found
+        while (Types[PC] == ByteType::Data)
+        {
+            // What an excluded opcode will be at run time is unknown
+            const OpcodeInfo* Info = IsExcluded(PC, 1) ? nullptr : DecodeAt(Image, PC);
+            if (!Info)
+            {
+                break;
+            }
+            const u32 Length = Info->Length();
+            bool Clashes = false;
+            for (u32 i = 1; i < Length; i++)
+            {
+                Clashes |= Types[PC + i] != ByteType::Data;
+            }
+            if (Clashes)
+            {
+                Overlaps++;
+                break;
+            }
+            Types[PC] = ByteType::Opcode;
+            for (u32 i = 1; i < Length; i++)
+            {
+                Types[PC + i] = ByteType::Operand;
+            }
+
+            // Nor are the targets of an excluded operand, only its fall through
+            if (IsExcluded(PC, Length))
+            {
+                if (!Info->EndsFlow())
+                {
+                    Follow(PC + Length);
+                }
+                break;
+            }
+
+            const Word Operand = OperandAt(Image, PC, *Info);
+            switch (Info->Type)
+            {
+                case OpcodeKind::Jsr:
+                    if (!IsSubroutine(Operand))
+                    {
+                        Subroutines.insert(std::upper_bound(Subroutines.begin(), Subroutines.end(), Operand), Operand);
+                    }
+                    Follow(Operand);
+                    Follow(PC + Length);
+                    break;
+                case OpcodeKind::Jmp:
+                    Follow(Operand);
+                    break;
+                case OpcodeKind::JmpInd:
+                    if (Info->AddrMode == AddressingMode::Ind)
+                    {
+                        Follow(IndirectTarget(Image, Operand, Variant));
+                    }
+                    break;
+                default:
+                    break;
+            }
+            if (Info->EndsFlow() || Info->Type == OpcodeKind::Jsr)
+            {
+                break;
+            }
+            PC += Length;
+            if (!InRegion(PC))
+            {
+                break;
+            }
+        }
+
+        // A target inside an instruction found earlier
+        if (InRegion(PC) && Types[PC] == ByteType::Operand && IsLeader(PC))
+        {
+            Overlaps++;
+        }
+    }
+}
+
+void m6502::CodeMap::BuildBlocks(const Byte* Image)
+{
+    for (u32 Word64 = RegionStart >> 6; Word64 < (RegionEnd + 63) >> 6; Word64++)
+    {
+        // Reread after each block, splitting a long one adds a leader further on
+        for (u64 Bits = Leaders[Word64]; Bits; )
+        {
+            const u32 Bit = (u32)__builtin_ctzll(Bits);
+            const u32 Start = Word64 * 64 + Bit;
+            if (Types[Start] == ByteType::Opcode && !IsExcluded(Start, OpcodeInfo::Decode(Image[Start], Variant)->Length()))
+            {
+                Blocks.push_back(BuildBlock(Image, Start));
+            }
+            Bits = Leaders[Word64] & ~((2ull << Bit) - 1);
+        }
+    }
+}
+
+m6502::CodeMap::Block m6502::CodeMap::BuildBlock(const Byte* Image, u32 Start)
+{
+    Block Blk;
+    Blk.Start = (Word)Start;
+    u32 PC = Start;
+    while (true)
+    {
+        const OpcodeInfo& Info = *OpcodeInfo::Decode(Image[PC], Variant);
+        const u32 Length = Info.Length();
+        const Word Operand = OperandAt(Image, PC, Info);
+        Blk.Instructions++;
+        Blk.Size += Length;
+        const u32 Next = PC + Length;
+        switch (Info.Type)
+        {
+            case OpcodeKind::Jsr:
+                Blk.Successors.push_back({ Operand, EdgeType::Call });
+                break;
+            case OpcodeKind::Jmp:
+                Blk.Successors.push_back({ Operand, EdgeType::Jump });
+                break;
+            case OpcodeKind::JmpInd:
+                if (Info.AddrMode == AddressingMode::Ind)
+                {
+                    Blk.Successors.push_back({ IndirectTarget(Image, Operand, Variant), EdgeType::Indirect });
+                }
+                else
+                {
+                    Blk.Unresolved = true;
+                }
+                break;
+            default:
+                break;
+        }
+        if (Info.EndsFlow())
+        {
+            return Blk;
+        }
+        if (Info.Type == OpcodeKind::Jsr)
+        {
+            Blk.Successors.push_back({ (Word)Next, EdgeType::FallThrough });
+            return Blk;
+        }
+        if (!InRegion(Next) || Types[Next] != ByteType::Opcode)
+        {
+            Blk.EndsIllegal = true;
+            return Blk;
+        }
+        if (IsExcluded(Next, OpcodeInfo::Decode(Image[Next], Variant)->Length()))
+        {
+            Blk.EndsExcluded = true;
+            return Blk;
+        }
+        if (Blk.Instructions == MaxBlockInstructions)
+        {
+            Leaders[Next >> 6] |= 1ull << (Next & 63);
+        }
+        if (IsLeader(Next))
+        {
+            Blk.Successors.push_back({ (Word)Next, EdgeType::FallThrough });
+            return Blk;
+        }
+        PC = Next;
+    }
+}
+
+const m6502::CodeMap::Block* m6502::CodeMap::FindBlock(Word Address) const
+{
+    auto After = std::upper_bound(Blocks.begin(), Blocks.end(), Address,
+                                  [](Word Value, const Block& Blk) { return Value < Blk.Start; });
+    if (After == Blocks.begin())
+    {
+        return nullptr;
+    }
+    const Block& Blk = *(After - 1);
+    return Address < Blk.Start + Blk.Size ? &Blk : nullptr;
+}
+
+bool m6502::CodeMap::IsSubroutine(Word Address) const
+{
+    return std::binary_search(Subroutines.begin(), Subroutines.end(), Address);
+}
+
+std::string m6502::CodeMap::Listing(const Byte* Image) const
+{
+    constexpr u32 BYTES_PER_ROW = 8;
+    static const char HEX[] = "0123456789ABCDEF";
+    std::string Out;
+    Out.reserve((RegionEnd - RegionStart) * 12);
+    char Line[80];
+
+    // snprintf would cost more than the whole analysis, so the hex is written by hand
+    auto Hex = [](char* At, u32 Value, u32 Digits)
+    {
+        while (Digits-- > 0)
+        {
+            *At++ = HEX[(Value >> (Digits * 4)) & 0xF];
+        }
+        return At;
+    };
+
+    u32 Address = RegionStart;
+    while (Address < RegionEnd)
+    {
+        char* At = Hex(Line, Address, 4);
+        *At++ = ' ';
+        *At++ = ' ';
+        if (Types[Address] == ByteType::Opcode)
+        {
+            const OpcodeInfo& Info = *OpcodeInfo::Decode(Image[Address], Variant);
+            const u32 Length = Info.Length();
+            if (IsLeader(Address))
+            {
+                Out += IsSubroutine((Word)Address) ? "\nsub_" : "\nL_";
+                Out.append(Line, 4);
+                Out += ":\n";
+            }
+            for (u32 i = 0; i < 3; i++)
+            {
+                if (i < Length)
+                {
+                    At = Hex(At, Image[(Word)(Address + i)], 2);
+                }
+                else
+                {
+                    *At++ = ' ';
+                    *At++ = ' ';
+                }
+                *At++ = ' ';
+            }
+            *At++ = ' ';
+            *At++ = ' ';
+            *At++ = ' ';
+            At += Info.Format(OperandAt(Image, Address, Info), At, (u32)(Line + sizeof(Line) - At));
+            Address += Length;
+        }
+        else
+        {
+            // A row of data runs up to the next code, or a row's worth
+            memcpy(At, ".byte ", 6);
+            At += 6;
+            for (u32 i = 0; i < BYTES_PER_ROW && Address < RegionEnd && Types[Address] != ByteType::Opcode; i++)
+            {
+                if (i)
+                {
+                    *At++ = ',';
+                }
+                *At++ = '$';
+                At = Hex(At, Image[Address++], 2);
+            }
+        }
+        *At++ = '\n';
+        Out.append(Line, At - Line);
+    }
+    return Out;
+}
+
+void m6502::CodeMap::WriteGraph(std::ostream& Output) const
+{
+    static const char* const EDGE_STYLES[] = { "solid", "bold", "dashed", "dotted" };
+    char Text[96];
+    Output << "digraph code {\n  node [shape=box fontname=monospace];\n";
+    for (const Block& Blk : Blocks)
+    {
+        snprintf(Text, sizeof(Text), "  b%04X [label=\"$%04X-$%04X\\n%u instructions%s%s\"%s];\n", Blk.Start, Blk.Start,
+                 Blk.Start + Blk.Size - 1, Blk.Instructions, Blk.EndsIllegal ? "\\nillegal" : "",
+                 Blk.Unresolved ? "\\nunresolved" : "", IsSubroutine(Blk.Start) ? " peripheries=2" : "");
+        Output << Text;
+        for (const Edge& Succ : Blk.Successors)
+        {
+            snprintf(Text, sizeof(Text), "  b%04X -> b%04X [style=%s];\n", Blk.Start, Succ.Target,
+                     EDGE_STYLES[(u32)Succ.Type]);
+            Output << Text;
+        }
+    }
+    Output << "}\n";
+}
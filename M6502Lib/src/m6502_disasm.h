@@ -0,0 +1,150 @@
+/*
+ * Static code map and disassembly of whole images
+ *
+ * Analyse() follows control flow through an image by recursive descent
+ * from its entry points (typically the NMI, reset and IRQ vectors): JMP
+ * and JSR targets are traced, JMP (abs) through the pointer as the image
+ * holds it, and the bytes after a JSR are taken as its return point. Each
+ * byte ends up as an opcode, an operand or data (never reached), and the
+ * code is cut into basic blocks with the edges between them.
+ *  - A block starts at an entry, a jump or call target, or a return point
+ *    and ends at a jump, RTS, JSR, an illegal opcode, or where another
+ *    block starts
+ *  - Targets outside the analysed region get an edge but are not traced,
+ *    so a ROM does not run off into unmapped space
+ *  - A target inside an instruction already found (code that overlaps
+ *    itself) is counted in Overlaps and not traced
+ *  - JMP (abs) targets are marked Indirect, the pointer may be patched at
+ *    run time. JMP (abs,X) cannot be followed and marks its block
+ *    Unresolved
+ *
+ * Decoding goes through the OpcodeInfo tables, one lookup per instruction,
+ * so the recompiler and anything else pre-decoding code can build on the
+ * map. Listing() is the disassembly with labels and .byte rows for data.
+ */
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "m6502.h"
+#include "m6502_opcodes.h"
+
+namespace m6502
+{
+    struct CodeMap;
+}
+
+struct m6502::CodeMap
+{
+    enum class ByteType : Byte
+    {
+        Data,
+        Opcode,
+        Operand,
+    };
+
+    enum class EdgeType : Byte
+    {
+        FallThrough,    // Into the next block, or back from a JSR
+        Jump,
+        Call,
+        Indirect,       // Through a JMP (abs) pointer, as the image holds it
+    };
+
+    struct Edge
+    {
+        Word Target;
+        EdgeType Type;
+    };
+
+    struct Block
+    {
+        Word Start;
+        u32 Size = 0;               // In bytes
+        u32 Instructions = 0;
+        std::vector<Edge> Successors;
+        bool EndsIllegal = false;   // Runs into an illegal opcode, off the region or into another instruction
+        bool EndsExcluded = false;  // Stops before an instruction with Excluded bytes
+        bool Unresolved = false;    // Ends in a JMP (abs,X)
+    };
+
+    static constexpr Word NMI_VECTOR = 0xFFFA;
+    static constexpr Word RESET_VECTOR = 0xFFFC;
+    static constexpr Word IRQ_VECTOR = 0xFFFE;
+
+    CPUVariant Variant = CPUVariant::NMOS6502;
+    u32 RegionStart = 0;
+    u32 RegionEnd = Mem::MAX_MEM;
+    ByteType Types[Mem::MAX_MEM];
+    std::vector<Block> Blocks;          // By start address
+    std::vector<Word> Subroutines;      // JSR targets, by address
+    u32 Overlaps = 0;
+
+    /*
+     * Limits for a consumer that compiles the blocks, set before Analyse
+     *  - MaxBlockInstructions splits longer blocks, the rest starts a new
+     *    block behind a FallThrough edge (0 for no limit)
+     *  - Excluded is empty or holds a flag per address for bytes that must
+     *    not be compiled, e.g. code a store may patch. Tracing stops at an
+     *    excluded opcode. An instruction with an excluded operand is code,
+     *    but its targets are not followed and it is in no block: the block
+     *    before it has EndsExcluded and a new one starts after it
+     */
+    u32 MaxBlockInstructions = 0;
+    std::vector<bool> Excluded;
+
+    /*
+     * Map the code of Image (all MAX_MEM bytes, e.g. Mem::Data) reachable from Entries
+     *  - Only [RegionStart, RegionEnd) is traced and classified
+     *  - The region is clamped to MAX_MEM, an empty or inverted one maps nothing
+     */
+    void Analyse(const Byte* Image, const std::vector<Word>& Entries, CPUVariant Variant = CPUVariant::NMOS6502,
+                 u32 RegionStart = 0, u32 RegionEnd = Mem::MAX_MEM);
+
+    // The NMI, reset and IRQ vectors of Image
+    static std::vector<Word> VectorEntries(const Byte* Image);
+
+    // @return the block holding Address, nullptr when it is not code
+    const Block* FindBlock(Word Address) const;
+
+    bool IsSubroutine(Word Address) const;
+
+    // Disassembly of the region, a label before every block and data as .byte rows
+    std::string Listing(const Byte* Image) const;
+
+    // The block graph in Graphviz dot
+    void WriteGraph(std::ostream& Output) const;
+
+private:
+    u64 Leaders[Mem::MAX_MEM / 64];
+
+    bool InRegion(u32 Address) const
+    {
+        return Address >= RegionStart && Address < RegionEnd;
+    }
+
+    bool IsLeader(u32 Address) const
+    {
+        return (Leaders[Address >> 6] >> (Address & 63)) & 1;
+    }
+
+    bool IsExcluded(u32 Address, u32 Length) const
+    {
+        for (u32 i = 0; i < Length && !Excluded.empty(); i++)
+        {
+            if (Excluded[Address + i])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // @return the instruction at Address, nullptr if it is illegal or runs off the region
+    const OpcodeInfo* DecodeAt(const Byte* Image, u32 Address) const;
+
+    void Trace(const Byte* Image, std::vector<Word>& Work);
+    void BuildBlocks(const Byte* Image);
+    Block BuildBlock(const Byte* Image, u32 Start);
+};
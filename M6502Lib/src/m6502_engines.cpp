@@ -0,0 +1,156 @@
+#include "m6502_engines.h"
+
+namespace
+{
+    using namespace m6502;
+
+    template <CPUVariant Variant>
+    s32 RunFused(CPU& cpu, Mem& memory, s32 Cycles)
+    {
+        return cpu.ExecuteFused<Variant>(Cycles, memory);
+    }
+
+    template <CPUVariant Variant>
+    s32 RunExact(CPU& cpu, Mem& memory, s32 Cycles)
+    {
+        return cpu.Execute<Variant>(Cycles, memory);
+    }
+
+    // Ends early after an instruction that jams or stops, as Execute does
+    template <CPUVariant Variant, bool StopAtPC>
+    s32 Ticks(CPU& cpu, Mem& memory, s32 Cycles, Word StopPC)
+    {
+        for (s32 Tick = 0; Tick < Cycles; Tick++)
+        {
+            const bool Starts = cpu.AtInstructionBoundary();
+            if (StopAtPC && Starts && cpu.PC == StopPC && !cpu.Jammed)
+            {
+                cpu.Stopped = CPU::StopReason::ReachedPC;
+                return Tick;
+            }
+            cpu.Tick<Variant>(memory);
+            if (cpu.AtInstructionBoundary() && (cpu.Jammed || cpu.Stopped != CPU::StopReason::None))
+            {
+                return Tick + 1;
+            }
+        }
+        return Cycles;
+    }
+
+    template <CPUVariant Variant>
+    s32 RunTicks(CPU& cpu, Mem& memory, s32 Cycles)
+    {
+        return Ticks<Variant, false>(cpu, memory, Cycles, 0);
+    }
+
+    template <CPUVariant Variant>
+    s32 RunFusedTo(CPU& cpu, Mem& memory, s32 Cycles, Word StopPC)
+    {
+        return cpu.ExecuteFusedTo<Variant>(StopPC, Cycles, memory);
+    }
+
+    template <CPUVariant Variant>
+    s32 RunExactTo(CPU& cpu, Mem& memory, s32 Cycles, Word StopPC)
+    {
+        return cpu.ExecuteTo<Variant>(StopPC, Cycles, memory);
+    }
+
+    template <CPUVariant Variant>
+    s32 RunTicksTo(CPU& cpu, Mem& memory, s32 Cycles, Word StopPC)
+    {
+        return Ticks<Variant, true>(cpu, memory, Cycles, StopPC);
+    }
+
+    template <CPUVariant Variant>
+    void SetEngines(EngineSwitch::EngineFn* Engines, EngineSwitch::StoppingEngineFn* StoppingEngines)
+    {
+        Engines[(u32)Engine::Fast] = RunFused<Variant>;
+        Engines[(u32)Engine::Exact] = RunExact<Variant>;
+        Engines[(u32)Engine::Ticked] = RunTicks<Variant>;
+        StoppingEngines[(u32)Engine::Fast] = RunFusedTo<Variant>;
+        StoppingEngines[(u32)Engine::Exact] = RunExactTo<Variant>;
+        StoppingEngines[(u32)Engine::Ticked] = RunTicksTo<Variant>;
+    }
+}
+
+m6502::EngineSwitch::EngineSwitch(const CPU& cpu, Mem& memory, Engine Start, CPUVariant Variant)
+    : Cpu(cpu), Memory(&memory), Current(Start)
+{
+    switch (Variant)
+    {
+        case CPUVariant::NMOS6502: SetEngines<CPUVariant::NMOS6502>(Engines, StoppingEngines); break;
+        case CPUVariant::CMOS65C02: SetEngines<CPUVariant::CMOS65C02>(Engines, StoppingEngines); break;
+        case CPUVariant::RP2A03: SetEngines<CPUVariant::RP2A03>(Engines, StoppingEngines); break;
+    }
+}
+
+void m6502::EngineSwitch::SwitchAtPC(Engine To, Word PC)
+{
+    AtPC = { true, To };
+    SwitchPC = PC;
+}
+
+void m6502::EngineSwitch::SwitchAtCycle(Engine To, u64 Cycle)
+{
+    AtCycle = { true, To };
+    SwitchCycle = Cycle;
+}
+
+void m6502::EngineSwitch::Hand(Engine To)
+{
+    Cpu.IdleLoop.Armed = false;
+    Cpu.Stopped = CPU::StopReason::None;
+    Current = To;
+    Switches++;
+    LastSwitchCycle = Cycles;
+}
+
+m6502::s32 m6502::EngineSwitch::RunEngine(s32 Budget)
+{
+    if (AtPC.Pending)
+    {
+        return StoppingEngines[(u32)Current](Cpu, *Memory, Budget, SwitchPC);
+    }
+    return Engines[(u32)Current](Cpu, *Memory, Budget);
+}
+
+m6502::s32 m6502::EngineSwitch::Run(s32 Budget)
+{
+    s32 Used = 0;
+    while (Used < Budget && !Cpu.Jammed)
+    {
+        const bool PCDue = AtPC.Pending && Cpu.PC == SwitchPC;
+        const bool CycleDue = AtCycle.Pending && Cycles >= SwitchCycle;
+        if (PCDue || CycleDue)
+        {
+            // Only the ticked engine stops halfway, tick out the rest of the instruction (may overrun)
+            const EngineFn Ticks = Engines[(u32)Engine::Ticked];
+            while (!Cpu.AtInstructionBoundary())
+            {
+                const s32 Paid = Input ? Input->Run(Cpu, *Memory, 1, Ticks) : Ticks(Cpu, *Memory, 1);
+                Used += Paid;
+                Cycles += Paid;
+            }
+            Request& Taken = PCDue ? AtPC : AtCycle;
+            Taken.Pending = false;
+            Hand(Taken.To);
+            continue;
+        }
+
+        s32 Piece = Budget - Used;
+        if (AtCycle.Pending && SwitchCycle - Cycles < (u64)Piece)
+        {
+            Piece = (s32)(SwitchCycle - Cycles);
+        }
+        const s32 Ran = Input ? Input->Run(Cpu, *Memory, Piece, [this](CPU&, Mem&, s32 Cycles) { return RunEngine(Cycles); })
+                              : RunEngine(Piece);
+        Used += Ran;
+        Cycles += Ran;
+        // Reaching the switch PC ends a piece early, the loop takes the switch
+        if (Ran < Piece && Cpu.Stopped != CPU::StopReason::ReachedPC)
+        {
+            break;
+        }
+    }
+    return Used;
+}
@@ -0,0 +1,111 @@
+/*
+ * Switching a running machine between execution engines
+ *
+ * A machine can boot through the fast engine and be measured on the exact
+ * or the ticked one. The engines share all their state through the
+ * CPU, so a switch only settles what one engine leaves behind that
+ * another would not expect, at an instruction boundary:
+ *  - Fast: ExecuteFused, or any drop in for CPU::Execute set as FastEngine
+ *    (e.g. a function from M6502Recomp)
+ *  - Exact: CPU::Execute
+ *  - Ticked: CPU::Tick, one call per cycle, each running one micro-op of
+ *    the instruction (see CPU::Tick). Switching away from it halfway
+ *    through an instruction first ticks it out to its boundary,
+ *    overrunning the budget if need be as Execute's last instruction
+ *    does, so the cycle count comes out as if one engine had run
+ *    throughout
+ *  - The idle loop snapshot is dropped and the stop state cleared, queued
+ *    input (Input) carries on being applied by the new engine
+ *
+ * Switches are requested at a PC, at a cycle (both take effect at the
+ * first instruction boundary reaching them) or at once. A PC is caught
+ * without touching memory: while a switch at a PC is pending each engine
+ * runs its stopping form (ExecuteFusedTo, ExecuteTo, or a PC compare
+ * between ticks), which costs one compare per instruction until the
+ * switch is taken. A FastEngine set by SetFastEngine cannot be stopped at
+ * a PC, ExecuteFusedTo stands in for it until then.
+ */
+#pragma once
+
+#include "m6502.h"
+#include "m6502_input.h"
+
+namespace m6502
+{
+    enum class Engine : Byte
+    {
+        Fast,
+        Exact,
+        Ticked,
+    };
+
+    struct EngineSwitch;
+}
+
+struct m6502::EngineSwitch
+{
+    static constexpr u32 NUM_ENGINES = 3;
+
+    // Runs up to Cycles (the last instruction may overrun) and @return the cycles used, as CPU::Execute
+    using EngineFn = s32 (*)(CPU& cpu, Mem& memory, s32 Cycles);
+    // The same, stopping before the instruction at StopPC with StopReason::ReachedPC
+    using StoppingEngineFn = s32 (*)(CPU& cpu, Mem& memory, s32 Cycles, Word StopPC);
+
+    CPU Cpu;
+    Mem* Memory;
+    Engine Current;
+    EngineFn Engines[NUM_ENGINES];
+    StoppingEngineFn StoppingEngines[NUM_ENGINES];
+    InputQueue* Input = nullptr;
+
+    u64 Cycles = 0;             // Used since construction
+    u64 Switches = 0;
+    u64 LastSwitchCycle = 0;
+
+    EngineSwitch(const CPU& cpu, Mem& memory, Engine Start = Engine::Fast,
+                 CPUVariant Variant = CPUVariant::NMOS6502);
+
+    EngineSwitch(const EngineSwitch&) = delete;
+    EngineSwitch& operator=(const EngineSwitch&) = delete;
+
+    // e.g. a recompiled function, which runs the same code as Execute
+    void SetFastEngine(EngineFn Fn)
+    {
+        Engines[(u32)Engine::Fast] = Fn;
+    }
+
+    // Replace the pending switch at a PC, taken once
+    void SwitchAtPC(Engine To, Word PC);
+
+    // Replace the pending switch at a cycle (of Cycles), taken once
+    void SwitchAtCycle(Engine To, u64 Cycle);
+
+    // Switch before the next instruction, by the next Run() if halfway through one
+    void SwitchNow(Engine To)
+    {
+        SwitchAtCycle(To, Cycles);
+    }
+
+    /*
+     * Run Cycles on the current engine, switching engines on the way
+     *  - Ends early when the CPU jams or stops, as Execute
+     *  - Illegal opcodes throw out of here if the CPU is set to throw
+     */
+    s32 Run(s32 Cycles);
+
+private:
+    struct Request
+    {
+        bool Pending = false;
+        Engine To;
+    };
+
+    Request AtPC, AtCycle;
+    Word SwitchPC = 0;
+    u64 SwitchCycle = 0;
+
+    // One piece on the current engine, stopping at SwitchPC while that switch is pending
+    s32 RunEngine(s32 Cycles);
+
+    void Hand(Engine To);
+};
@@ -0,0 +1,6 @@
+#include "m6502_input.h"
+
+m6502::s32 m6502::InputQueue::Execute(CPU& cpu, Mem& memory, s32 Cycles, std::vector<Event>* Log)
+{
+    return Run(cpu, memory, Cycles, [](CPU& Cpu, Mem& Memory, s32 Budget) { return Cpu.Execute(Budget, Memory); }, Log);
+}
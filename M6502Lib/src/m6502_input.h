@@ -0,0 +1,147 @@
+/*
+ * Input from host threads, queued for a running machine
+ *
+ * A lock-free single producer, single consumer ring of events stamped with
+ * the emulated cycle they take effect on. One host thread (keyboard,
+ * serial line) pushes, the thread running the machine executes through
+ * the queue, which splits the slice at the next event's cycle and applies
+ * it there. The queue is only looked at between those pieces, never per
+ * instruction.
+ *  - An event is applied at the first instruction boundary at or after its
+ *    cycle. Given the same stamped events a machine always ends up in the
+ *    same state, which is what makes replays deterministic
+ *  - An event pushed after its cycle has gone by is applied at the start
+ *    of the next slice, so input lags by at most one slice. Pass a Log to
+ *    Execute to record when events were really applied, for replays
+ *  - Stamps must not go backwards, an event stamped before the one ahead
+ *    of it is applied together with it
+ *  - Applying an event stores Value at Address in the mapped read window,
+ *    as a host write through Mem::Load (a keyboard latch, a status port)
+ */
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct InputQueue;
+}
+
+struct m6502::InputQueue
+{
+    static constexpr u32 CAPACITY = 1024;   // A power of two
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0);
+
+    struct Event
+    {
+        u64 Cycle;      // Emulated cycle, counted by the queue from 0
+        Word Address;
+        Byte Value;
+    };
+
+    // Producer thread only, @return false when the queue is full
+    bool Push(const Event& In)
+    {
+        const u32 Next = Tail.load(std::memory_order_relaxed);
+        if (Next - CachedHead == CAPACITY)
+        {
+            CachedHead = Head.load(std::memory_order_acquire);
+            if (Next - CachedHead == CAPACITY)
+            {
+                return false;
+            }
+        }
+        Ring[Next & (CAPACITY - 1)] = In;
+        Tail.store(Next + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Emulated cycles executed through the queue, readable by the producer
+     * to stamp an event "now" (it lands at the start of the next slice)
+     */
+    u64 CurrentCycle() const
+    {
+        return Now.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * Consumer thread only, runs in place of CPU::Execute
+     *  - Applies every event due, then executes up to the next event's
+     *    cycle, until the budget is used
+     *  - @return the cycles used, like Execute
+     */
+    s32 Execute(CPU& cpu, Mem& memory, s32 Cycles, std::vector<Event>* Log = nullptr);
+
+    /*
+     * Execute with another engine, any s32(CPU&, Mem&, s32 Cycles) that
+     * counts like CPU::Execute (see EngineSwitch)
+     */
+    template <typename EngineFn>
+    s32 Run(CPU& cpu, Mem& memory, s32 Cycles, EngineFn&& Engine, std::vector<Event>* Log = nullptr)
+    {
+        u64 Cycle = Now.load(std::memory_order_relaxed);
+        s32 Used = 0;
+        while (Used < Cycles && !cpu.Jammed)
+        {
+            const Event* Due = Front();
+            while (Due && Due->Cycle <= Cycle)
+            {
+                memory.Load(Due->Address, &Due->Value, 1);
+                if (Log)
+                {
+                    Log->push_back({ Cycle, Due->Address, Due->Value });
+                }
+                Pop();
+                Due = Front();
+            }
+
+            s32 Piece = Cycles - Used;
+            if (Due && Due->Cycle - Cycle < (u64)Piece)
+            {
+                Piece = (s32)(Due->Cycle - Cycle);
+            }
+            const s32 Ran = Engine(cpu, memory, Piece);
+            Used += Ran;
+            Cycle += Ran;
+            // A stop (a mapper write, a return) ends the slice early, as it would with Execute
+            if (Ran < Piece)
+            {
+                break;
+            }
+        }
+        Now.store(Cycle, std::memory_order_relaxed);
+        return Used;
+    }
+
+private:
+    // Consumer thread only
+    const Event* Front()
+    {
+        const u32 Next = Head.load(std::memory_order_relaxed);
+        if (Next == CachedTail)
+        {
+            CachedTail = Tail.load(std::memory_order_acquire);
+            if (Next == CachedTail)
+            {
+                return nullptr;
+            }
+        }
+        return &Ring[Next & (CAPACITY - 1)];
+    }
+
+    void Pop()
+    {
+        Head.store(Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Each side's index and its cached copy of the other's on their own cache line
+    alignas(64) std::atomic<u32> Head{ 0 };
+    u32 CachedTail = 0;
+    std::atomic<u64> Now{ 0 };
+    alignas(64) std::atomic<u32> Tail{ 0 };
+    u32 CachedHead = 0;
+    alignas(64) Event Ring[CAPACITY];
+};
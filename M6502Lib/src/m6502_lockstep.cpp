@@ -0,0 +1,228 @@
+#include "m6502_lockstep.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    using namespace m6502;
+
+    /*
+     * Barrier for quanta of microseconds, where sleeping in the kernel
+     * would cost more than the quantum. Spins, then yields so that more
+     * CPUs than cores still make progress. The last thread to arrive runs
+     * Completion before anyone is let through.
+     */
+    struct SpinBarrier
+    {
+        static constexpr u32 DEFAULT_SPINS = 4096;
+
+        const u32 Count;
+        const u32 SpinsBeforeYield;
+        std::atomic<u32> Arrived{ 0 };
+        std::atomic<u32> Generation{ 0 };
+
+        SpinBarrier(u32 Count, u32 SpinsBeforeYield) : Count(Count), SpinsBeforeYield(SpinsBeforeYield)
+        {
+        }
+
+        template <typename Fn>
+        void ArriveAndWait(Fn Completion)
+        {
+            const u32 Current = Generation.load(std::memory_order_acquire);
+            if (Arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == Count)
+            {
+                Completion();
+                Arrived.store(0, std::memory_order_relaxed);
+                Generation.store(Current + 1, std::memory_order_release);
+                return;
+            }
+            u32 Spins = 0;
+            while (Generation.load(std::memory_order_acquire) == Current)
+            {
+                if (++Spins < SpinsBeforeYield)
+                {
+#if defined(__x86_64__) || defined(__i386__)
+                    __builtin_ia32_pause();
+#endif
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    };
+
+    void ClearDirtyBits(Mem& memory)
+    {
+        for (u64& Bits : memory.DirtyPages)
+        {
+            Bits = 0;
+        }
+    }
+}
+
+void m6502::LockstepSystem::StoreLog::Write(Mem& memory, Word Address, Byte Value)
+{
+    memory.StoreData(Address, Value);
+    memory.MarkDirty(Address);
+    Stored[Address >> 6] |= 1ull << (Address & 63);
+}
+
+m6502::LockstepSystem::LockstepSystem(Mem& Shared, s32 Quantum)
+    : Shared(Shared), Quantum(Quantum)
+{
+}
+
+m6502::u32 m6502::LockstepSystem::Add(const CPU& cpu)
+{
+    Cpus.push_back(cpu);
+    Cpus.back().ThrowOnIllegalOpcode = false;
+    Cpus.back().StopOnMapperWrite = false;
+    Copies.push_back(std::make_unique<Mem>());
+    Logs.push_back(std::make_unique<StoreLog>());
+    Carry.push_back(0);
+    Writes.emplace_back();
+    return (u32)Cpus.size() - 1;
+}
+
+void m6502::LockstepSystem::Sync()
+{
+    for (u32 Index = 0; Index < NumCpus(); Index++)
+    {
+        Mem& Copy = *Copies[Index];
+        Copy = Shared;
+        ClearDirtyBits(Copy);
+        // Reads stay a window lookup, every write goes to the log
+        Copy.MapRange(0, Mem::MAX_MEM, Copy.Data, nullptr);
+        Copy.AttachedMapper = Logs[Index].get();
+        *Logs[Index] = StoreLog();
+    }
+    for (u64& Bits : Merged)
+    {
+        Bits = 0;
+    }
+}
+
+void m6502::LockstepSystem::RunQuantum(u32 Index)
+{
+    // Straight into Data, the copies' hash (M6502_STATE_HASH) is not kept
+    Mem& Copy = *Copies[Index];
+    for (u32 Word64 = 0; Word64 < MemDiff::BITMAP_WORDS; Word64++)
+    {
+        for (u64 Bits = Merged[Word64]; Bits; Bits &= Bits - 1)
+        {
+            const u32 Offset = (Word64 * 64 + __builtin_ctzll(Bits)) * Mem::PAGE_SIZE;
+            memcpy(Copy.Data + Offset, Shared.Data + Offset, Mem::PAGE_SIZE);
+        }
+    }
+    ClearDirtyBits(Copy);
+
+    CPU& cpu = Cpus[Index];
+    const s32 Budget = Quantum + Carry[Index];
+    const s32 Used = cpu.Execute(Budget, Copy);
+    // A jammed CPU stops for good, there is nothing to carry
+    Carry[Index] = cpu.Jammed ? 0 : Budget - Used;
+
+    // Only dirty pages can have logged stores, turn their bits into runs and clear them
+    StoreLog& Log = *Logs[Index];
+    std::vector<MemDiff::Range>& Ranges = Writes[Index];
+    Ranges.clear();
+    for (u32 Word64 = 0; Word64 < MemDiff::BITMAP_WORDS; Word64++)
+    {
+        for (u64 Pages = Copy.DirtyPages[Word64]; Pages; Pages &= Pages - 1)
+        {
+            const u32 First = (Word64 * 64 + __builtin_ctzll(Pages)) * (Mem::PAGE_SIZE / 64);
+            for (u32 i = First; i < First + Mem::PAGE_SIZE / 64; i++)
+            {
+                u64 Bits = Log.Stored[i];
+                Log.Stored[i] = 0;
+                while (Bits)
+                {
+                    const u32 Bit = __builtin_ctzll(Bits);
+                    const u64 Run = ~(Bits >> Bit);
+                    const u32 Length = Run ? __builtin_ctzll(Run) : 64 - Bit;
+                    const u32 Start = i * 64 + Bit;
+                    if (!Ranges.empty() && Ranges.back().Start + Ranges.back().Length == Start)
+                    {
+                        Ranges.back().Length += Length;
+                    }
+                    else
+                    {
+                        Ranges.push_back({ (Word)Start, Length });
+                    }
+                    Bits = Length + Bit < 64 ? Bits & (~0ull << (Bit + Length)) : 0;
+                }
+            }
+        }
+    }
+}
+
+void m6502::LockstepSystem::Merge()
+{
+    for (u64& Bits : Merged)
+    {
+        Bits = 0;
+    }
+    for (u32 Index = 0; Index < NumCpus(); Index++)
+    {
+        const Mem& Copy = *Copies[Index];
+        for (const MemDiff::Range& Write : Writes[Index])
+        {
+            Shared.Load(Write.Start, Copy.Data + Write.Start, Write.Length);
+            const u32 End = Write.Start + Write.Length;
+            for (u32 Page = Write.Start / Mem::PAGE_SIZE; Page * Mem::PAGE_SIZE < End; Page++)
+            {
+                Merged[Page >> 6] |= 1ull << (Page & 63);
+            }
+        }
+    }
+    QuantaRun++;
+}
+
+void m6502::LockstepSystem::RunSerial(u32 Quanta)
+{
+    Sync();
+    for (u32 Quantum = 0; Quantum < Quanta; Quantum++)
+    {
+        for (u32 Index = 0; Index < NumCpus(); Index++)
+        {
+            RunQuantum(Index);
+        }
+        Merge();
+    }
+}
+
+void m6502::LockstepSystem::Run(u32 Quanta)
+{
+    if (NumCpus() == 0)
+    {
+        return;
+    }
+    Sync();
+
+    // With fewer cores than CPUs a spinning thread only delays the one it waits for
+    const bool Oversubscribed = std::thread::hardware_concurrency() < NumCpus();
+    SpinBarrier Barrier(NumCpus(), Oversubscribed ? 0 : SpinBarrier::DEFAULT_SPINS);
+    auto Worker = [this, &Barrier, Quanta](u32 Index)
+    {
+        for (u32 Quantum = 0; Quantum < Quanta; Quantum++)
+        {
+            RunQuantum(Index);
+            Barrier.ArriveAndWait([this] { Merge(); });
+        }
+    };
+
+    std::vector<std::thread> Threads;
+    for (u32 Index = 1; Index < NumCpus(); Index++)
+    {
+        Threads.emplace_back(Worker, Index);
+    }
+    Worker(0);
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+}
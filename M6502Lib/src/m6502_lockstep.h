@@ -0,0 +1,96 @@
+/*
+ * Several CPUs on one shared RAM, run in quantum lockstep
+ *
+ * Every CPU runs Quantum cycles against a private copy of the shared RAM,
+ * then all of them meet at a barrier where their writes are merged into
+ * the shared image in CPU order, so on conflicting writes the highest
+ * numbered CPU wins. A CPU sees the other CPUs' writes from the next
+ * quantum on.
+ *
+ * This is not the same as calling CPU::Execute(Quantum, Shared) for each
+ * CPU in turn, where a CPU would already see the writes of the CPUs run
+ * before it in the same quantum. Every CPU here starts a quantum from the
+ * same shared image, which is what lets the quanta run in parallel.
+ *
+ * The copies stay in sync cheaply: every store a CPU makes to its copy
+ * goes through a StoreLog mapper that marks the byte in a bitmap, at the
+ * barrier only the logged bytes of its dirty pages are merged, and at the
+ * start of a quantum only the pages written in the last merge are copied
+ * back in. A store counts as a write even if it leaves the value as it
+ * was, so a higher CPU storing the value already there still wins.
+ *
+ * Run() gives each CPU a thread (the caller's thread runs CPU 0) and meets
+ * at a spinning barrier, so quanta of a few hundred cycles stay cheap when
+ * there is a core per CPU. RunSerial() does the same steps on the calling
+ * thread, the results are bit-identical.
+ *
+ * The shared Mem must be plain RAM (no windows remapped, no mapper). The
+ * CPUs are set to jam on illegal opcodes, a throw on a worker thread
+ * could not be caught.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "m6502.h"
+#include "m6502_memdiff.h"
+
+namespace m6502
+{
+    struct LockstepSystem;
+}
+
+struct m6502::LockstepSystem
+{
+    static constexpr s32 DEFAULT_QUANTUM = 1000;
+
+    // Attached to a CPU's copy, takes every write to it and logs the address
+    struct StoreLog : Mapper
+    {
+        u64 Stored[Mem::MAX_MEM / 64] = {};
+
+        void Write(Mem& memory, Word Address, Byte Value) override;
+    };
+
+    Mem& Shared;
+    s32 Quantum;
+
+    std::vector<CPU> Cpus;
+    std::vector<std::unique_ptr<Mem>> Copies;
+    std::vector<std::unique_ptr<StoreLog>> Logs;
+    // Cycles a CPU overran its last quantum by (negative) or has left over
+    std::vector<s32> Carry;
+    std::vector<std::vector<MemDiff::Range>> Writes;
+    // Pages the last merge wrote, to be copied into every CPU's copy
+    u64 Merged[MemDiff::BITMAP_WORDS] = {};
+    u64 QuantaRun = 0;
+
+    explicit LockstepSystem(Mem& Shared, s32 Quantum = DEFAULT_QUANTUM);
+
+    LockstepSystem(const LockstepSystem&) = delete;
+    LockstepSystem& operator=(const LockstepSystem&) = delete;
+
+    // @return the CPU's index (its place in the write order), its state is copied in
+    u32 Add(const CPU& cpu);
+
+    u32 NumCpus() const
+    {
+        return (u32)Cpus.size();
+    }
+
+    // Run Quanta quanta with a thread per CPU
+    void Run(u32 Quanta);
+
+    // Run Quanta quanta on the calling thread, with the same results as Run()
+    void RunSerial(u32 Quanta);
+
+private:
+    // Bring the copies up to date with the shared RAM, before a Run
+    void Sync();
+
+    // One CPU's quantum: catch up on the last merge, execute, collect its logged stores
+    void RunQuantum(u32 Index);
+
+    // Apply every CPU's writes in CPU order, at the barrier
+    void Merge();
+};
@@ -0,0 +1,82 @@
+#include "m6502_mapper.h"
+#include <stdexcept>
+
+/*
+ * UxROM
+ */
+
+m6502::UxRomMapper::UxRomMapper(std::vector<Byte> RomImage)
+    : Rom(std::move(RomImage))
+{
+    Rom.resize((Rom.size() + BANK_SIZE - 1) / BANK_SIZE * BANK_SIZE);
+    if (Rom.empty())
+    {
+        Rom.resize(BANK_SIZE);
+    }
+    NumBanks = Rom.size() / BANK_SIZE;
+}
+
+void m6502::UxRomMapper::Attach(Mem& memory)
+{
+    memory.AttachedMapper = this;
+    memory.MapRange(FIXED_START, BANK_SIZE, &Rom[(NumBanks - 1) * BANK_SIZE], nullptr);
+    SelectBank(memory, 0);
+}
+
+void m6502::UxRomMapper::SelectBank(Mem& memory, u32 NewBank)
+{
+    Bank = NewBank % NumBanks;
+    memory.MapRange(SWITCHABLE_START, BANK_SIZE, &Rom[Bank * BANK_SIZE], nullptr);
+}
+
+void m6502::UxRomMapper::Write(Mem& memory, Word Address, Byte Value)
+{
+    if (Address >= SWITCHABLE_START)
+    {
+        SelectBank(memory, Value);
+    }
+}
+
+/*
+ * Banked RAM
+ */
+
+m6502::RamBankMapper::RamBankMapper(u32 NumBanks, Word BankRegister)
+    : NumBanks(NumBanks), BankRegister(BankRegister)
+{
+    if (NumBanks == 0 || NumBanks > MAX_BANKS)
+    {
+        throw std::invalid_argument("RamBankMapper needs 1 to 256 banks");
+    }
+    if (BankRegister >= WINDOW_START && BankRegister < WINDOW_START + BANK_SIZE)
+    {
+        throw std::invalid_argument("RamBankMapper bank register is inside the bank window");
+    }
+    Ram.resize(NumBanks * BANK_SIZE);
+}
+
+void m6502::RamBankMapper::Attach(Mem& memory)
+{
+    memory.AttachedMapper = this;
+    // The register's window still reads from Data, only its writes are trapped
+    const u32 RegisterWindow = BankRegister >> Mem::WINDOW_SHIFT;
+    memory.MapWindow(RegisterWindow, memory.Data + RegisterWindow * Mem::WINDOW_SIZE, nullptr);
+    SelectBank(memory, 0);
+}
+
+void m6502::RamBankMapper::SelectBank(Mem& memory, u32 NewBank)
+{
+    Bank = NewBank % NumBanks;
+    Byte* Window = &Ram[Bank * BANK_SIZE];
+    memory.MapRange(WINDOW_START, BANK_SIZE, Window, Window);
+}
+
+void m6502::RamBankMapper::Write(Mem& memory, Word Address, Byte Value)
+{
+    memory.StoreData(Address, Value);
+    memory.MarkDirty(Address);
+    if (Address == BankRegister)
+    {
+        SelectBank(memory, Value);
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Bank switching mappers
+ *
+ * Each mapper owns a backing store larger than 64 KiB and switches banks by
+ * repointing Mem windows into it (O(1), no copying). The CPU's reads stay a
+ * single table lookup, only writes to windows without a write target reach
+ * the mapper.
+ */
+#pragma once
+
+#include <vector>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct UxRomMapper;
+    struct RamBankMapper;
+}
+
+/*
+ * NES UxROM style cartridge
+ *  - 16 KiB switchable ROM bank at $8000-$BFFF
+ *  - Last bank fixed at $C000-$FFFF (holds the vectors)
+ *  - Any write to $8000-$FFFF selects the switchable bank
+ */
+struct m6502::UxRomMapper : m6502::Mapper
+{
+    static constexpr u32 BANK_SIZE = 16 * 1024;
+    static constexpr Word SWITCHABLE_START = 0x8000;
+    static constexpr Word FIXED_START = 0xC000;
+
+    std::vector<Byte> Rom;
+    u32 NumBanks;
+    u32 Bank = 0;
+
+    // @Rom Whole ROM image, padded to a multiple of 16 KiB (an empty image
+    // becomes one blank bank, so there is always a fixed bank to map)
+    explicit UxRomMapper(std::vector<Byte> RomImage);
+
+    // Map the ROM into the top half of memory and take over its writes
+    void Attach(Mem& memory);
+
+    void SelectBank(Mem& memory, u32 NewBank);
+
+    void Write(Mem& memory, Word Address, Byte Value) override;
+};
+
+/*
+ * Banked RAM behind an 8 KiB window, as on the Commander X16
+ *  - 8 KiB RAM window at $A000-$BFFF onto up to 256 banks (2 MiB)
+ *  - A bank select register somewhere outside the window (default $9F61),
+ *    the rest of the 4 KiB window holding the register stays plain RAM
+ */
+struct m6502::RamBankMapper : m6502::Mapper
+{
+    static constexpr u32 BANK_SIZE = 8 * 1024;
+    static constexpr Word WINDOW_START = 0xA000;
+    static constexpr u32 MAX_BANKS = 256;
+
+    std::vector<Byte> Ram;
+    u32 NumBanks;
+    Word BankRegister;
+    u32 Bank = 0;
+
+    // Throws std::invalid_argument for 0 or more than 256 banks, or a bank
+    // register inside the window
+    explicit RamBankMapper(u32 NumBanks, Word BankRegister = 0x9F61);
+
+    void Attach(Mem& memory);
+
+    void SelectBank(Mem& memory, u32 NewBank);
+
+    void Write(Mem& memory, Word Address, Byte Value) override;
+};
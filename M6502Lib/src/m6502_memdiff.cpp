@@ -0,0 +1,243 @@
+#include "m6502_memdiff.h"
+
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define M6502_MEMDIFF_X86
+#endif
+
+namespace
+{
+    using namespace m6502;
+
+    constexpr u32 PAGE_SIZE = Mem::PAGE_SIZE;
+
+    // The pages of one bitmap word to look at, so unselected pages cost nothing
+    u64 Selection(const u64* OnlyPages, u32 Word64)
+    {
+        return OnlyPages ? OnlyPages[Word64] : ~0ull;
+    }
+
+    /*
+     * Kernels
+     *  - PageDiffers: does any byte of the page differ
+     *  - PageMask: a bit per differing byte of the page, 4 x 64 bits
+     */
+
+    bool PageDiffersScalar(const Byte* A, const Byte* B)
+    {
+        u64 Any = 0;
+        for (u32 i = 0; i < PAGE_SIZE; i += 8)
+        {
+            u64 WordA, WordB;
+            memcpy(&WordA, A + i, 8);
+            memcpy(&WordB, B + i, 8);
+            Any |= WordA ^ WordB;
+        }
+        return Any != 0;
+    }
+
+    void PageMaskScalar(const Byte* A, const Byte* B, u64 (&Mask)[4])
+    {
+        for (u32 i = 0; i < PAGE_SIZE; i += 8)
+        {
+            u64 WordA, WordB;
+            memcpy(&WordA, A + i, 8);
+            memcpy(&WordB, B + i, 8);
+            // Most words match, only the differing ones are split into bytes
+            for (u64 Diff = WordA ^ WordB; Diff;)
+            {
+                const u32 Bit = __builtin_ctzll(Diff) & ~7u;
+                Mask[i >> 6] |= 1ull << ((i + Bit / 8) & 63);
+                Diff &= ~(0xFFull << Bit);
+            }
+        }
+    }
+
+#ifdef M6502_MEMDIFF_X86
+    bool PageDiffersSSE2(const Byte* A, const Byte* B)
+    {
+        __m128i Any = _mm_setzero_si128();
+        for (u32 i = 0; i < PAGE_SIZE; i += 16)
+        {
+            const __m128i VA = _mm_loadu_si128((const __m128i*)(A + i));
+            const __m128i VB = _mm_loadu_si128((const __m128i*)(B + i));
+            Any = _mm_or_si128(Any, _mm_xor_si128(VA, VB));
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(Any, _mm_setzero_si128())) != 0xFFFF;
+    }
+
+    void PageMaskSSE2(const Byte* A, const Byte* B, u64 (&Mask)[4])
+    {
+        for (u32 i = 0; i < PAGE_SIZE; i += 16)
+        {
+            const __m128i VA = _mm_loadu_si128((const __m128i*)(A + i));
+            const __m128i VB = _mm_loadu_si128((const __m128i*)(B + i));
+            const u32 Equal = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(VA, VB));
+            Mask[i >> 6] |= (u64)(~Equal & 0xFFFF) << (i & 63);
+        }
+    }
+
+    __attribute__((target("avx2"))) bool PageDiffersAVX2(const Byte* A, const Byte* B)
+    {
+        __m256i Any = _mm256_setzero_si256();
+        for (u32 i = 0; i < PAGE_SIZE; i += 32)
+        {
+            const __m256i VA = _mm256_loadu_si256((const __m256i*)(A + i));
+            const __m256i VB = _mm256_loadu_si256((const __m256i*)(B + i));
+            Any = _mm256_or_si256(Any, _mm256_xor_si256(VA, VB));
+        }
+        return !_mm256_testz_si256(Any, Any);
+    }
+
+    __attribute__((target("avx2"))) void PageMaskAVX2(const Byte* A, const Byte* B, u64 (&Mask)[4])
+    {
+        for (u32 i = 0; i < PAGE_SIZE; i += 32)
+        {
+            const __m256i VA = _mm256_loadu_si256((const __m256i*)(A + i));
+            const __m256i VB = _mm256_loadu_si256((const __m256i*)(B + i));
+            const u32 Equal = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(VA, VB));
+            Mask[i >> 6] |= (u64)(~Equal) << (i & 63);
+        }
+    }
+
+    // Whole image loops per kernel, so the AVX2 page check inlines into an AVX2 loop
+    __attribute__((target("avx2"))) void PagesAVX2(const Byte* A, const Byte* B, u64* Changed, const u64* OnlyPages)
+    {
+        for (u32 Word64 = 0; Word64 < MemDiff::BITMAP_WORDS; Word64++)
+        {
+            for (u64 Bits = Selection(OnlyPages, Word64); Bits; Bits &= Bits - 1)
+            {
+                const u32 Page = Word64 * 64 + __builtin_ctzll(Bits);
+                if (PageDiffersAVX2(A + Page * PAGE_SIZE, B + Page * PAGE_SIZE))
+                {
+                    Changed[Word64] |= 1ull << (Page & 63);
+                }
+            }
+        }
+    }
+#endif
+
+    template <bool (*PageDiffers)(const Byte*, const Byte*)>
+    void PagesGeneric(const Byte* A, const Byte* B, u64* Changed, const u64* OnlyPages)
+    {
+        for (u32 Word64 = 0; Word64 < MemDiff::BITMAP_WORDS; Word64++)
+        {
+            for (u64 Bits = Selection(OnlyPages, Word64); Bits; Bits &= Bits - 1)
+            {
+                const u32 Page = Word64 * 64 + __builtin_ctzll(Bits);
+                if (PageDiffers(A + Page * PAGE_SIZE, B + Page * PAGE_SIZE))
+                {
+                    Changed[Word64] |= 1ull << (Page & 63);
+                }
+            }
+        }
+    }
+
+    MemDiff::Kernel Resolve(MemDiff::Kernel Use)
+    {
+        return Use == MemDiff::Kernel::Auto ? MemDiff::Best() : Use;
+    }
+}
+
+m6502::MemDiff::Kernel m6502::MemDiff::Best()
+{
+#ifdef M6502_MEMDIFF_X86
+    static const Kernel Detected = __builtin_cpu_supports("avx2") ? Kernel::AVX2 : Kernel::SSE2;
+    return Detected;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+void m6502::MemDiff::Pages(const Mem& A, const Mem& B, u64 (&Changed)[BITMAP_WORDS], const u64* OnlyPages, Kernel Use)
+{
+    memset(Changed, 0, sizeof(Changed));
+    switch (Resolve(Use))
+    {
+#ifdef M6502_MEMDIFF_X86
+        case Kernel::AVX2:
+            PagesAVX2(A.Data, B.Data, Changed, OnlyPages);
+            break;
+        case Kernel::SSE2:
+            PagesGeneric<PageDiffersSSE2>(A.Data, B.Data, Changed, OnlyPages);
+            break;
+#endif
+        default:
+            PagesGeneric<PageDiffersScalar>(A.Data, B.Data, Changed, OnlyPages);
+            break;
+    }
+}
+
+std::vector<m6502::MemDiff::Range> m6502::MemDiff::Ranges(const Mem& A, const Mem& B, const u64* OnlyPages, Kernel Use)
+{
+    const Kernel Resolved = Resolve(Use);
+    u64 Changed[BITMAP_WORDS];
+    Pages(A, B, Changed, OnlyPages, Resolved);
+
+    void (*PageMask)(const Byte*, const Byte*, u64 (&)[4]) = PageMaskScalar;
+#ifdef M6502_MEMDIFF_X86
+    if (Resolved == Kernel::AVX2)
+    {
+        PageMask = PageMaskAVX2;
+    }
+    else if (Resolved == Kernel::SSE2)
+    {
+        PageMask = PageMaskSSE2;
+    }
+#endif
+
+    // Only the changed pages are compared byte by byte
+    std::vector<Range> Result;
+    u32 RunStart = 0, RunEnd = 0;
+    bool Open = false;
+    for (u32 Page = 0; Page < Mem::NUM_PAGES; Page++)
+    {
+        const u64 Later = Changed[Page >> 6] >> (Page & 63);
+        if (!Later)
+        {
+            // Nothing more in this bitmap word, go to the start of the next
+            Page |= 63;
+            continue;
+        }
+        if (!(Later & 1))
+        {
+            Page += __builtin_ctzll(Later) - 1;
+            continue;
+        }
+        u64 Mask[4] = {};
+        PageMask(A.Data + Page * PAGE_SIZE, B.Data + Page * PAGE_SIZE, Mask);
+        for (u32 Word64 = 0; Word64 < 4; Word64++)
+        {
+            u64 Bits = Mask[Word64];
+            const u32 Base = Page * PAGE_SIZE + Word64 * 64;
+            while (Bits)
+            {
+                const u32 First = __builtin_ctzll(Bits);
+                const u64 Rest = ~(Bits >> First);
+                const u32 Count = Rest ? __builtin_ctzll(Rest) : 64 - First;
+                const u32 Start = Base + First;
+                if (Open && Start == RunEnd)
+                {
+                    RunEnd += Count;
+                }
+                else
+                {
+                    if (Open)
+                    {
+                        Result.push_back({ (Word)RunStart, RunEnd - RunStart });
+                    }
+                    RunStart = Start;
+                    RunEnd = Start + Count;
+                    Open = true;
+                }
+                Bits = (First + Count < 64) ? Bits & (~0ull << (First + Count)) : 0;
+            }
+        }
+    }
+    if (Open)
+    {
+        Result.push_back({ (Word)RunStart, RunEnd - RunStart });
+    }
+    return Result;
+}
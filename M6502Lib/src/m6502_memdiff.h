@@ -0,0 +1,48 @@
+/*
+ * Which bytes differ between two Mem images
+ *
+ * For differential testing and save state deltas. Compares the flat Data
+ * images with AVX2 or SSE2 where the CPU has them (picked at run time),
+ * otherwise 8 bytes at a time. Either result can be restricted to a page
+ * bitmap in the layout of Mem::DirtyPages, e.g. the OR of both images'
+ * dirty pages, so untouched pages are never read.
+ */
+#pragma once
+
+#include <vector>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct MemDiff;
+}
+
+struct m6502::MemDiff
+{
+    static constexpr u32 BITMAP_WORDS = Mem::NUM_PAGES / 64;
+
+    enum class Kernel : Byte
+    {
+        Auto,       // The best one this CPU supports
+        Scalar,
+        SSE2,
+        AVX2,
+    };
+
+    struct Range
+    {
+        Word Start;
+        u32 Length;
+    };
+
+    // @return the kernel Auto resolves to
+    static Kernel Best();
+
+    // Set a bit per page (256 bytes) that differs, pages outside OnlyPages are left clear
+    static void Pages(const Mem& A, const Mem& B, u64 (&Changed)[BITMAP_WORDS],
+                      const u64* OnlyPages = nullptr, Kernel Use = Kernel::Auto);
+
+    // @return the runs of differing bytes in address order, runs spanning pages are merged
+    static std::vector<Range> Ranges(const Mem& A, const Mem& B,
+                                     const u64* OnlyPages = nullptr, Kernel Use = Kernel::Auto);
+};
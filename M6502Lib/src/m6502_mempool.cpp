@@ -0,0 +1,77 @@
+#include "m6502_mempool.h"
+
+#include <new>
+#include <sys/mman.h>
+
+m6502::MemPool::MemPool(u32 Capacity)
+    : Capacity(Capacity)
+{
+    ArenaSize = (Capacity * SLOT_SIZE + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (ArenaSize == 0)
+    {
+        return;
+    }
+
+    void* Mapping = mmap(nullptr, ArenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (Mapping != MAP_FAILED)
+    {
+        ExplicitHugePages = true;
+        Arena = (Byte*)Mapping;
+    }
+    else
+    {
+        // Over-allocate so the arena can start on a 2 MiB boundary, then ask for THP
+        const u64 Reserved = ArenaSize + HUGE_PAGE_SIZE;
+        Mapping = mmap(nullptr, Reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (Mapping == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        Byte* Start = (Byte*)Mapping;
+        Byte* Aligned = (Byte*)(((u64)Start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+        if (Aligned > Start)
+        {
+            munmap(Start, Aligned - Start);
+        }
+        const u64 Tail = (Start + Reserved) - (Aligned + ArenaSize);
+        if (Tail > 0)
+        {
+            munmap(Aligned + ArenaSize, Tail);
+        }
+        madvise(Aligned, ArenaSize, MADV_HUGEPAGE);
+        Arena = Aligned;
+    }
+    FreeSlots.reserve(Capacity);
+}
+
+m6502::MemPool::~MemPool()
+{
+    if (Arena)
+    {
+        munmap(Arena, ArenaSize);
+    }
+}
+
+m6502::Mem* m6502::MemPool::Acquire()
+{
+    if (!FreeSlots.empty())
+    {
+        const u32 Slot = FreeSlots.back();
+        FreeSlots.pop_back();
+        return (Mem*)(Arena + Slot * SLOT_SIZE);
+    }
+    if (NextUnused < Capacity)
+    {
+        // Fresh anonymous memory is already zero, only the tables need setting up
+        return new (Arena + (NextUnused++) * SLOT_SIZE) Mem();
+    }
+    return nullptr;
+}
+
+void m6502::MemPool::Release(Mem* memory)
+{
+    // Unmap first so the dirty pages are cleared in Data, not in whatever bank was last mapped
+    memory->UnmapAll();
+    memory->ClearDirty();
+    FreeSlots.push_back((u32)(((Byte*)memory - Arena) / SLOT_SIZE));
+}
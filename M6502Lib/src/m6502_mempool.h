@@ -0,0 +1,53 @@
+/*
+ * Pool of Mem images carved out of one large arena
+ *
+ * Fleets of machines allocating a Mem each fragment the heap and spread
+ * images over many small pages. The pool reserves a single 2 MiB aligned
+ * arena (explicit huge pages when the system has them reserved, otherwise
+ * transparent huge pages are requested) and hands out page aligned slots.
+ * Acquire and Release are O(1). Released images are recycled by zeroing
+ * only their dirty pages, so host writes must go through Mem::Load or be
+ * marked with Mem::MarkDirty.
+ */
+#pragma once
+
+#include <vector>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct MemPool;
+}
+
+struct m6502::MemPool
+{
+    static constexpr u64 HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr u64 SLOT_ALIGNMENT = 4096;
+    static constexpr u64 SLOT_SIZE = (sizeof(Mem) + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+
+    Byte* Arena = nullptr;
+    u64 ArenaSize = 0;
+    u32 Capacity = 0;
+    bool ExplicitHugePages = false;
+
+    explicit MemPool(u32 Capacity);
+    ~MemPool();
+
+    MemPool(const MemPool&) = delete;
+    MemPool& operator=(const MemPool&) = delete;
+
+    // @return a zeroed, unmapped image, or nullptr when the pool is exhausted
+    Mem* Acquire();
+
+    void Release(Mem* memory);
+
+    u32 NumFree() const
+    {
+        return (u32)FreeSlots.size() + (Capacity - NextUnused);
+    }
+
+    // Released slots, reused before fresh ones so the hot set stays small
+    std::vector<u32> FreeSlots;
+    // Slots from here on have never been handed out and are still zero from mmap
+    u32 NextUnused = 0;
+};
@@ -0,0 +1,44 @@
+#include "m6502_opcodeprofile.h"
+
+#include <algorithm>
+
+void m6502::OpcodeProfile::Record(CPU& cpu, Mem& memory, s32 Cycles)
+{
+    int Previous = -1;
+    while (Cycles > 0 && !cpu.Jammed)
+    {
+        const Byte Ins = memory[cpu.PC];
+        Count[Ins]++;
+        if (Previous >= 0)
+        {
+            Pairs[Previous][Ins]++;
+        }
+        Previous = Ins;
+        // A budget of one cycle always runs exactly one instruction
+        Cycles -= cpu.Execute(1, memory);
+    }
+}
+
+std::vector<m6502::OpcodeProfile::PairCount> m6502::OpcodeProfile::TopPairs(u32 Num) const
+{
+    std::vector<PairCount> Result;
+    for (u32 First = 0; First < 256; First++)
+    {
+        for (u32 Second = 0; Second < 256; Second++)
+        {
+            if (Pairs[First][Second] > 0)
+            {
+                Result.push_back({ (Byte)First, (Byte)Second, Pairs[First][Second] });
+            }
+        }
+    }
+    std::sort(Result.begin(), Result.end(), [](const PairCount& L, const PairCount& R)
+    {
+        return L.Count > R.Count;
+    });
+    if (Result.size() > Num)
+    {
+        Result.resize(Num);
+    }
+    return Result;
+}
@@ -0,0 +1,35 @@
+/*
+ * Per opcode and opcode pair execution counts
+ *
+ * Used to pick the pairs CPU::ExecuteFused fuses: run a workload through
+ * Record and look at TopPairs. Steps one instruction at a time, so
+ * it is far slower than Execute and only meant for offline profiling.
+ */
+#pragma once
+
+#include <vector>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct OpcodeProfile;
+}
+
+struct m6502::OpcodeProfile
+{
+    u64 Count[256] = {};
+    u64 Pairs[256][256] = {};
+
+    struct PairCount
+    {
+        Byte First;
+        Byte Second;
+        u64 Count;
+    };
+
+    // Run the CPU for at least Cycles, counting every opcode and adjacent opcode pair
+    void Record(CPU& cpu, Mem& memory, s32 Cycles);
+
+    // @return the most frequent pairs, most frequent first
+    std::vector<PairCount> TopPairs(u32 Num) const;
+};
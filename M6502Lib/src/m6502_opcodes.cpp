@@ -0,0 +1,132 @@
+#include "m6502_opcodes.h"
+
+#include <cstring>
+
+namespace
+{
+    using namespace m6502;
+    using Mode = AddressingMode;
+    using Kind = OpcodeKind;
+
+    constexpr Byte NMOS = 1 << (u32)CPUVariant::NMOS6502;
+    constexpr Byte CMOS = 1 << (u32)CPUVariant::CMOS65C02;
+    constexpr Byte RP2A03 = 1 << (u32)CPUVariant::RP2A03;
+    constexpr Byte ALL_VARIANTS = NMOS | CMOS | RP2A03;
+
+    constexpr OpcodeInfo OPCODES[] =
+    {
+        { CPU::INS_LDA_IM, "LDA", Mode::Imm, Kind::Load, 'A', 2, ALL_VARIANTS },
+        { CPU::INS_LDA_ZP, "LDA", Mode::Zp, Kind::Load, 'A', 3, ALL_VARIANTS },
+        { CPU::INS_LDA_ZPX, "LDA", Mode::ZpX, Kind::Load, 'A', 4, ALL_VARIANTS },
+        { CPU::INS_LDA_ABS, "LDA", Mode::Abs, Kind::Load, 'A', 4, ALL_VARIANTS },
+        { CPU::INS_LDA_ABSX, "LDA", Mode::AbsX, Kind::Load, 'A', 5, ALL_VARIANTS },
+        { CPU::INS_LDA_ABSY, "LDA", Mode::AbsY, Kind::Load, 'A', 5, ALL_VARIANTS },
+        { CPU::INS_LDA_INDX, "LDA", Mode::IndX, Kind::Load, 'A', 6, ALL_VARIANTS },
+        { CPU::INS_LDA_INDY, "LDA", Mode::IndY, Kind::Load, 'A', 6, ALL_VARIANTS },
+        { CPU::INS_LDX_IM, "LDX", Mode::Imm, Kind::Load, 'X', 2, ALL_VARIANTS },
+        { CPU::INS_LDX_ZP, "LDX", Mode::Zp, Kind::Load, 'X', 3, ALL_VARIANTS },
+        { CPU::INS_LDX_ZPY, "LDX", Mode::ZpY, Kind::Load, 'X', 4, ALL_VARIANTS },
+        { CPU::INS_LDX_ABS, "LDX", Mode::Abs, Kind::Load, 'X', 4, ALL_VARIANTS },
+        { CPU::INS_LDX_ABSY, "LDX", Mode::AbsY, Kind::Load, 'X', 5, ALL_VARIANTS },
+        { CPU::INS_LDY_IM, "LDY", Mode::Imm, Kind::Load, 'Y', 2, ALL_VARIANTS },
+        { CPU::INS_LDY_ZP, "LDY", Mode::Zp, Kind::Load, 'Y', 3, ALL_VARIANTS },
+        { CPU::INS_LDY_ZPX, "LDY", Mode::ZpX, Kind::Load, 'Y', 4, ALL_VARIANTS },
+        { CPU::INS_LDY_ABS, "LDY", Mode::Abs, Kind::Load, 'Y', 4, ALL_VARIANTS },
+        { CPU::INS_LDY_ABSX, "LDY", Mode::AbsX, Kind::Load, 'Y', 5, ALL_VARIANTS },
+        { CPU::INS_STA_ZP, "STA", Mode::Zp, Kind::Store, 'A', 3, ALL_VARIANTS },
+        { CPU::INS_STA_ZPX, "STA", Mode::ZpX, Kind::Store, 'A', 4, ALL_VARIANTS },
+        { CPU::INS_STA_ABS, "STA", Mode::Abs, Kind::Store, 'A', 4, ALL_VARIANTS },
+        { CPU::INS_STA_ABSX, "STA", Mode::AbsX, Kind::Store, 'A', 5, ALL_VARIANTS },
+        { CPU::INS_STA_ABSY, "STA", Mode::AbsY, Kind::Store, 'A', 5, ALL_VARIANTS },
+        { CPU::INS_STA_INDX, "STA", Mode::IndX, Kind::Store, 'A', 6, ALL_VARIANTS },
+        { CPU::INS_STA_INDY, "STA", Mode::IndY, Kind::Store, 'A', 6, ALL_VARIANTS },
+        { CPU::INS_STX_ZP, "STX", Mode::Zp, Kind::Store, 'X', 3, ALL_VARIANTS },
+        { CPU::INS_STX_ZPY, "STX", Mode::ZpY, Kind::Store, 'X', 4, ALL_VARIANTS },
+        { CPU::INS_STX_ABS, "STX", Mode::Abs, Kind::Store, 'X', 4, ALL_VARIANTS },
+        { CPU::INS_STY_ZP, "STY", Mode::Zp, Kind::Store, 'Y', 3, ALL_VARIANTS },
+        { CPU::INS_STY_ZPX, "STY", Mode::ZpX, Kind::Store, 'Y', 4, ALL_VARIANTS },
+        { CPU::INS_STY_ABS, "STY", Mode::Abs, Kind::Store, 'Y', 4, ALL_VARIANTS },
+        { CPU::INS_JSR, "JSR", Mode::Abs, Kind::Jsr, 0, 6, ALL_VARIANTS },
+        { CPU::INS_RTS, "RTS", Mode::Implied, Kind::Rts, 0, 6, ALL_VARIANTS },
+        { CPU::INS_JMP_ABS, "JMP", Mode::Abs, Kind::Jmp, 0, 3, ALL_VARIANTS },
+        { CPU::INS_JMP_IND, "JMP", Mode::Ind, Kind::JmpInd, 0, 5, NMOS | RP2A03 },
+        // 65C02 only
+        { CPU::INS_JMP_IND, "JMP", Mode::Ind, Kind::JmpInd, 0, 6, CMOS },
+        { CPU::INS_LDA_INDZP, "LDA", Mode::IndZp, Kind::Load, 'A', 5, CMOS },
+        { CPU::INS_STA_INDZP, "STA", Mode::IndZp, Kind::Store, 'A', 5, CMOS },
+        { CPU::INS_STZ_ZP, "STZ", Mode::Zp, Kind::Store, 0, 3, CMOS },
+        { CPU::INS_STZ_ZPX, "STZ", Mode::ZpX, Kind::Store, 0, 4, CMOS },
+        { CPU::INS_STZ_ABS, "STZ", Mode::Abs, Kind::Store, 0, 4, CMOS },
+        { CPU::INS_STZ_ABSX, "STZ", Mode::AbsX, Kind::Store, 0, 5, CMOS },
+        { CPU::INS_JMP_ABSX_IND, "JMP", Mode::AbsXInd, Kind::JmpInd, 0, 6, CMOS },
+    };
+
+    constexpr OpcodeInfo::DecodeTable BuildTable(CPUVariant Variant)
+    {
+        OpcodeInfo::DecodeTable Table{};
+        for (const OpcodeInfo& Info : OPCODES)
+        {
+            if (Info.Variants & (1 << (u32)Variant))
+            {
+                Table.Entries[Info.Opcode] = &Info;
+            }
+        }
+        return Table;
+    }
+}
+
+constexpr m6502::OpcodeInfo::DecodeTable m6502::OpcodeInfo::TABLES[3] =
+{
+    BuildTable(CPUVariant::NMOS6502),
+    BuildTable(CPUVariant::CMOS65C02),
+    BuildTable(CPUVariant::RP2A03),
+};
+
+std::span<const m6502::OpcodeInfo> m6502::OpcodeInfo::All()
+{
+    return OPCODES;
+}
+
+int m6502::OpcodeInfo::Format(Word Operand, char* Text, u32 Size) const
+{
+    // Operand syntax around the hex digits, by AddressingMode
+    struct Syntax
+    {
+        const char* Prefix;
+        u32 Digits;
+        const char* Suffix;
+    };
+    static const Syntax SYNTAX[] =
+    {
+        { "", 0, "" }, { " #$", 2, "" }, { " $", 2, "" }, { " $", 2, ",X" }, { " $", 2, ",Y" },
+        { " $", 4, "" }, { " $", 4, ",X" }, { " $", 4, ",Y" }, { " ($", 2, ",X)" }, { " ($", 2, "),Y" },
+        { " ($", 4, ")" }, { " ($", 2, ")" }, { " ($", 4, ",X)" },
+    };
+    static const char HEX[] = "0123456789ABCDEF";
+
+    char Buffer[32];
+    u32 Length = 0;
+    const Syntax& Form = SYNTAX[(u32)AddrMode];
+    for (const char* Part : { Name, Form.Prefix })
+    {
+        while (*Part)
+        {
+            Buffer[Length++] = *Part++;
+        }
+    }
+    for (u32 Digit = Form.Digits; Digit-- > 0;)
+    {
+        Buffer[Length++] = HEX[(Operand >> (Digit * 4)) & 0xF];
+    }
+    for (const char* Part = Form.Suffix; *Part;)
+    {
+        Buffer[Length++] = *Part++;
+    }
+    if (Size > 0)
+    {
+        const u32 Copied = Length < Size ? Length : Size - 1;
+        memcpy(Text, Buffer, Copied);
+        Text[Copied] = 0;
+    }
+    return (int)Length;
+}
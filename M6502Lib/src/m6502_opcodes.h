@@ -0,0 +1,103 @@
+/*
+ * One table describing every opcode the CPU implements
+ *
+ * Tools that look at code rather than run it (the disassembler and code
+ * map, the recompiler, the superoptimizer) decode through this table, so
+ * they agree with each other and with CPU::Execute on which opcodes exist
+ * for each CPUVariant, how long they are and what they do to control flow.
+ *  - Decode() is one lookup in a 256 entry table per variant, built at
+ *    compile time
+ *  - MaxCycles is what CPU::Execute counts, page crossing penalty included
+ */
+#pragma once
+
+#include <span>
+#include "m6502.h"
+
+namespace m6502
+{
+    enum class AddressingMode : Byte
+    {
+        Implied,
+        Imm,
+        Zp,
+        ZpX,
+        ZpY,
+        Abs,
+        AbsX,
+        AbsY,
+        IndX,       // (zp,X)
+        IndY,       // (zp),Y
+        Ind,        // (abs), JMP only
+        IndZp,      // (zp), 65C02
+        AbsXInd,    // (abs,X), 65C02 JMP only
+    };
+
+    enum class OpcodeKind : Byte
+    {
+        Load,
+        Store,
+        Jsr,
+        Rts,
+        Jmp,
+        JmpInd,     // JMP (abs) and JMP (abs,X)
+    };
+
+    struct OpcodeInfo;
+}
+
+struct m6502::OpcodeInfo
+{
+    Byte Opcode;
+    const char* Name;
+    AddressingMode AddrMode;
+    OpcodeKind Type;
+    char Register;      // A, X or Y for loads and stores, 0 for STZ
+    Byte MaxCycles;
+    Byte Variants;      // Bit per CPUVariant that has the opcode
+
+    static constexpr u32 Length(AddressingMode AddrMode)
+    {
+        switch (AddrMode)
+        {
+            case AddressingMode::Implied: return 1;
+            case AddressingMode::Abs: case AddressingMode::AbsX: case AddressingMode::AbsY:
+            case AddressingMode::Ind: case AddressingMode::AbsXInd: return 3;
+            default: return 2;
+        }
+    }
+
+    u32 Length() const
+    {
+        return Length(AddrMode);
+    }
+
+    // Control does not go on to the next instruction (JSR does, once the routine returns)
+    bool EndsFlow() const
+    {
+        return Type == OpcodeKind::Rts || Type == OpcodeKind::Jmp || Type == OpcodeKind::JmpInd;
+    }
+
+    struct DecodeTable
+    {
+        const OpcodeInfo* Entries[256];
+    };
+
+    static const DecodeTable TABLES[3];
+
+    // @return nullptr for opcodes the variant does not have (illegal)
+    static const OpcodeInfo* Decode(Byte Opcode, CPUVariant Variant = CPUVariant::NMOS6502)
+    {
+        return TABLES[(u32)Variant].Entries[Opcode];
+    }
+
+    // Every entry in the order of CPU::INS_*, an opcode shows up once per distinct timing
+    static std::span<const OpcodeInfo> All();
+
+    /*
+     * Assembler syntax for the instruction, e.g. "LDA ($10),Y"
+     *  - Operand is the byte or word following the opcode
+     *  - @return the length written, as snprintf
+     */
+    int Format(Word Operand, char* Text, u32 Size) const;
+};
@@ -0,0 +1,154 @@
+#include "m6502_pacer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+#include <sys/prctl.h>
+
+namespace
+{
+    using namespace m6502;
+
+    constexpr unsigned long TIMER_SLACK_NS = 1000;
+
+    // steady_clock is CLOCK_MONOTONIC, so its time points are valid deadlines
+    void SleepUntil(Pacer::Clock::time_point Deadline)
+    {
+        const auto Since = Deadline.time_since_epoch();
+        const auto Seconds = std::chrono::duration_cast<std::chrono::seconds>(Since);
+        timespec Until;
+        Until.tv_sec = Seconds.count();
+        Until.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(Since - Seconds).count();
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Until, nullptr) == EINTR)
+        {
+        }
+    }
+
+    double Seconds(Pacer::Clock::duration Duration)
+    {
+        return std::chrono::duration<double>(Duration).count();
+    }
+}
+
+m6502::u32 m6502::Pacer::Add(const CPU& cpu, Mem& memory, double Hz)
+{
+    Machines.push_back({ cpu, &memory, Hz });
+    return (u32)Machines.size() - 1;
+}
+
+void m6502::Pacer::RunSlices(Clock::time_point Now)
+{
+    const double Elapsed = Seconds(Now - Started);
+    const double CatchUp = Seconds(MaxCatchUp);
+    for (Machine& M : Machines)
+    {
+        if (M.Cpu.Jammed)
+        {
+            continue;
+        }
+        const double Due = Elapsed * M.Hz;
+        double Owed = Due - (double)M.Cycles;
+        if (Owed > CatchUp * M.Hz)
+        {
+            const u64 Dropped = (u64)(Owed - CatchUp * M.Hz);
+            M.DroppedCycles += Dropped;
+            M.Cycles += Dropped;
+            Owed -= (double)Dropped;
+        }
+        // An overrun of the last slice is paid back by running less now
+        if (Owed >= 1)
+        {
+            M.Cycles += M.Input ? M.Input->Execute(M.Cpu, *M.Memory, (s32)Owed)
+                                : M.Cpu.Execute((s32)Owed, *M.Memory);
+        }
+        if (M.Export)
+        {
+            M.Export->Publish(M.Cpu, M.Cycles);
+        }
+    }
+}
+
+void m6502::Pacer::RunFor(Clock::duration Duration)
+{
+    unsigned long PreviousSlack = (unsigned long)prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    prctl(PR_SET_TIMERSLACK, TIMER_SLACK_NS, 0, 0, 0);
+
+    Clock::time_point Deadline = Clock::now();
+    if (Started == Clock::time_point{})
+    {
+        Started = Deadline;
+    }
+    const Clock::time_point End = Deadline + Duration;
+    while (Deadline < End)
+    {
+        Deadline = std::min(Deadline + Period, End);
+        SleepUntil(Deadline);
+
+        const Clock::time_point Woke = Clock::now();
+        const Clock::duration Late = Woke - Deadline;
+        const s64 LateUs = std::chrono::duration_cast<std::chrono::microseconds>(Late).count();
+        const u32 Bucket = (u32)(std::upper_bound(LATENESS_LIMITS_US, LATENESS_LIMITS_US + LATENESS_BUCKETS - 1, LateUs)
+                                 - LATENESS_LIMITS_US);
+        Lateness[Bucket]++;
+        MaxLateness = std::max(MaxLateness, Late);
+        Wakeups++;
+
+        RunSlices(Woke);
+        const Clock::time_point Done = Clock::now();
+        const Clock::duration Slices = Done - Woke;
+        Busy += Slices;
+
+        if (Slices * 2 > Period)
+        {
+            Period = std::min(Period * 2, Clock::duration(MAX_PERIOD));
+        }
+        else if (Slices * 8 < Period)
+        {
+            Period = std::max(Period / 2, Clock::duration(MIN_PERIOD));
+        }
+        // Deadlines missed while running are skipped rather than run back to back
+        if (Done - Deadline > Period)
+        {
+            Deadline = Done;
+        }
+    }
+
+    prctl(PR_SET_TIMERSLACK, PreviousSlack, 0, 0, 0);
+}
+
+double m6502::Pacer::Drift(u32 Index) const
+{
+    const Machine& M = Machines[Index];
+    return (double)M.Cycles / M.Hz - Seconds(Clock::now() - Started);
+}
+
+double m6502::Pacer::Utilisation() const
+{
+    const double Wall = Seconds(Clock::now() - Started);
+    return Wall > 0 ? Seconds(Busy) / Wall : 0;
+}
+
+void m6502::Pacer::WriteReport(std::ostream& Output) const
+{
+    Output << "wakeups " << Wakeups << ", period now "
+           << std::chrono::duration_cast<std::chrono::microseconds>(Period).count() << " us\n";
+    Output << "lateness (us):\n";
+    for (u32 Bucket = 0; Bucket < LATENESS_BUCKETS; Bucket++)
+    {
+        Output << "  " << (Bucket + 1 < LATENESS_BUCKETS ? "< " : ">= ")
+               << LATENESS_LIMITS_US[std::min(Bucket, LATENESS_BUCKETS - 2)] << '\t' << Lateness[Bucket] << '\n';
+    }
+    Output << "max lateness " << std::chrono::duration_cast<std::chrono::microseconds>(MaxLateness).count() << " us\n";
+    Output << "utilisation " << Utilisation() * 100 << " %\n";
+
+    double WorstDrift = 0;
+    u64 Dropped = 0;
+    for (u32 Index = 0; Index < NumMachines(); Index++)
+    {
+        const double Each = Drift(Index);
+        WorstDrift = std::fabs(Each) > std::fabs(WorstDrift) ? Each : WorstDrift;
+        Dropped += Machines[Index].DroppedCycles;
+    }
+    Output << "worst drift " << WorstDrift * 1e6 << " us, dropped cycles " << Dropped << '\n';
+}
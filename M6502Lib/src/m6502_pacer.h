@@ -0,0 +1,104 @@
+/*
+ * Real time pacing of many machines on one thread
+ *
+ * Wakes up once per Period on absolute deadlines (clock_nanosleep with
+ * TIMER_ABSTIME on CLOCK_MONOTONIC, so sleeps do not accumulate error)
+ * and gives every machine one Execute slice of the cycles its clock owes
+ * since it started. A slice is whatever the wall clock says is due, so a
+ * late wake-up is made up by a longer slice and an overrun is taken off
+ * the next one.
+ *  - After a stall (the process was descheduled, a debugger stopped it)
+ *    a machine catches up at most MaxCatchUp of emulated time, anything
+ *    older is dropped and counted in DroppedCycles
+ *  - The period adapts: it doubles (up to MAX_PERIOD) while running the
+ *    slices takes more than half of it, so the per wake-up cost is spread
+ *    over more cycles, and halves (down to MIN_PERIOD) when they take
+ *    under an eighth of it, for finer pacing
+ *  - The thread's timer slack is lowered while running, the default 50 us
+ *    would show up as lateness on every wake-up
+ *
+ * A machine whose Mem lives in a SharedMachine can publish its registers
+ * to other processes by setting Export, and can take input from host
+ * threads by setting Input.
+ *
+ * One pacer handles hundreds of machines, for more cores run one pacer
+ * per thread. The Mem images are owned by the caller.
+ */
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+#include "m6502.h"
+#include "m6502_input.h"
+#include "m6502_shared.h"
+
+namespace m6502
+{
+    struct Pacer;
+}
+
+struct m6502::Pacer
+{
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double APPLE_II_HZ = 1022727.0;
+    static constexpr double NES_NTSC_HZ = 1789773.0;
+
+    static constexpr Clock::duration MIN_PERIOD = std::chrono::microseconds(250);
+    static constexpr Clock::duration MAX_PERIOD = std::chrono::milliseconds(4);
+    static constexpr Clock::duration INITIAL_PERIOD = std::chrono::milliseconds(1);
+
+    // Upper bounds of the lateness histogram buckets in microseconds, the last bucket is everything later
+    static constexpr u32 LATENESS_BUCKETS = 8;
+    static constexpr s64 LATENESS_LIMITS_US[LATENESS_BUCKETS - 1] = { 10, 25, 50, 100, 250, 500, 1000 };
+
+    struct Machine
+    {
+        CPU Cpu;
+        Mem* Memory;
+        double Hz;
+        u64 Cycles = 0;         // Emulated so far, dropped cycles included
+        u64 DroppedCycles = 0;
+        SharedMachine* Export = nullptr;    // Registers published here after every slice
+        InputQueue* Input = nullptr;        // Slices run through this queue when set
+    };
+
+    std::vector<Machine> Machines;
+
+    Clock::duration Period = INITIAL_PERIOD;
+    Clock::duration MaxCatchUp = std::chrono::milliseconds(50);
+
+    // Stats, from the first RunFor on
+    Clock::time_point Started{};
+    Clock::duration Busy{};             // Time spent running slices
+    u64 Wakeups = 0;
+    u64 Lateness[LATENESS_BUCKETS] = {};
+    Clock::duration MaxLateness{};
+
+    // @return the machine's index, its CPU state is copied in
+    u32 Add(const CPU& cpu, Mem& memory, double Hz);
+
+    u32 NumMachines() const
+    {
+        return (u32)Machines.size();
+    }
+
+    /*
+     * Pace every machine for Duration of wall time, on the calling thread
+     *  - Illegal opcodes throw out of here if the CPU is set to throw
+     */
+    void RunFor(Clock::duration Duration);
+
+    // Emulated time ahead (positive) or behind (negative) of the wall clock, in seconds
+    double Drift(u32 Index) const;
+
+    // Share of the wall time since the start spent running slices rather than asleep
+    double Utilisation() const;
+
+    // Lateness histogram, utilisation and the worst drift, one item per line
+    void WriteReport(std::ostream& Output) const;
+
+private:
+    void RunSlices(Clock::time_point Now);
+};
@@ -0,0 +1,31 @@
+/*
+ * Static tracepoints (USDT)
+ *
+ * Built in with the M6502_USDT CMake option (needs sys/sdt.h, from
+ * systemtap-sdt-dev / systemtap-sdt-devel). Each probe is a single nop
+ * until a tracer attaches, e.g.
+ *
+ *  bpftrace -e 'usdt:./M6502Test:m6502:jsr { @calls[arg1] = count(); }'
+ *  perf buildid-cache --add ./app && perf record -e sdt_m6502:slice_end ./app
+ *
+ * Probes, provider "m6502"
+ *  - dispatch(pc, opcode)                   every instruction
+ *  - reset(pc)                              CPU::Reset
+ *  - illegal(pc, opcode)                    illegal opcode, before throwing or jamming
+ *  - jsr(pc, target, sp)                    pc is the JSR's own address
+ *  - rts(return_pc, sp)
+ *  - slice_end(requested, used, pc)         end of Execute / ExecuteFused
+ * Without the option the macros expand to nothing.
+ */
+#pragma once
+
+#ifdef M6502_USDT
+#include <sys/sdt.h>
+#define M6502_PROBE1(Name, A) DTRACE_PROBE1(m6502, Name, A)
+#define M6502_PROBE2(Name, A, B) DTRACE_PROBE2(m6502, Name, A, B)
+#define M6502_PROBE3(Name, A, B, C) DTRACE_PROBE3(m6502, Name, A, B, C)
+#else
+#define M6502_PROBE1(Name, A) do {} while (0)
+#define M6502_PROBE2(Name, A, B) do {} while (0)
+#define M6502_PROBE3(Name, A, B, C) do {} while (0)
+#endif
@@ -0,0 +1,172 @@
+#include "m6502_profiler.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+/*
+ * Symbols
+ */
+
+void m6502::SymbolTable::ParseViceLabels(std::istream& Input)
+{
+    std::string Line;
+    while (std::getline(Input, Line))
+    {
+        std::istringstream Fields(Line);
+        std::string Command, Address, Label;
+        if (!(Fields >> Command >> Address >> Label) || Command != "al")
+        {
+            continue;
+        }
+        const size_t Colon = Address.find(':');
+        if (Colon != std::string::npos)
+        {
+            Address = Address.substr(Colon + 1);
+        }
+        if (!Label.empty() && Label[0] == '.')
+        {
+            Label = Label.substr(1);
+        }
+        Labels[(Word)strtoul(Address.c_str(), nullptr, 16)] = Label;
+    }
+}
+
+void m6502::SymbolTable::ParseCa65Dbg(std::istream& Input)
+{
+    // e.g. sym	id=3,name="main",addrsize=absolute,scope=0,def=12,val=0x810,seg=0,type=lab
+    std::string Line;
+    while (std::getline(Input, Line))
+    {
+        if (Line.compare(0, 4, "sym\t") != 0)
+        {
+            continue;
+        }
+        const size_t NameStart = Line.find("name=\"");
+        const size_t ValueStart = Line.find("val=");
+        if (NameStart == std::string::npos || ValueStart == std::string::npos)
+        {
+            continue;
+        }
+        const size_t NameEnd = Line.find('"', NameStart + 6);
+        if (NameEnd == std::string::npos)
+        {
+            continue;
+        }
+        // Only labels are code addresses, equates may be any number
+        if (Line.find("type=lab") == std::string::npos)
+        {
+            continue;
+        }
+        const u32 Value = (u32)strtoul(Line.c_str() + ValueStart + 4, nullptr, 0);
+        Labels[(Word)Value] = Line.substr(NameStart + 6, NameEnd - NameStart - 6);
+    }
+}
+
+bool m6502::SymbolTable::LoadViceLabels(const std::string& Path)
+{
+    std::ifstream File(Path);
+    if (!File)
+    {
+        return false;
+    }
+    ParseViceLabels(File);
+    return true;
+}
+
+bool m6502::SymbolTable::LoadCa65Dbg(const std::string& Path)
+{
+    std::ifstream File(Path);
+    if (!File)
+    {
+        return false;
+    }
+    ParseCa65Dbg(File);
+    return true;
+}
+
+std::string m6502::SymbolTable::Name(Word Address) const
+{
+    auto Next = Labels.upper_bound(Address);
+    if (Next != Labels.begin())
+    {
+        return std::prev(Next)->second;
+    }
+    char Hex[6];
+    snprintf(Hex, sizeof(Hex), "$%04X", Address);
+    return Hex;
+}
+
+/*
+ * Profiler
+ */
+
+m6502::Profiler::Profiler(s32 SampleInterval)
+    : SampleInterval(SampleInterval > 0 ? SampleInterval : 1)
+{
+    Stack.reserve(MAX_DEPTH);
+}
+
+void m6502::Profiler::Attach(CPU& cpu)
+{
+    cpu.CallProfiler = this;
+    Stack.clear();
+    Root = cpu.PC;
+}
+
+void m6502::Profiler::Sample(Word PC, s32 Cycles)
+{
+    std::vector<Word> Path;
+    Path.reserve(Stack.size() + 1);
+    for (const Frame& Call : Stack)
+    {
+        Path.push_back(Call.Target);
+    }
+    Path.push_back(PC);
+    Samples[Path] += Cycles;
+    SampledCycles += Cycles;
+}
+
+m6502::s32 m6502::Profiler::Run(CPU& cpu, Mem& memory, s32 Cycles)
+{
+    if (cpu.CallProfiler != this)
+    {
+        Attach(cpu);
+    }
+
+    s32 Remaining = Cycles;
+    while (Remaining > 0 && !cpu.Jammed)
+    {
+        const s32 Used = cpu.Execute(Remaining < SampleInterval ? Remaining : SampleInterval, memory);
+        Sample(cpu.PC, Used);
+        Remaining -= Used;
+    }
+    return Cycles - Remaining;
+}
+
+void m6502::Profiler::WriteFolded(std::ostream& Output, const SymbolTable& Symbols) const
+{
+    // Different PCs in one routine fold into the same line
+    std::map<std::string, u64> Folded;
+    for (const auto& [Path, Cycles] : Samples)
+    {
+        std::string Line = Symbols.Name(Root);
+        std::string Last = Line;
+        for (size_t Index = 0; Index < Path.size(); Index++)
+        {
+            std::string Name = Symbols.Name(Path[Index]);
+            if (Index == Path.size() - 1 && Name == Last)
+            {
+                break;
+            }
+            Line += ';';
+            Line += Name;
+            Last = std::move(Name);
+        }
+        Folded[Line] += Cycles;
+    }
+    for (const auto& [Line, Cycles] : Folded)
+    {
+        Output << Line << ' ' << Cycles << '\n';
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Guest level sampling profiler
+ *
+ * Keeps a shadow call stack from the JSR and RTS handlers and samples it
+ * (with PC) every SampleInterval emulated cycles. Each sample is weighted
+ * with the cycles of its interval, so the folded output counts cycles
+ * spent per guest call path, ready for flamegraph.pl or speedscope.
+ *
+ * Cost: with no profiler attached JSR and RTS only test CPU::CallProfiler.
+ * Sampling happens between Execute slices, so the interval trades accuracy
+ * for slice overhead.
+ */
+#pragma once
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct SymbolTable;
+    struct Profiler;
+}
+
+/*
+ * Address to label lookup
+ *  - VICE label files: "al C:0810 .main" (the "C:" is optional)
+ *  - ca65/ld65 debug files (--dbgfile): "sym" lines with name= and val=
+ */
+struct m6502::SymbolTable
+{
+    std::map<Word, std::string> Labels;
+
+    void ParseViceLabels(std::istream& Input);
+    void ParseCa65Dbg(std::istream& Input);
+
+    // @return false if the file could not be opened
+    bool LoadViceLabels(const std::string& Path);
+    bool LoadCa65Dbg(const std::string& Path);
+
+    // @return the closest label at or below Address, or $XXXX
+    std::string Name(Word Address) const;
+};
+
+struct m6502::Profiler
+{
+    static constexpr u32 MAX_DEPTH = 128;
+
+    struct Frame
+    {
+        Word Target;    // Called routine
+        Byte SP;        // Stack pointer before the JSR pushed
+    };
+
+    s32 SampleInterval;
+    std::vector<Frame> Stack;
+    Word Root = 0;      // PC when attached, the outermost frame
+
+    // Call path (called routines, then PC) to cycles
+    std::map<std::vector<Word>, u64> Samples;
+    u64 SampledCycles = 0;
+
+    explicit Profiler(s32 SampleInterval = 1000);
+
+    // Start following cpu's calls, with an empty shadow stack
+    void Attach(CPU& cpu);
+
+    void OnCall(Word Target, Byte SP)
+    {
+        if (Stack.size() < MAX_DEPTH)
+        {
+            Stack.push_back({ Target, SP });
+        }
+    }
+
+    void OnReturn(Byte SP)
+    {
+        // Also unwinds frames whose return address was dropped from the stack
+        while (!Stack.empty() && Stack.back().SP <= SP)
+        {
+            Stack.pop_back();
+        }
+    }
+
+    void Sample(Word PC, s32 Cycles);
+
+    /*
+     * Execute in slices of SampleInterval, sampling after each one
+     *  - Attaches to cpu first if it is not already attached; it stays
+     *    attached afterwards so calls made between runs are still followed
+     * @return the number of cycles used
+     */
+    s32 Run(CPU& cpu, Mem& memory, s32 Cycles);
+
+    /*
+     * One "root;outer;inner cycles" line per call path
+     *  - The PC's routine is the leaf, unless it is the innermost call again
+     */
+    void WriteFolded(std::ostream& Output, const SymbolTable& Symbols) const;
+};
@@ -0,0 +1,98 @@
+#include "m6502_scheduler.h"
+
+#include <algorithm>
+
+double m6502::Scheduler::MachineStats::BusyMHz() const
+{
+    const double Seconds = std::chrono::duration<double>(Busy).count();
+    return Seconds > 0 ? Cycles / Seconds / 1e6 : 0;
+}
+
+double m6502::Scheduler::MachineStats::MeanDelayMicroseconds() const
+{
+    // The first slice has no previous one to wait for
+    const double Delay = std::chrono::duration<double, std::micro>(TotalDelay).count();
+    return Slices > 1 ? Delay / (Slices - 1) : 0;
+}
+
+m6502::Scheduler::Scheduler(Clock::duration TargetLatency)
+    : TargetLatency(TargetLatency)
+{
+}
+
+m6502::u32 m6502::Scheduler::Add(const CPU& cpu, Mem& memory)
+{
+    Cpus.push_back(cpu);
+    Memories.push_back(&memory);
+    Quanta.push_back(INITIAL_QUANTUM);
+    Stats.emplace_back();
+    return (u32)Cpus.size() - 1;
+}
+
+void m6502::Scheduler::RunRound()
+{
+    const u32 Num = NumMachines();
+    if (Num == 0)
+    {
+        return;
+    }
+
+    Clock::time_point Now = Clock::now();
+    if (Started == Clock::time_point{})
+    {
+        Started = Now;
+    }
+    // Every machine gets an equal share of the round
+    const double SliceSeconds = std::chrono::duration<double>(TargetLatency).count() / Num;
+
+    for (u32 Machine = 0; Machine < Num; Machine++)
+    {
+        CPU& cpu = Cpus[Machine];
+        if (cpu.Jammed)
+        {
+            continue;
+        }
+
+        MachineStats& Stat = Stats[Machine];
+        const Clock::time_point Begin = Now;
+        const s32 Used = cpu.Execute(Quanta[Machine], *Memories[Machine]);
+        Now = Clock::now();
+
+        const Clock::duration Elapsed = Now - Begin;
+        if (Stat.Slices > 0)
+        {
+            const Clock::duration Delay = Begin - Stat.LastSliceEnd;
+            Stat.TotalDelay += Delay;
+            Stat.MaxDelay = std::max(Stat.MaxDelay, Delay);
+        }
+        Stat.LastSliceEnd = Now;
+        Stat.Cycles += Used;
+        Stat.Slices++;
+        Stat.Busy += Elapsed;
+
+        // Steer the quantum towards the machine's share of the round, moving
+        // halfway each slice so one slow slice (a page fault) does not whipsaw it
+        const double ElapsedSeconds = std::chrono::duration<double>(Elapsed).count();
+        if (Used > 0 && ElapsedSeconds > 0)
+        {
+            const double Wanted = Used / ElapsedSeconds * SliceSeconds;
+            const double Next = (Quanta[Machine] + Wanted) / 2;
+            Quanta[Machine] = (s32)std::clamp(Next, (double)MIN_QUANTUM, (double)MAX_QUANTUM);
+        }
+    }
+}
+
+void m6502::Scheduler::RunFor(Clock::duration Duration)
+{
+    const Clock::time_point End = Clock::now() + Duration;
+    do
+    {
+        RunRound();
+    } while (Clock::now() < End);
+}
+
+double m6502::Scheduler::AchievedMHz(u32 Machine) const
+{
+    const double Seconds = std::chrono::duration<double>(Clock::now() - Started).count();
+    return Seconds > 0 ? Stats[Machine].Cycles / Seconds / 1e6 : 0;
+}
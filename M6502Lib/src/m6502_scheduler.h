@@ -0,0 +1,78 @@
+/*
+ * Cooperative time slicing of many machines on one thread
+ *
+ * Round robins Execute slices over every machine. Each machine's quantum
+ * adapts so a full round takes about TargetLatency of wall time, which
+ * bounds how long any machine waits between slices.
+ *
+ * Switching machines should touch as little memory as possible, so the
+ * state is kept as parallel arrays: the CPUs are packed next to each other,
+ * the quanta sit in their own array, and the per-machine stats are only
+ * written once per slice. The Mem images are owned by the caller (e.g. a
+ * MemPool).
+ */
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct Scheduler;
+}
+
+struct m6502::Scheduler
+{
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr s32 MIN_QUANTUM = 64;
+    static constexpr s32 MAX_QUANTUM = 1 << 24;
+    static constexpr s32 INITIAL_QUANTUM = 1000;
+
+    struct MachineStats
+    {
+        u64 Cycles = 0;
+        u64 Slices = 0;
+        Clock::duration Busy{};         // Wall time spent executing
+        Clock::duration TotalDelay{};   // Time waited between slices
+        Clock::duration MaxDelay{};
+        Clock::time_point LastSliceEnd{};
+
+        // Emulated MHz while running, 0 before the first slice
+        double BusyMHz() const;
+
+        double MeanDelayMicroseconds() const;
+    };
+
+    Clock::duration TargetLatency;
+
+    std::vector<CPU> Cpus;
+    std::vector<Mem*> Memories;
+    std::vector<s32> Quanta;
+    std::vector<MachineStats> Stats;
+
+    Clock::time_point Started{};
+
+    explicit Scheduler(Clock::duration TargetLatency = std::chrono::milliseconds(1));
+
+    // @return the machine's index, its CPU state is copied in
+    u32 Add(const CPU& cpu, Mem& memory);
+
+    u32 NumMachines() const
+    {
+        return (u32)Cpus.size();
+    }
+
+    /*
+     * Give every machine one slice, jammed CPUs are skipped
+     *  - Illegal opcodes throw out of here if the CPU is set to throw
+     */
+    void RunRound();
+
+    // Run rounds until Duration of wall time has passed
+    void RunFor(Clock::duration Duration);
+
+    // Emulated MHz of a machine over the wall time since the first round
+    double AchievedMHz(u32 Machine) const;
+};
@@ -0,0 +1,137 @@
+#include "m6502_shared.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    [[noreturn]] void ThrowErrno(const std::string& What)
+    {
+        throw std::system_error(errno, std::generic_category(), What);
+    }
+}
+
+m6502::SharedMachine::SharedMachine(std::string SegmentName)
+    : Name(std::move(SegmentName))
+{
+    const int Fd = shm_open(Name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (Fd < 0)
+    {
+        ThrowErrno("shm_open " + Name);
+    }
+    if (ftruncate(Fd, SEGMENT_SIZE) != 0)
+    {
+        const int Error = errno;
+        close(Fd);
+        shm_unlink(Name.c_str());
+        throw std::system_error(Error, std::generic_category(), "ftruncate " + Name);
+    }
+    void* Mapping = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    const int Error = errno;
+    close(Fd);
+    if (Mapping == MAP_FAILED)
+    {
+        shm_unlink(Name.c_str());
+        throw std::system_error(Error, std::generic_category(), "mmap " + Name);
+    }
+
+    // The segment starts out zero, only the tables need setting up
+    Segment = (Byte*)Mapping;
+    Memory = new (Segment + MEM_OFFSET) Mem();
+    Shared = new (Segment) Header();
+    Shared->DataOffset = (u32)(Memory->Data - Segment);
+    Shared->Version = VERSION;
+    // Written last, a reader finding the magic finds the rest in place
+    std::atomic_thread_fence(std::memory_order_release);
+    Shared->Magic = MAGIC;
+}
+
+m6502::SharedMachine::~SharedMachine()
+{
+    Memory->~Mem();
+    munmap(Segment, SEGMENT_SIZE);
+    shm_unlink(Name.c_str());
+}
+
+void m6502::SharedMachine::Publish(const CPU& cpu, u64 Cycles)
+{
+    const u64 Sequence = Shared->Sequence.load(std::memory_order_relaxed);
+    Shared->Sequence.store(Sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Shared->PackedRegisters.store(Pack(cpu), std::memory_order_relaxed);
+    Shared->Cycles.store(Cycles, std::memory_order_relaxed);
+    Shared->Sequence.store(Sequence + 2, std::memory_order_release);
+}
+
+m6502::SharedMachineView::SharedMachineView(const std::string& Name)
+{
+    const int Fd = shm_open(Name.c_str(), O_RDONLY, 0);
+    if (Fd < 0)
+    {
+        ThrowErrno("shm_open " + Name);
+    }
+    struct stat Stat;
+    if (fstat(Fd, &Stat) != 0 || (u64)Stat.st_size < SharedMachine::SEGMENT_SIZE)
+    {
+        close(Fd);
+        throw std::runtime_error(Name + " is not a machine segment");
+    }
+    void* Mapping = mmap(nullptr, SharedMachine::SEGMENT_SIZE, PROT_READ, MAP_SHARED, Fd, 0);
+    const int Error = errno;
+    close(Fd);
+    if (Mapping == MAP_FAILED)
+    {
+        throw std::system_error(Error, std::generic_category(), "mmap " + Name);
+    }
+
+    Segment = (Byte*)Mapping;
+    Shared = (const SharedMachine::Header*)Segment;
+    if (Shared->Magic != SharedMachine::MAGIC || Shared->Version != SharedMachine::VERSION)
+    {
+        munmap(Segment, SharedMachine::SEGMENT_SIZE);
+        throw std::runtime_error(Name + " is not a machine segment of this version");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    Data = Segment + Shared->DataOffset;
+}
+
+m6502::SharedMachineView::~SharedMachineView()
+{
+    munmap(Segment, SharedMachine::SEGMENT_SIZE);
+}
+
+bool m6502::SharedMachineView::Read(SharedMachine::Registers& Out, u32 Tries) const
+{
+    for (u32 Try = 0; Try < Tries; Try++)
+    {
+        const u64 Before = Shared->Sequence.load(std::memory_order_acquire);
+        if (Before & 1)
+        {
+            continue;
+        }
+        const u64 Packed = Shared->PackedRegisters.load(std::memory_order_relaxed);
+        const u64 Cycles = Shared->Cycles.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (Shared->Sequence.load(std::memory_order_relaxed) != Before)
+        {
+            continue;
+        }
+        Out.PC = (Word)Packed;
+        Out.SP = (Byte)(Packed >> 16);
+        Out.A = (Byte)(Packed >> 24);
+        Out.X = (Byte)(Packed >> 32);
+        Out.Y = (Byte)(Packed >> 40);
+        Out.PS = (Byte)(Packed >> 48);
+        Out.Jammed = (Packed >> 56) & 1;
+        Out.Cycles = Cycles;
+        Out.Publishes = Before / 2;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,100 @@
+/*
+ * Live machine state in POSIX shared memory, for tools in other processes
+ *
+ * SharedMachine creates a segment (shm_open + mmap) holding a header and
+ * the machine's Mem, so the emulation runs on the shared image and a
+ * monitor that maps it sees Data as it is written, with nothing copied.
+ *  - Registers are published by the emulation thread with Publish(),
+ *    typically after each Execute slice. They sit behind a seqlock: the
+ *    writer never waits, a reader retries if a publish overlapped its read
+ *  - Only Data is meant for readers, bytes may change while a reader looks
+ *    at them. Banks mapped in from elsewhere (see Mapper) are not visible
+ *  - Segment names are shm names ("/name"). Creating one that exists fails,
+ *    a segment left by a crashed owner has to be removed with shm_unlink
+ *
+ * SharedMachineView maps a segment read only from any process.
+ */
+#pragma once
+
+#include <atomic>
+#include <string>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct SharedMachine;
+    struct SharedMachineView;
+}
+
+struct m6502::SharedMachine
+{
+    static constexpr u64 MAGIC = 0x4D4853323035364Dull;    // "M6502SHM" in memory order
+    static constexpr u32 VERSION = 1;
+    static constexpr u64 MEM_OFFSET = 4096;
+    static constexpr u64 SEGMENT_SIZE = MEM_OFFSET + (sizeof(Mem) + 4095) / 4096 * 4096;
+
+    // A consistent view of the registers as of one Publish()
+    struct Registers
+    {
+        Word PC = 0;
+        Byte SP = 0, A = 0, X = 0, Y = 0, PS = 0;
+        bool Jammed = false;
+        u64 Cycles = 0;
+        u64 Publishes = 0;
+    };
+
+    // Start of the segment, shared between processes so only address-free atomics
+    struct Header
+    {
+        u64 Magic;
+        u32 Version;
+        u32 DataOffset;         // Of Mem::Data from the start of the segment
+        alignas(64) std::atomic<u64> Sequence;   // Odd while a publish is in progress
+        std::atomic<u64> PackedRegisters;
+        std::atomic<u64> Cycles;
+    };
+    static_assert(std::atomic<u64>::is_always_lock_free, "the seqlock must not depend on a process local lock");
+    static_assert(sizeof(Header) <= MEM_OFFSET);
+
+    std::string Name;
+    Byte* Segment = nullptr;
+    Header* Shared = nullptr;
+    Mem* Memory = nullptr;
+
+    // Throws std::system_error if the segment cannot be created
+    explicit SharedMachine(std::string Name);
+    ~SharedMachine();
+
+    SharedMachine(const SharedMachine&) = delete;
+    SharedMachine& operator=(const SharedMachine&) = delete;
+
+    // Emulation thread only, Cycles is whatever count the host keeps (e.g. Pacer::Machine::Cycles)
+    void Publish(const CPU& cpu, u64 Cycles);
+
+    static u64 Pack(const CPU& cpu)
+    {
+        return cpu.PC | ((u64)cpu.SP << 16) | ((u64)cpu.A << 24) | ((u64)cpu.X << 32) | ((u64)cpu.Y << 40)
+               | ((u64)cpu.PS << 48) | ((u64)cpu.Jammed << 56);
+    }
+};
+
+struct m6502::SharedMachineView
+{
+    Byte* Segment = nullptr;
+    const SharedMachine::Header* Shared = nullptr;
+    const Byte* Data = nullptr;     // Mem::Data of the owner, MAX_MEM bytes
+
+    // Throws std::system_error if the segment cannot be mapped, std::runtime_error if it is not a machine
+    explicit SharedMachineView(const std::string& Name);
+    ~SharedMachineView();
+
+    SharedMachineView(const SharedMachineView&) = delete;
+    SharedMachineView& operator=(const SharedMachineView&) = delete;
+
+    /*
+     * Read the last published registers
+     *  - Never blocks the writer, retries while a publish overlaps the read
+     *  - @return false if every one of Tries overlapped a publish
+     */
+    bool Read(SharedMachine::Registers& Out, u32 Tries = 1000) const;
+};
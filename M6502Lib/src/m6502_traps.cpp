@@ -0,0 +1,13 @@
+#include "m6502_traps.h"
+
+void m6502::TrapTable::Add(Word Address, Handler Native)
+{
+    Handlers[Address] = std::move(Native);
+    Bitmap[Address >> 6] |= 1ull << (Address & 63);
+}
+
+void m6502::TrapTable::Remove(Word Address)
+{
+    Handlers.erase(Address);
+    Bitmap[Address >> 6] &= ~(1ull << (Address & 63));
+}
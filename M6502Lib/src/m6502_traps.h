@@ -0,0 +1,46 @@
+/*
+ * High level emulation traps
+ *
+ * A native function registered for an address runs in place of the guest
+ * subroutine there whenever a JSR targets it. The function sees the CPU
+ * and memory as the subroutine would (PC already on the instruction after
+ * the JSR, nothing pushed) and returns the cycles to charge for the body
+ * and its RTS. The JSR's own 6 cycles are charged as usual.
+ *
+ * Cost: with no table attached JSR only tests CPU::Traps, with one it
+ * tests a bit in the table's bitmap. No other instruction looks at traps.
+ */
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include "m6502.h"
+
+namespace m6502
+{
+    struct TrapTable;
+}
+
+struct m6502::TrapTable
+{
+    // @return the cycles the replaced routine would have taken, RTS included
+    using Handler = std::function<s32(CPU&, Mem&)>;
+
+    u64 Bitmap[Mem::MAX_MEM / 64] = {};
+    std::unordered_map<Word, Handler> Handlers;
+
+    void Add(Word Address, Handler Native);
+
+    void Remove(Word Address);
+
+    bool Contains(Word Address) const
+    {
+        return (Bitmap[Address >> 6] >> (Address & 63)) & 1;
+    }
+
+    // Run the handler for Address, which must be Contains()
+    s32 Run(Word Address, CPU& cpu, Mem& memory) const
+    {
+        return Handlers.find(Address)->second(cpu, memory);
+    }
+};
@@ -0,0 +1,155 @@
+/*
+ * Minimal streaming JSON reader
+ *
+ * Walks a memory mapped buffer in place, no DOM and no allocation. Only
+ * what the single step test files need: objects, arrays, integers and
+ * strings without escapes. Errors clear Ok and every read after that
+ * returns a default value, so callers only have to check Ok at the end of
+ * each case.
+ */
+#pragma once
+
+#include <cstring>
+#include <string_view>
+
+namespace m6502tests
+{
+    struct JsonCursor
+    {
+        const char* P;
+        const char* End;
+        bool Ok = true;
+
+        JsonCursor(const char* Begin, const char* End) : P(Begin), End(End) {}
+
+        void SkipWhitespace()
+        {
+            while (P < End && (*P == ' ' || *P == '\n' || *P == '\r' || *P == '\t'))
+            {
+                P++;
+            }
+        }
+
+        // @return true and skip the character if it is next
+        bool Consume(char C)
+        {
+            SkipWhitespace();
+            if (P < End && *P == C)
+            {
+                P++;
+                return true;
+            }
+            return false;
+        }
+
+        void Expect(char C)
+        {
+            if (!Consume(C))
+            {
+                Ok = false;
+                P = End;
+            }
+        }
+
+        bool AtEnd()
+        {
+            SkipWhitespace();
+            return P >= End;
+        }
+
+        long Number()
+        {
+            SkipWhitespace();
+            bool Negative = false;
+            if (P < End && *P == '-')
+            {
+                Negative = true;
+                P++;
+            }
+            if (P >= End || *P < '0' || *P > '9')
+            {
+                Ok = false;
+                P = End;
+                return 0;
+            }
+            long Value = 0;
+            while (P < End && *P >= '0' && *P <= '9')
+            {
+                Value = Value * 10 + (*P - '0');
+                P++;
+            }
+            return Negative ? -Value : Value;
+        }
+
+        std::string_view String()
+        {
+            Expect('"');
+            const char* Begin = P;
+            const char* Quote = (const char*)memchr(P, '"', End - P);
+            if (!Quote)
+            {
+                Ok = false;
+                P = End;
+                return {};
+            }
+            P = Quote + 1;
+            return std::string_view(Begin, Quote - Begin);
+        }
+
+        // Object key followed by its colon
+        std::string_view Key()
+        {
+            std::string_view Name = String();
+            Expect(':');
+            return Name;
+        }
+
+        // Skip over any value, used for keys the runner does not care about
+        void SkipValue()
+        {
+            SkipWhitespace();
+            if (P >= End)
+            {
+                Ok = false;
+                return;
+            }
+            if (*P == '"')
+            {
+                String();
+            }
+            else if (*P == '{' || *P == '[')
+            {
+                int Depth = 0;
+                bool InString = false;
+                for (; P < End; P++)
+                {
+                    if (InString)
+                    {
+                        InString = *P != '"';
+                    }
+                    else if (*P == '"')
+                    {
+                        InString = true;
+                    }
+                    else if (*P == '{' || *P == '[')
+                    {
+                        Depth++;
+                    }
+                    else if ((*P == '}' || *P == ']') && --Depth == 0)
+                    {
+                        P++;
+                        return;
+                    }
+                }
+                Ok = false;
+            }
+            else
+            {
+                while (P < End && *P != ',' && *P != '}' && *P != ']')
+                {
+                    P++;
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,204 @@
+/*
+ * Runner for the ProcessorTests single step corpus
+ * https://github.com/SingleStepTests/65x02 (one JSON file per opcode)
+ *
+ *  M6502ProcessorTests [-j threads] [-v] [-c] <directory or files...>
+ *
+ * -c runs the core as a 65C02 for the wdc65c02 set, the default is NMOS.
+ *
+ * Files are memory mapped and parsed case by case without building a DOM,
+ * and spread over a pool of threads. Each case is set up by poking only the
+ * listed RAM addresses, run for one instruction, checked, replayed a tick
+ * at a time against the recorded bus cycles, and the touched addresses are
+ * cleared again, so memory is never Initialise()d per case.
+ *
+ * Files whose opcode the core does not implement yet (the first case jams)
+ * are reported as skipped rather than failed.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "single_step.h"
+
+using namespace m6502;
+using namespace m6502tests;
+
+namespace
+{
+    enum class FileResult
+    {
+        Passed, Failed, Skipped, Error
+    };
+
+    struct FileSummary
+    {
+        std::string Path;
+        FileResult Result = FileResult::Passed;
+        long Cases = 0;
+        long Failures = 0;
+        std::string FirstFailure = {};
+    };
+
+    bool Verbose = false;
+    bool Cmos = false;
+
+    void RunFile(FileSummary& Summary, CPU& cpu, Mem& memory)
+    {
+        const int Fd = open(Summary.Path.c_str(), O_RDONLY);
+        struct stat Info;
+        if (Fd < 0 || fstat(Fd, &Info) != 0)
+        {
+            Summary.Result = FileResult::Error;
+            Summary.FirstFailure = strerror(errno);
+            if (Fd >= 0)
+            {
+                close(Fd);
+            }
+            return;
+        }
+        if (Info.st_size == 0)
+        {
+            close(Fd);
+            return;
+        }
+        void* Mapping = mmap(nullptr, Info.st_size, PROT_READ, MAP_PRIVATE, Fd, 0);
+        close(Fd);
+        if (Mapping == MAP_FAILED)
+        {
+            Summary.Result = FileResult::Error;
+            Summary.FirstFailure = strerror(errno);
+            return;
+        }
+        madvise(Mapping, Info.st_size, MADV_SEQUENTIAL);
+
+        const char* Begin = (const char*)Mapping;
+        JsonCursor Json(Begin, Begin + Info.st_size);
+        TestCase Case;
+        Json.Expect('[');
+        while (Json.Ok && ParseCase(Json, Case))
+        {
+            const std::string Failure = RunCase(Case, cpu, memory, Cmos);
+            Summary.Cases++;
+            if (Failure == "unsupported opcode" && Summary.Cases == 1)
+            {
+                Summary.Result = FileResult::Skipped;
+                break;
+            }
+            if (!Failure.empty())
+            {
+                if (Summary.Failures++ == 0)
+                {
+                    Summary.FirstFailure = std::string(Case.Name) + ": " + Failure;
+                }
+                if (Verbose)
+                {
+                    fprintf(stderr, "%s [%.*s] %s\n", Summary.Path.c_str(), (int)Case.Name.size(), Case.Name.data(), Failure.c_str());
+                }
+            }
+        }
+        if (!Json.Ok)
+        {
+            Summary.Result = FileResult::Error;
+            Summary.FirstFailure = "parse error at offset " + std::to_string(Json.P - Begin);
+        }
+        else if (Summary.Failures > 0)
+        {
+            Summary.Result = FileResult::Failed;
+        }
+        munmap(Mapping, Info.st_size);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned NumThreads = std::thread::hardware_concurrency();
+    std::vector<FileSummary> Files;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            NumThreads = (unsigned)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-v") == 0)
+        {
+            Verbose = true;
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            Cmos = true;
+        }
+        else if (std::filesystem::is_directory(argv[i]))
+        {
+            for (const auto& Entry : std::filesystem::directory_iterator(argv[i]))
+            {
+                if (Entry.path().extension() == ".json")
+                {
+                    Files.push_back({ Entry.path().string() });
+                }
+            }
+        }
+        else
+        {
+            Files.push_back({ argv[i] });
+        }
+    }
+    if (Files.empty())
+    {
+        fprintf(stderr, "Usage: %s [-j threads] [-v] [-c] <directory or files...>\n", argv[0]);
+        return 2;
+    }
+    NumThreads = std::max(1u, std::min<unsigned>(NumThreads, Files.size()));
+
+    const auto Start = std::chrono::steady_clock::now();
+    std::atomic<size_t> NextFile{ 0 };
+    std::vector<std::thread> Workers;
+    for (unsigned i = 0; i < NumThreads; i++)
+    {
+        Workers.emplace_back([&]
+        {
+            auto memory = std::make_unique<Mem>();
+            memory->Initialise();
+            CPU cpu;
+            cpu.ThrowOnIllegalOpcode = false;
+            for (size_t Index = NextFile++; Index < Files.size(); Index = NextFile++)
+            {
+                RunFile(Files[Index], cpu, *memory);
+            }
+        });
+    }
+    for (std::thread& Worker : Workers)
+    {
+        Worker.join();
+    }
+    const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+    long Cases = 0, Failures = 0, Skipped = 0, Errors = 0;
+    for (const FileSummary& Summary : Files)
+    {
+        Cases += Summary.Cases;
+        Failures += Summary.Failures;
+        Skipped += Summary.Result == FileResult::Skipped;
+        Errors += Summary.Result == FileResult::Error;
+        if (Summary.Result == FileResult::Failed || Summary.Result == FileResult::Error)
+        {
+            printf("FAIL %s (%ld/%ld) %s\n", Summary.Path.c_str(), Summary.Failures, Summary.Cases, Summary.FirstFailure.c_str());
+        }
+    }
+    printf("%zu files (%ld skipped), %ld cases, %ld failures, %ld errors in %.2f s on %u threads\n",
+           Files.size(), Skipped, Cases, Failures, Errors, Elapsed.count(), NumThreads);
+    return (Failures == 0 && Errors == 0) ? 0 : 1;
+}
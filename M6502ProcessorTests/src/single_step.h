@@ -0,0 +1,238 @@
+/*
+ * One case of the ProcessorTests single step corpus: parsing and running it
+ *
+ * Kept apart from the runner's file handling and threads so that the
+ * tests can feed it a small checked-in fixture.
+ */
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../../M6502Lib/src/m6502.h"
+#include "json_cursor.h"
+
+namespace m6502tests
+{
+    using m6502::Byte;
+    using m6502::Word;
+    using m6502::s32;
+    using m6502::u64;
+    using m6502::CPU;
+    using m6502::CPUVariant;
+    using m6502::Mem;
+
+    struct RamEntry
+    {
+        Word Address;
+        Byte Value;
+    };
+
+    struct BusCycle
+    {
+        Word Address;
+        Byte Value;
+        bool Write;
+    };
+
+    struct MachineState
+    {
+        Word PC;
+        Byte SP, A, X, Y, PS;
+        std::vector<RamEntry> Ram;
+    };
+
+    struct TestCase
+    {
+        std::string_view Name;
+        MachineState Initial;
+        MachineState Final;
+        std::vector<BusCycle> Cycles;
+    };
+
+    inline void ParseState(JsonCursor& Json, MachineState& State)
+    {
+        State.Ram.clear();
+        Json.Expect('{');
+        do
+        {
+            const std::string_view Key = Json.Key();
+            if (Key == "ram")
+            {
+                Json.Expect('[');
+                if (!Json.Consume(']'))
+                {
+                    do
+                    {
+                        Json.Expect('[');
+                        const Word Address = (Word)Json.Number();
+                        Json.Expect(',');
+                        const Byte Value = (Byte)Json.Number();
+                        Json.Expect(']');
+                        State.Ram.push_back({ Address, Value });
+                    } while (Json.Ok && Json.Consume(','));
+                    Json.Expect(']');
+                }
+            }
+            else if (Key == "pc") State.PC = (Word)Json.Number();
+            else if (Key == "s") State.SP = (Byte)Json.Number();
+            else if (Key == "a") State.A = (Byte)Json.Number();
+            else if (Key == "x") State.X = (Byte)Json.Number();
+            else if (Key == "y") State.Y = (Byte)Json.Number();
+            else if (Key == "p") State.PS = (Byte)Json.Number();
+            else Json.SkipValue();
+        } while (Json.Ok && Json.Consume(','));
+        Json.Expect('}');
+    }
+
+    inline void ParseCycles(JsonCursor& Json, std::vector<BusCycle>& Cycles)
+    {
+        Cycles.clear();
+        Json.Expect('[');
+        if (Json.Consume(']'))
+        {
+            return;
+        }
+        do
+        {
+            Json.Expect('[');
+            const Word Address = (Word)Json.Number();
+            Json.Expect(',');
+            const Byte Value = (Byte)Json.Number();
+            Json.Expect(',');
+            const bool Write = Json.String() == "write";
+            Json.Expect(']');
+            Cycles.push_back({ Address, Value, Write });
+        } while (Json.Ok && Json.Consume(','));
+        Json.Expect(']');
+    }
+
+    // @return false at the end of the top level array
+    inline bool ParseCase(JsonCursor& Json, TestCase& Case)
+    {
+        if (Json.Consume(']'))
+        {
+            return false;
+        }
+        Json.Consume(',');
+        Json.Expect('{');
+        do
+        {
+            const std::string_view Key = Json.Key();
+            if (Key == "name") Case.Name = Json.String();
+            else if (Key == "initial") ParseState(Json, Case.Initial);
+            else if (Key == "final") ParseState(Json, Case.Final);
+            else if (Key == "cycles") ParseCycles(Json, Case.Cycles);
+            else Json.SkipValue();
+        } while (Json.Ok && Json.Consume(','));
+        Json.Expect('}');
+        return Json.Ok;
+    }
+
+    /*
+     * Run one case and compare the result.
+     * @Cmos Run the core as a 65C02, otherwise NMOS
+     * @return an empty string on success, otherwise what went wrong
+     */
+    inline std::string RunCase(const TestCase& Case, CPU& cpu, Mem& memory, bool Cmos)
+    {
+        for (const RamEntry& Entry : Case.Initial.Ram)
+        {
+            memory[Entry.Address] = Entry.Value;
+        }
+        for (u64& Bits : memory.DirtyPages)
+        {
+            Bits = 0;
+        }
+        cpu.PC = Case.Initial.PC;
+        cpu.SP = Case.Initial.SP;
+        cpu.A = Case.Initial.A;
+        cpu.X = Case.Initial.X;
+        cpu.Y = Case.Initial.Y;
+        cpu.PS = Case.Initial.PS;
+        cpu.Jammed = false;
+
+        // A budget of one cycle runs exactly one instruction
+        const s32 CyclesUsed = Cmos ? cpu.Execute<CPUVariant::CMOS65C02>(1, memory) : cpu.Execute(1, memory);
+
+        char Buffer[128];
+        std::string Failure;
+        if (cpu.Jammed)
+        {
+            Failure = "unsupported opcode";
+        }
+        else if (CyclesUsed != (s32)Case.Cycles.size())
+        {
+            snprintf(Buffer, sizeof(Buffer), "cycles %d, expected %zu", CyclesUsed, Case.Cycles.size());
+            Failure = Buffer;
+        }
+        else if (cpu.PC != Case.Final.PC || cpu.SP != Case.Final.SP || cpu.A != Case.Final.A
+            || cpu.X != Case.Final.X || cpu.Y != Case.Final.Y || cpu.PS != Case.Final.PS)
+        {
+            snprintf(Buffer, sizeof(Buffer), "registers PC=%04X SP=%02X A=%02X X=%02X Y=%02X P=%02X, expected PC=%04X SP=%02X A=%02X X=%02X Y=%02X P=%02X",
+                     cpu.PC, cpu.SP, cpu.A, cpu.X, cpu.Y, cpu.PS,
+                     Case.Final.PC, Case.Final.SP, Case.Final.A, Case.Final.X, Case.Final.Y, Case.Final.PS);
+            Failure = Buffer;
+        }
+        else
+        {
+            for (const RamEntry& Entry : Case.Final.Ram)
+            {
+                if (memory[Entry.Address] != Entry.Value)
+                {
+                    snprintf(Buffer, sizeof(Buffer), "ram[%04X]=%02X, expected %02X", Entry.Address, memory[Entry.Address], Entry.Value);
+                    Failure = Buffer;
+                    break;
+                }
+            }
+        }
+
+        // Then again a cycle at a time, each tick must make the bus cycle the corpus recorded
+        if (Failure.empty())
+        {
+            for (const RamEntry& Entry : Case.Final.Ram)
+            {
+                memory[Entry.Address] = 0;
+            }
+            for (const RamEntry& Entry : Case.Initial.Ram)
+            {
+                memory[Entry.Address] = Entry.Value;
+            }
+            cpu.PC = Case.Initial.PC;
+            cpu.SP = Case.Initial.SP;
+            cpu.A = Case.Initial.A;
+            cpu.X = Case.Initial.X;
+            cpu.Y = Case.Initial.Y;
+            cpu.PS = Case.Initial.PS;
+            cpu.Micro = {};
+            cpu.TickCyclesLeft = 0;
+            for (size_t i = 0; i < Case.Cycles.size(); i++)
+            {
+                Cmos ? cpu.Tick<CPUVariant::CMOS65C02>(memory) : cpu.Tick(memory);
+                const BusCycle& Expected = Case.Cycles[i];
+                if (cpu.Bus.Address != Expected.Address || cpu.Bus.Data != Expected.Value || cpu.Bus.Write != Expected.Write)
+                {
+                    snprintf(Buffer, sizeof(Buffer), "bus cycle %zu: %04X %02X %s, expected %04X %02X %s", i,
+                             cpu.Bus.Address, cpu.Bus.Data, cpu.Bus.Write ? "write" : "read",
+                             Expected.Address, Expected.Value, Expected.Write ? "write" : "read");
+                    Failure = Buffer;
+                    break;
+                }
+            }
+        }
+
+        // Put memory back the way it was before the case
+        for (const RamEntry& Entry : Case.Initial.Ram)
+        {
+            memory[Entry.Address] = 0;
+        }
+        for (const RamEntry& Entry : Case.Final.Ram)
+        {
+            memory[Entry.Address] = 0;
+        }
+        memory.ClearDirty();
+        return Failure;
+    }
+}
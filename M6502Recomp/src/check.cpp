@@ -0,0 +1,150 @@
+/*
+ * Recompiled workloads against the interpreter
+ *
+ *  M6502RecompCheck [cycles]
+ *
+ * Runs every workload (see workloads.h) on CPU::Execute and on its
+ * recompiled function side by side, for a range of slice budgets, and
+ * compares the cycles used and registers after every slice and the whole
+ * memory at the end. The mixed workload also runs with an I/O window
+ * that stops the slice on each write. Then reports emulated MHz of both.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "workloads.h"
+
+using namespace m6502;
+
+// Generated by M6502Recomp at build time
+s32 Run_copy(CPU& cpu, Mem& memory, s32 Cycles);
+s32 Run_mixed(CPU& cpu, Mem& memory, s32 Cycles);
+s32 Run_call(CPU& cpu, Mem& memory, s32 Cycles);
+
+namespace
+{
+    using RecompiledFn = s32 (*)(CPU&, Mem&, s32);
+
+    struct Entry
+    {
+        const char* Name;
+        RecompiledFn Run;
+    };
+
+    const Entry RECOMPILED[] =
+    {
+        { "copy", Run_copy },
+        { "mixed", Run_mixed },
+        { "call", Run_call },
+    };
+
+    // Device registers at $4000-$4FFF, writes land in Data but stop the slice
+    struct IoWindow : Mapper
+    {
+        void Write(Mem& memory, Word Address, Byte Value) override
+        {
+            memory.StoreData(Address, Value);
+            memory.MarkDirty(Address);
+        }
+    };
+
+    struct Machine
+    {
+        std::unique_ptr<Mem> Memory = std::make_unique<Mem>();
+        CPU Cpu;
+        IoWindow Io;
+
+        Machine(const Workload& Work, bool WithIo)
+        {
+            Cpu.Reset(WORKLOAD_BASE, *Memory);
+            Cpu.ThrowOnIllegalOpcode = false;
+            Memory->Load(WORKLOAD_BASE, Work.Image.data(), (u32)Work.Image.size());
+            if (WithIo)
+            {
+                Memory->MapWindow(0x4000 >> Mem::WINDOW_SHIFT, Memory->Data + 0x4000, nullptr);
+                Memory->AttachedMapper = &Io;
+                Cpu.StopOnMapperWrite = true;
+            }
+        }
+    };
+
+    bool SameState(const CPU& A, const CPU& B)
+    {
+        return A.PC == B.PC && A.SP == B.SP && A.A == B.A && A.X == B.X && A.Y == B.Y && A.PS == B.PS
+            && A.Jammed == B.Jammed && A.Stopped == B.Stopped;
+    }
+
+    bool Compare(const Workload& Work, RecompiledFn Run, bool WithIo, s32 Budget, u32 Slices)
+    {
+        Machine Interpreted(Work, WithIo), Recompiled(Work, WithIo);
+        for (u32 Slice = 0; Slice < Slices; Slice++)
+        {
+            const s32 Expected = Interpreted.Cpu.Execute(Budget, *Interpreted.Memory);
+            const s32 Actual = Run(Recompiled.Cpu, *Recompiled.Memory, Budget);
+            if (Expected != Actual || !SameState(Interpreted.Cpu, Recompiled.Cpu))
+            {
+                printf("%s%s: budget %d, slice %u: %d cycles at PC $%04X, recompiled %d at PC $%04X\n",
+                       Work.Name, WithIo ? " (io)" : "", Budget, Slice, Expected, Interpreted.Cpu.PC, Actual, Recompiled.Cpu.PC);
+                return false;
+            }
+            if (Interpreted.Cpu.Jammed)
+            {
+                break;
+            }
+        }
+        if (memcmp(Interpreted.Memory->Data, Recompiled.Memory->Data, Mem::MAX_MEM) != 0)
+        {
+            printf("%s%s: budget %d: memory differs\n", Work.Name, WithIo ? " (io)" : "", Budget);
+            return false;
+        }
+        return true;
+    }
+
+    template <typename RunFn>
+    double Measure(const Workload& Work, s32 Cycles, RunFn Run)
+    {
+        constexpr s32 SLICE = 100000;
+        Machine M(Work, false);
+        s32 Used = 0;
+        const auto Begin = std::chrono::steady_clock::now();
+        while (Used < Cycles && !M.Cpu.Jammed)
+        {
+            Used += Run(M.Cpu, *M.Memory, SLICE);
+        }
+        const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Begin;
+        return Used / Elapsed.count() / 1e6;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const s32 Cycles = argc > 1 ? atoi(argv[1]) : 100000000;
+    const s32 BUDGETS[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 17, 29, 64, 100, 1000, 12345 };
+
+    bool AllSame = true;
+    for (const Entry& Recompiled : RECOMPILED)
+    {
+        const Workload& Work = *FindWorkload(Recompiled.Name);
+        u32 Runs = 0;
+        for (const bool WithIo : { false, true })
+        {
+            if (WithIo && strcmp(Work.Name, "mixed") != 0)
+            {
+                continue;
+            }
+            for (const s32 Budget : BUDGETS)
+            {
+                AllSame &= Compare(Work, Recompiled.Run, WithIo, Budget, 2000);
+                Runs++;
+            }
+        }
+        const double InterpretedMhz = Measure(Work, Cycles, [](CPU& cpu, Mem& memory, s32 Budget) { return cpu.Execute(Budget, memory); });
+        const double RecompiledMhz = Measure(Work, Cycles, Recompiled.Run);
+        printf("%-6s %2u budgets checked  Execute %8.1f MHz  recompiled %8.1f MHz  %.2fx\n",
+               Work.Name, Runs, InterpretedMhz, RecompiledMhz, RecompiledMhz / InterpretedMhz);
+    }
+    printf(AllSame ? "recompiled code matches the interpreter\n" : "MISMATCH\n");
+    return AllSame ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/*
+ * Writes a workload's image for the recompiler
+ *
+ *  M6502RecompImages <workload> <out.bin>
+ */
+#include <cstdio>
+#include <fstream>
+#include "workloads.h"
+
+int main(int argc, char** argv)
+{
+    const m6502::Workload* Found = argc == 3 ? m6502::FindWorkload(argv[1]) : nullptr;
+    if (!Found)
+    {
+        fprintf(stderr, "Usage: %s <workload> <out.bin>\n", argv[0]);
+        return 2;
+    }
+    std::ofstream Out(argv[2], std::ios::binary);
+    Out.write((const char*)Found->Image.data(), Found->Image.size());
+    return Out ? 0 : 1;
+}
@@ -0,0 +1,586 @@
+/*
+ * Ahead of time recompiler from 6502 binaries to C++
+ *
+ *  M6502Recomp [-b load address] [-e entry]... [-r start-end]...
+ *              [-smc start-end]... [-n function] [-o out.cpp] <image.bin>
+ *
+ *  M6502Recomp -b C000 -e C000 -r C000-DFFF -n RunRom -o rom.cpp rom.bin
+ *
+ * Maps the code of a fixed image with CodeMap from its entry points (by
+ * default the reset vector when the image holds it, otherwise its start)
+ * through the code regions (-r, by default the whole image) and emits one
+ * C++ function with a native block for each basic block found:
+ *
+ *  m6502::s32 Function(m6502::CPU& cpu, m6502::Mem& memory, m6502::s32 Cycles);
+ *
+ * It is a drop in for CPU::Execute (NMOS) on a memory holding the same
+ * image: same registers, memory, cycles used and stops, slice for slice.
+ *  - A block runs natively only when the budget covers all of it, so it
+ *    can skip the per instruction budget check. Near the end of a slice,
+ *    and at every PC that is not a block, single instructions go to
+ *    CPU::Execute
+ *  - JMP (indirect) always goes to CPU::Execute, and so do JSR and RTS
+ *    while a trap table, a profiler or a CPU::Call needs to see them
+ *  - Stores still go through CPU::WriteByte, so mappers, dirty pages
+ *    and StopOnMapperWrite behave as in the interpreter
+ *  - Code a static store can reach, and the -smc regions, is never
+ *    compiled. Stores through (zp,X) and (zp),Y cannot be followed, list
+ *    the code they patch with -smc
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_disasm.h"
+#include "../../M6502Lib/src/m6502_opcodes.h"
+
+using namespace m6502;
+
+namespace
+{
+    using Mode = AddressingMode;
+    using Kind = OpcodeKind;
+    using OpInfo = OpcodeInfo;
+
+    struct Instruction
+    {
+        Word Address;
+        const OpInfo* Info;
+        Word Operand;
+
+        Word Next() const
+        {
+            return (Word)(Address + Info->Length());
+        }
+
+        std::string Format() const
+        {
+            char Text[32];
+            Info->Format(Operand, Text, sizeof(Text));
+            return Text;
+        }
+    };
+
+    struct Region
+    {
+        u32 Start, End;     // End is exclusive
+    };
+
+    bool ParseRegion(const char* Text, Region& Out)
+    {
+        char* Dash;
+        Out.Start = (u32)strtoul(Text, &Dash, 16);
+        if (*Dash != '-')
+        {
+            return false;
+        }
+        Out.End = (u32)strtoul(Dash + 1, nullptr, 16) + 1;
+        return Out.Start < Out.End && Out.End <= Mem::MAX_MEM;
+    }
+
+    // Longer blocks are split, so the budget check stays close to the interpreter's
+    constexpr u32 MAX_BLOCK_INSTRUCTIONS = 64;
+
+    struct Block
+    {
+        Word Start;
+        std::vector<Instruction> Body;
+        // How the block ends when its last instruction does not transfer control
+        enum class Exit : Byte { Transfer, Interpret } End = Exit::Transfer;
+        Word ExitPC = 0;
+    };
+
+    struct Program
+    {
+        Word Base;
+        std::vector<Byte> Image;
+        std::vector<Region> CodeRegions;
+        std::vector<bool> Code = std::vector<bool>(Mem::MAX_MEM);   // Inside a code region
+        std::vector<bool> Patched = std::vector<bool>(Mem::MAX_MEM); // Never compiled
+        CodeMap Map;
+        std::map<Word, Block> Blocks;
+        bool IndirectStores = false;
+
+        bool InImage(u32 Address) const
+        {
+            return Address >= Base && Address < Base + Image.size();
+        }
+
+        Byte At(u32 Address) const
+        {
+            return Image[Address - Base];
+        }
+
+        /*
+         * Cut the image into blocks with CodeMap, as the disassembler does, so the
+         * two cannot disagree on what is code. Bytes outside the code regions and
+         * patched code are excluded from its blocks
+         */
+        void Analyse(const std::vector<Word>& Entries)
+        {
+            std::vector<Byte> Memory(Mem::MAX_MEM);
+            std::copy(Image.begin(), Image.end(), Memory.begin() + Base);
+            Map.MaxBlockInstructions = MAX_BLOCK_INSTRUCTIONS;
+            Map.Excluded.assign(Mem::MAX_MEM, false);
+            for (u32 i = 0; i < Mem::MAX_MEM; i++)
+            {
+                Map.Excluded[i] = !Code[i] || Patched[i];
+            }
+            Map.Analyse(Memory.data(), Entries, CPUVariant::NMOS6502, Base, Base + (u32)Image.size());
+
+            Blocks.clear();
+            for (const CodeMap::Block& Mapped : Map.Blocks)
+            {
+                Block New;
+                New.Start = Mapped.Start;
+                u32 PC = Mapped.Start;
+                for (u32 i = 0; i < Mapped.Instructions; i++)
+                {
+                    const OpInfo* Info = OpcodeInfo::Decode(At(PC));
+                    const u32 Size = Info->Length();
+                    const Word Operand = Size == 1 ? 0 : Size == 2 ? At(PC + 1) : At(PC + 1) | (At(PC + 2) << 8);
+                    New.Body.push_back({ (Word)PC, Info, Operand });
+                    PC += Size;
+                }
+                // It stops before code it cannot compile, the interpreter takes over there
+                if (Mapped.EndsIllegal || Mapped.EndsExcluded)
+                {
+                    New.End = Block::Exit::Interpret;
+                    New.ExitPC = (Word)PC;
+                }
+                Blocks[New.Start] = std::move(New);
+            }
+        }
+
+        // Mark code bytes that a store we can see may write to
+        u32 FindPatchedCode()
+        {
+            std::vector<bool> Written(Mem::MAX_MEM);
+            for (const auto& [Start, Blk] : Blocks)
+            {
+                for (const Instruction& Ins : Blk.Body)
+                {
+                    if (Ins.Info->Type == Kind::Jsr)
+                    {
+                        // The return address goes to the stack
+                        for (u32 i = 0x100; i < 0x200; i++)
+                        {
+                            Written[i] = true;
+                        }
+                    }
+                    if (Ins.Info->Type != Kind::Store)
+                    {
+                        continue;
+                    }
+                    switch (Ins.Info->AddrMode)
+                    {
+                        case Mode::Zp: case Mode::Abs:
+                            Written[Ins.Operand] = true;
+                            break;
+                        case Mode::ZpX: case Mode::ZpY:
+                            for (u32 i = 0; i < 0x100; i++)
+                            {
+                                Written[i] = true;
+                            }
+                            break;
+                        case Mode::AbsX: case Mode::AbsY:
+                            for (u32 i = 0; i < 0x100; i++)
+                            {
+                                Written[(Word)(Ins.Operand + i)] = true;
+                            }
+                            break;
+                        default:
+                            IndirectStores = true;
+                            break;
+                    }
+                }
+            }
+            u32 Count = 0;
+            for (const auto& [Start, Blk] : Blocks)
+            {
+                for (const Instruction& Ins : Blk.Body)
+                {
+                    for (u32 i = 0; i < Ins.Info->Length(); i++)
+                    {
+                        const Word Part = (Word)(Ins.Address + i);
+                        if (Written[Part] && !Patched[Part])
+                        {
+                            Patched[Part] = true;
+                            Count++;
+                        }
+                    }
+                }
+            }
+            return Count;
+        }
+    };
+
+    /*
+     * Code generation
+     */
+
+    std::string Hex(u32 Value, int Digits = 4)
+    {
+        char Text[16];
+        snprintf(Text, sizeof(Text), "0x%0*X", Digits, Value);
+        return Text;
+    }
+
+    std::string Label(Word Address)
+    {
+        char Text[16];
+        snprintf(Text, sizeof(Text), "B_%04X", Address);
+        return Text;
+    }
+
+    struct Emitter
+    {
+        const Program& Prog;
+        std::string Out;
+
+        explicit Emitter(const Program& Prog) : Prog(Prog)
+        {
+        }
+
+        void Line(const std::string& Text, int Indent = 1)
+        {
+            Out.append(Indent * 4, ' ');
+            Out += Text;
+            Out += '\n';
+        }
+
+        // Jump to the block at Target, with cpu.PC already set
+        std::string GotoBlock(Word Target) const
+        {
+            return Prog.Blocks.count(Target) ? "goto " + Label(Target) + ";" : "goto Dispatch;";
+        }
+
+        // The effective address of an indexed or indirect operand, as a C++ expression
+        std::string EffectiveAddress(const Instruction& Ins) const
+        {
+            const std::string Operand = Hex(Ins.Operand, 2);
+            switch (Ins.Info->AddrMode)
+            {
+                case Mode::Zp: return Hex(Ins.Operand, 2);
+                case Mode::Abs: return Hex(Ins.Operand);
+                case Mode::ZpX: return "(Byte)(" + Operand + " + cpu.X)";
+                case Mode::ZpY: return "(Byte)(" + Operand + " + cpu.Y)";
+                case Mode::AbsX: return "(Word)(" + Hex(Ins.Operand) + " + cpu.X)";
+                case Mode::AbsY: return "(Word)(" + Hex(Ins.Operand) + " + cpu.Y)";
+                case Mode::IndX: return "(Word)(memory[(Byte)(" + Operand + " + cpu.X)] | (memory[(Byte)(" + Operand + " + cpu.X + 1)] << 8))";
+                default: return "";
+            }
+        }
+
+        void Load(const Instruction& Ins)
+        {
+            const std::string Register = std::string("cpu.") + Ins.Info->Register;
+            const Mode AddrMode = Ins.Info->AddrMode;
+            if (AddrMode == Mode::Imm)
+            {
+                Line(Register + " = " + Hex(Ins.Operand, 2) + ";");
+                Line("Cycles -= 2;");
+            }
+            else if (AddrMode == Mode::AbsX || AddrMode == Mode::AbsY)
+            {
+                Line("{");
+                Line("const Word Address = " + EffectiveAddress(Ins) + ";", 2);
+                Line(Register + " = memory[Address];", 2);
+                Line("Cycles -= (Address >> 8) == " + Hex(Ins.Operand >> 8, 2) + " ? 4 : 5;", 2);
+                Line("}");
+            }
+            else if (AddrMode == Mode::IndY)
+            {
+                Line("{");
+                Line("const Word Pointer = memory[" + Hex(Ins.Operand, 2) + "] | (memory[" + Hex((Byte)(Ins.Operand + 1), 2) + "] << 8);", 2);
+                Line("const Word Address = (Word)(Pointer + cpu.Y);", 2);
+                Line(Register + " = memory[Address];", 2);
+                Line("Cycles -= ((Address ^ Pointer) >> 8) ? 6 : 5;", 2);
+                Line("}");
+            }
+            else
+            {
+                Line(Register + " = memory[" + EffectiveAddress(Ins) + "];");
+                Line("Cycles -= " + std::to_string(Ins.Info->MaxCycles) + ";");
+            }
+            Line("cpu.LoadRegisterSetStatus(" + Register + ");");
+        }
+
+        void Store(const Instruction& Ins)
+        {
+            const std::string Register = std::string("cpu.") + Ins.Info->Register;
+            // Everything before the write, WriteByte takes the last cycle
+            Line("Cycles -= " + std::to_string(Ins.Info->MaxCycles - 1) + ";");
+            if (Ins.Info->AddrMode == Mode::IndY)
+            {
+                Line("{");
+                Line("const Word Pointer = memory[" + Hex(Ins.Operand, 2) + "] | (memory[" + Hex((Byte)(Ins.Operand + 1), 2) + "] << 8);", 2);
+                Line("cpu.WriteByte(" + Register + ", Cycles, (Word)(Pointer + cpu.Y), memory);", 2);
+                Line("}");
+            }
+            else
+            {
+                Line("cpu.WriteByte(" + Register + ", Cycles, " + EffectiveAddress(Ins) + ", memory);");
+            }
+            StopCheck(Ins.Next());
+        }
+
+        // A write to a mapper may have stopped the slice
+        void StopCheck(Word Next)
+        {
+            Line("if (cpu.Stopped != CPU::StopReason::None)");
+            Line("{");
+            Line("cpu.PC = " + Hex(Next) + ";", 2);
+            Line("goto Out;", 2);
+            Line("}");
+        }
+
+        void Transfer(const Instruction& Ins)
+        {
+            switch (Ins.Info->Type)
+            {
+                case Kind::Jsr:
+                    Line("if (cpu.Traps || cpu.CallProfiler)");
+                    Line("{");
+                    Line("cpu.PC = " + Hex(Ins.Address) + ";", 2);
+                    Line("goto Interpret;", 2);
+                    Line("}");
+                    Line("cpu.PC = " + Hex(Ins.Next()) + ";");
+                    Line("Cycles -= 3;");
+                    Line("cpu.PushPCToStack(Cycles, memory);");
+                    Line("Cycles--;");
+                    StopCheck(Ins.Operand);
+                    Line("cpu.PC = " + Hex(Ins.Operand) + ";");
+                    Line(GotoBlock(Ins.Operand));
+                    break;
+                case Kind::Rts:
+                    Line("if (cpu.CallProfiler || cpu.CallReturnSP >= 0)");
+                    Line("{");
+                    Line("cpu.PC = " + Hex(Ins.Address) + ";", 2);
+                    Line("goto Interpret;", 2);
+                    Line("}");
+                    Line("Cycles -= 3;");
+                    Line("cpu.PC = cpu.PopWordFromStack(Cycles, memory) + 1;");
+                    Line("goto Dispatch;");
+                    break;
+                case Kind::Jmp:
+                    Line("Cycles -= 3;");
+                    Line("cpu.PC = " + Hex(Ins.Operand) + ";");
+                    Line(GotoBlock(Ins.Operand));
+                    break;
+                case Kind::JmpInd:
+                    Line("cpu.PC = " + Hex(Ins.Address) + ";");
+                    Line("goto Interpret;");
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void EmitBlock(const Block& Blk)
+        {
+            // Every instruction but the last must start with budget left
+            u32 Threshold = 1;
+            for (size_t i = 0; i + 1 < Blk.Body.size(); i++)
+            {
+                Threshold += Blk.Body[i].Info->MaxCycles;
+            }
+            Out += Label(Blk.Start) + ":\n";
+            Line("if (Cycles < " + std::to_string(Threshold) + ") goto Interpret;");
+            for (const Instruction& Ins : Blk.Body)
+            {
+                Line("// " + Hex(Ins.Address) + " " + Ins.Format());
+                switch (Ins.Info->Type)
+                {
+                    case Kind::Load: Load(Ins); break;
+                    case Kind::Store: Store(Ins); break;
+                    default: Transfer(Ins); break;
+                }
+            }
+            if (Blk.End == Block::Exit::Interpret)
+            {
+                Line("cpu.PC = " + Hex(Blk.ExitPC) + ";");
+                Line("goto Interpret;");
+            }
+            else if (Blk.Body.back().Info->Type == Kind::Load || Blk.Body.back().Info->Type == Kind::Store)
+            {
+                Line("cpu.PC = " + Hex(Blk.Body.back().Next()) + ";");
+                Line(GotoBlock(Blk.Body.back().Next()));
+            }
+        }
+
+        void EmitFunction(const std::string& Name, const std::string& CommandLine)
+        {
+            Out += "// Generated by M6502Recomp, do not edit\n";
+            Out += "//  " + CommandLine + "\n";
+            Out += "#include \"m6502.h\"\n\n";
+            Out += "m6502::s32 " + Name + "(m6502::CPU& cpu, m6502::Mem& memory, m6502::s32 Cycles)\n{\n";
+            Line("using namespace m6502;");
+            Line("const s32 CyclesRequested = Cycles;");
+            Line("cpu.IdleLoop.Armed = false;");
+            Line("cpu.Stopped = CPU::StopReason::None;");
+            Out += "Dispatch:\n";
+            Line("switch (cpu.PC)");
+            Line("{");
+            for (const auto& [Start, Blk] : Prog.Blocks)
+            {
+                Line("case " + Hex(Start) + ": goto " + Label(Start) + ";", 2);
+            }
+            Line("default: goto Interpret;", 2);
+            Line("}");
+            for (const auto& [Start, Blk] : Prog.Blocks)
+            {
+                EmitBlock(Blk);
+            }
+            Out += "Interpret:\n";
+            Line("if (Cycles <= 0) goto Out;");
+            Line("Cycles -= cpu.Execute(1, memory);");
+            Line("if (cpu.Jammed || cpu.Stopped != CPU::StopReason::None) goto Out;");
+            Line("goto Dispatch;");
+            Out += "Out:\n";
+            Line("return cpu.CyclesUsed(CyclesRequested, Cycles);");
+            Out += "}\n";
+        }
+    };
+
+    void Usage(const char* Name)
+    {
+        fprintf(stderr, "Usage: %s [-b load address] [-e entry]... [-r start-end]... [-smc start-end]... "
+                        "[-n function] [-o out.cpp] <image.bin>\n", Name);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Program Prog;
+    Prog.Base = 0;
+    std::vector<Word> Entries;
+    std::vector<Region> Patches;
+    std::string Function = "RunRecompiled", OutPath, ImagePath, CommandLine = "M6502Recomp";
+    for (int i = 1; i < argc; i++)
+    {
+        CommandLine += std::string(" ") + argv[i];
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        const bool HasValue = i + 1 < argc;
+        Region Range;
+        if (strcmp(argv[i], "-b") == 0 && HasValue)
+        {
+            Prog.Base = (Word)strtoul(argv[++i], nullptr, 16);
+        }
+        else if (strcmp(argv[i], "-e") == 0 && HasValue)
+        {
+            Entries.push_back((Word)strtoul(argv[++i], nullptr, 16));
+        }
+        else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "-smc") == 0) && HasValue)
+        {
+            const bool Patch = argv[i][1] == 's';
+            if (!ParseRegion(argv[++i], Range))
+            {
+                fprintf(stderr, "bad region %s, expected hex start-end\n", argv[i]);
+                return 2;
+            }
+            (Patch ? Patches : Prog.CodeRegions).push_back(Range);
+        }
+        else if (strcmp(argv[i], "-n") == 0 && HasValue)
+        {
+            Function = argv[++i];
+        }
+        else if (strcmp(argv[i], "-o") == 0 && HasValue)
+        {
+            OutPath = argv[++i];
+        }
+        else if (argv[i][0] != '-' && ImagePath.empty())
+        {
+            ImagePath = argv[i];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+    if (ImagePath.empty())
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    std::ifstream ImageFile(ImagePath, std::ios::binary);
+    if (!ImageFile)
+    {
+        fprintf(stderr, "cannot read %s\n", ImagePath.c_str());
+        return 1;
+    }
+    Prog.Image.assign(std::istreambuf_iterator<char>(ImageFile), std::istreambuf_iterator<char>());
+    if (Prog.Image.empty() || Prog.Base + Prog.Image.size() > Mem::MAX_MEM)
+    {
+        fprintf(stderr, "%s is empty or does not fit at $%04X\n", ImagePath.c_str(), Prog.Base);
+        return 1;
+    }
+
+    if (Prog.CodeRegions.empty())
+    {
+        Prog.CodeRegions.push_back({ Prog.Base, (u32)(Prog.Base + Prog.Image.size()) });
+    }
+    for (const Region& Range : Prog.CodeRegions)
+    {
+        for (u32 i = Range.Start; i < Range.End; i++)
+        {
+            Prog.Code[i] = true;
+        }
+    }
+    for (const Region& Range : Patches)
+    {
+        for (u32 i = Range.Start; i < Range.End; i++)
+        {
+            Prog.Patched[i] = true;
+        }
+    }
+    if (Entries.empty())
+    {
+        const bool HasVector = Prog.InImage(0xFFFC) && Prog.InImage(0xFFFD);
+        Entries.push_back(HasVector ? (Word)(Prog.At(0xFFFC) | (Prog.At(0xFFFD) << 8)) : Prog.Base);
+    }
+
+    // Analysing again resumes behind patched instructions, so repeat until the
+    // blocks it finds patch no more code
+    Prog.Analyse(Entries);
+    u32 PatchedBytes = 0;
+    while (const u32 Found = Prog.FindPatchedCode())
+    {
+        PatchedBytes += Found;
+        Prog.Analyse(Entries);
+    }
+
+    Emitter Gen(Prog);
+    Gen.EmitFunction(Function, CommandLine);
+
+    u32 Instructions = 0;
+    for (const auto& [Start, Blk] : Prog.Blocks)
+    {
+        Instructions += (u32)Blk.Body.size();
+    }
+    fprintf(stderr, "%zu blocks, %u instructions compiled, %u code bytes written by stores left to the interpreter\n",
+            Prog.Blocks.size(), Instructions, PatchedBytes);
+    if (Prog.IndirectStores)
+    {
+        fprintf(stderr, "warning: indirect stores found, list any code they patch with -smc\n");
+    }
+
+    if (OutPath.empty())
+    {
+        fputs(Gen.Out.c_str(), stdout);
+        return 0;
+    }
+    std::ofstream OutFile(OutPath);
+    OutFile << Gen.Out;
+    return OutFile ? 0 : 1;
+}
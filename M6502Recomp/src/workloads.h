@@ -0,0 +1,133 @@
+/*
+ * Benchmark programs the recompiler is checked against
+ *
+ * Each one is an image loaded at WORKLOAD_BASE and entered there. They
+ * are written out by M6502RecompImages, recompiled at build time and
+ * run against the interpreter by M6502RecompCheck.
+ */
+#pragma once
+
+#include <cstring>
+#include <vector>
+#include "../../M6502Lib/src/m6502.h"
+
+namespace m6502
+{
+    struct Workload;
+
+    constexpr Word WORKLOAD_BASE = 0x0200;
+
+    const std::vector<Workload>& Workloads();
+
+    const Workload* FindWorkload(const char* Name);
+}
+
+struct m6502::Workload
+{
+    const char* Name;
+    std::vector<Byte> Image;
+};
+
+inline const std::vector<m6502::Workload>& m6502::Workloads()
+{
+    static const std::vector<Workload> ALL = []
+    {
+        std::vector<Workload> All;
+        auto Place = [](std::vector<Byte>& Image, Word Address, std::vector<Byte> Bytes)
+        {
+            const u32 Offset = Address - WORKLOAD_BASE;
+            if (Image.size() < Offset + Bytes.size())
+            {
+                Image.resize(Offset + Bytes.size());
+            }
+            memcpy(&Image[Offset], Bytes.data(), Bytes.size());
+        };
+
+        // The fused copy loop of M6502BenchFusion
+        Workload Copy{ "copy", {} };
+        Place(Copy.Image, 0x0200, {
+            CPU::INS_LDX_IM, 0x04,
+            CPU::INS_LDY_IM, 0x10,
+            CPU::INS_JSR, 0x00, 0x03,
+            CPU::INS_JMP_ABS, 0x00, 0x02 });
+        Place(Copy.Image, 0x0300, {
+            CPU::INS_LDA_IM, 0x01,
+            CPU::INS_STA_ZP, 0x20,
+            CPU::INS_LDA_IM, 0x02,
+            CPU::INS_STA_ABS, 0x00, 0x40,
+            CPU::INS_LDA_ZPX, 0x1C,
+            CPU::INS_STA_ABSY, 0x00, 0x41,
+            CPU::INS_LDA_ABS, 0x00, 0x40,
+            CPU::INS_STA_ABS, 0x01, 0x40,
+            CPU::INS_RTS });
+        All.push_back(Copy);
+
+        // Every addressing mode, page crossings, a patched operand and JMP (indirect)
+        Workload Mixed{ "mixed", {} };
+        Place(Mixed.Image, 0x0200, {
+            CPU::INS_LDA_IM, 0xF0, CPU::INS_STA_ZP, 0x20,       // ($20) = $31F0
+            CPU::INS_LDA_IM, 0x31, CPU::INS_STA_ZP, 0x21,
+            CPU::INS_LDA_IM, 0x80, CPU::INS_STA_ZP, 0x27,       // ($22,X) with X = 5 is ($27) = $4180
+            CPU::INS_LDA_IM, 0x41, CPU::INS_STA_ZP, 0x28,
+            CPU::INS_LDX_IM, 0x05,
+            CPU::INS_LDY_ZP, 0x50,
+            CPU::INS_LDA_ABSY, 0xF8, 0x30,
+            CPU::INS_STA_ABSX, 0xFF, 0x40,
+            CPU::INS_LDA_INDY, 0x20,
+            CPU::INS_STA_INDX, 0x22,
+            CPU::INS_LDA_INDX, 0x22,
+            CPU::INS_STA_INDY, 0x20,
+            CPU::INS_LDA_ZP, 0x51,
+            CPU::INS_STA_ABS, 0x28, 0x02,                       // Patches the LDY below
+            CPU::INS_LDY_IM, 0x00,
+            CPU::INS_STY_ZP, 0x50,
+            CPU::INS_JSR, 0x80, 0x02,
+            CPU::INS_JMP_IND, 0xF0, 0x02 });
+        Place(Mixed.Image, 0x0240, {
+            CPU::INS_LDX_ZP, 0x50,
+            CPU::INS_STX_ZPY, 0x52,
+            CPU::INS_LDY_ABSX, 0x00, 0x41,
+            CPU::INS_STY_ZPX, 0x60,
+            CPU::INS_LDX_ABSY, 0xF0, 0x31,
+            CPU::INS_STX_ABS, 0x00, 0x42,
+            CPU::INS_JMP_ABS, 0x00, 0x02 });
+        Place(Mixed.Image, 0x0280, {
+            CPU::INS_LDA_ZPX, 0x50,
+            CPU::INS_STA_ZP, 0x51,
+            CPU::INS_LDY_ZPX, 0x4B,
+            CPU::INS_LDX_ZPY, 0x40,
+            CPU::INS_JSR, 0xA0, 0x02,
+            CPU::INS_RTS });
+        Place(Mixed.Image, 0x02A0, {
+            CPU::INS_LDY_ABS, 0x00, 0x42,
+            CPU::INS_STY_ABS, 0x00, 0x43,
+            CPU::INS_LDA_ABSX, 0xFE, 0x40,
+            CPU::INS_STA_ZP, 0x70,
+            CPU::INS_RTS });
+        Place(Mixed.Image, 0x02F0, { 0x40, 0x02 });
+        All.push_back(Mixed);
+
+        // The routine of M6502BenchCall behind its JSR stub, which jams on return
+        Workload Call{ "call", {} };
+        Place(Call.Image, 0x0200, { CPU::INS_JSR, 0x00, 0x03, 0x02 });
+        Place(Call.Image, 0x0300, {
+            CPU::INS_LDA_ZPX, 0x10,
+            CPU::INS_STA_ABS, 0x00, 0x40,
+            CPU::INS_RTS });
+        All.push_back(Call);
+        return All;
+    }();
+    return ALL;
+}
+
+inline const m6502::Workload* m6502::FindWorkload(const char* Name)
+{
+    for (const Workload& Each : Workloads())
+    {
+        if (strcmp(Each.Name, Name) == 0)
+        {
+            return &Each;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,566 @@
+/*
+ * Exhaustive superoptimizer for short straight-line sequences
+ *
+ *  M6502Superopt [-n length] [-j threads] [-v vectors] [-s seed]
+ *                [-goal size|cycles] [-live axyf] <target bytes...>
+ *
+ *  M6502Superopt A9 00 85 10 A9 00 85 11
+ *
+ * Enumerates every sequence of up to -n loads and stores whose operands
+ * are the target's own immediates, zero page and absolute addresses (plus
+ * #$00, #$01 and #$FF), and runs each one against the target on -v random
+ * machine states. A candidate is equivalent when the live registers (-live,
+ * f meaning the N and Z flags) and every byte either sequence wrote match
+ * on all vectors. It reports the smallest (or, with -goal cycles, the
+ * fastest) equivalent found. Random vectors make this a strong filter,
+ * not a proof, so check the result by hand.
+ *
+ * Cost per candidate is kept small
+ *  - Candidates are spread over threads by their first instruction
+ *  - A candidate is dropped on the first vector that disagrees, and (for
+ *    -goal cycles) as soon as it is slower than the best so far
+ *  - Vectors only differ in the pages the target references (zero page,
+ *    stack, its absolute pages) on top of one shared random image, so
+ *    switching vectors copies a few pages and undoing a run restores only
+ *    the pages the dirty bitmap says were written
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_opcodes.h"
+
+using namespace m6502;
+
+namespace
+{
+    using Mode = AddressingMode;
+    using OpInfo = OpcodeInfo;
+
+    // The NMOS loads and stores, the candidates run on CPU::Execute's NMOS core
+    bool IsCandidate(const OpInfo& Info)
+    {
+        return (Info.Type == OpcodeKind::Load || Info.Type == OpcodeKind::Store)
+               && (Info.Variants & (1 << (u32)CPUVariant::NMOS6502));
+    }
+
+    const OpInfo* FindOp(Byte Opcode)
+    {
+        const OpInfo* Info = OpcodeInfo::Decode(Opcode);
+        return Info && IsCandidate(*Info) ? Info : nullptr;
+    }
+
+    u32 OperandBytes(Mode AddrMode)
+    {
+        return (AddrMode == Mode::Abs || AddrMode == Mode::AbsX || AddrMode == Mode::AbsY) ? 2 : 1;
+    }
+
+    struct Instruction
+    {
+        const OpInfo* Info;
+        Word Operand;
+
+        u32 Length() const
+        {
+            return 1 + OperandBytes(Info->AddrMode);
+        }
+
+        u32 Emit(Byte* Code) const
+        {
+            Code[0] = Info->Opcode;
+            Code[1] = Operand & 0xFF;
+            Code[2] = Operand >> 8;
+            return Length();
+        }
+
+        std::string Format() const
+        {
+            char Text[32];
+            Info->Format(Operand, Text, sizeof(Text));
+            return Text;
+        }
+    };
+
+    using Sequence = std::vector<Instruction>;
+
+    bool Decode(const std::vector<Byte>& Bytes, Sequence& Out)
+    {
+        for (size_t i = 0; i < Bytes.size();)
+        {
+            const OpInfo* Info = FindOp(Bytes[i]);
+            if (!Info || i + 1 + OperandBytes(Info->AddrMode) > Bytes.size())
+            {
+                fprintf(stderr, "cannot decode a load or store at byte %zu\n", i);
+                return false;
+            }
+            Word Operand = Bytes[i + 1];
+            if (OperandBytes(Info->AddrMode) == 2)
+            {
+                Operand |= Bytes[i + 2] << 8;
+            }
+            Out.push_back({ Info, Operand });
+            i += 1 + OperandBytes(Info->AddrMode);
+        }
+        return !Out.empty();
+    }
+
+    // Every opcode with every operand of the right kind the target uses
+    Sequence BuildVocabulary(const Sequence& Target)
+    {
+        std::vector<Word> Immediates = { 0x00, 0x01, 0xFF }, ZeroPage, Absolute;
+        auto AddUnique = [](std::vector<Word>& Set, Word Value)
+        {
+            if (std::find(Set.begin(), Set.end(), Value) == Set.end())
+            {
+                Set.push_back(Value);
+            }
+        };
+        for (const Instruction& Ins : Target)
+        {
+            const Mode AddrMode = Ins.Info->AddrMode;
+            if (AddrMode == Mode::Imm)
+            {
+                AddUnique(Immediates, Ins.Operand);
+            }
+            else if (OperandBytes(AddrMode) == 1 || Ins.Operand < 0x100)
+            {
+                AddUnique(ZeroPage, Ins.Operand);
+            }
+            else
+            {
+                AddUnique(Absolute, Ins.Operand);
+            }
+        }
+
+        Sequence Vocabulary;
+        for (const OpInfo& Info : OpcodeInfo::All())
+        {
+            if (!IsCandidate(Info))
+            {
+                continue;
+            }
+            const std::vector<Word>& Operands = Info.AddrMode == Mode::Imm ? Immediates
+                : OperandBytes(Info.AddrMode) == 1 ? ZeroPage : Absolute;
+            for (Word Operand : Operands)
+            {
+                Vocabulary.push_back({ &Info, Operand });
+            }
+        }
+        return Vocabulary;
+    }
+
+    struct Options
+    {
+        u32 MaxLength = 3;
+        u32 Threads = std::max(1u, std::thread::hardware_concurrency());
+        u32 Vectors = 32;
+        u64 Seed = 6502;
+        bool Fastest = false;
+        bool LiveA = true, LiveX = true, LiveY = true, LiveFlags = true;
+    };
+
+    constexpr Byte FLAGS_NZ = 0b10000010;
+    constexpr s32 MAX_CYCLES = 256;
+    constexpr Byte SENTINEL = 0x02;
+
+    struct Result
+    {
+        Byte A, X, Y, PS;
+        Word PC;
+        bool Jammed;
+        s32 Cycles;
+    };
+
+    /*
+     * The shared random image, each vector's registers and overlay pages,
+     * and what the target left behind on each vector
+     */
+    struct TestSet
+    {
+        std::unique_ptr<Mem> Base;
+        std::vector<u32> VariablePages;
+        s32 OverlayIndex[Mem::NUM_PAGES];
+        Word CodeAddress;
+
+        struct Vector
+        {
+            Byte A, X, Y, PS;
+            std::vector<Byte> Overlay;      // VariablePages.size() pages
+            Result Expected;
+            std::vector<u32> WrittenPages;  // Pages the target wrote and their final content
+            std::vector<Byte> Written;
+        };
+
+        std::vector<Vector> Vectors;
+
+        const Byte* InitialPage(const Vector& Vec, u32 Page) const
+        {
+            const s32 Index = OverlayIndex[Page];
+            return Index >= 0 ? &Vec.Overlay[Index * Mem::PAGE_SIZE] : &Base->Data[Page * Mem::PAGE_SIZE];
+        }
+    };
+
+    // A thread's machine, holds the base image with one vector's overlay applied
+    struct Worker
+    {
+        std::unique_ptr<Mem> Memory = std::make_unique<Mem>();
+        CPU Cpu;
+        s32 LoadedVector = -1;
+
+        explicit Worker(const TestSet& Tests)
+        {
+            *Memory = *Tests.Base;
+            Cpu.ThrowOnIllegalOpcode = false;
+        }
+
+        void Select(const TestSet& Tests, u32 Index)
+        {
+            if (LoadedVector == (s32)Index)
+            {
+                return;
+            }
+            const TestSet::Vector& Vec = Tests.Vectors[Index];
+            for (size_t i = 0; i < Tests.VariablePages.size(); i++)
+            {
+                memcpy(&Memory->Data[Tests.VariablePages[i] * Mem::PAGE_SIZE], &Vec.Overlay[i * Mem::PAGE_SIZE], Mem::PAGE_SIZE);
+            }
+            LoadedVector = Index;
+        }
+
+        Result Run(const TestSet& Tests, u32 Index, const Byte* Code, u32 Length)
+        {
+            Select(Tests, Index);
+            const TestSet::Vector& Vec = Tests.Vectors[Index];
+            memcpy(&Memory->Data[Tests.CodeAddress], Code, Length);
+            Memory->Data[Tests.CodeAddress + Length] = SENTINEL;
+            Cpu.PC = Tests.CodeAddress;
+            Cpu.SP = 0xFF;
+            Cpu.A = Vec.A;
+            Cpu.X = Vec.X;
+            Cpu.Y = Vec.Y;
+            Cpu.PS = Vec.PS;
+            Cpu.Jammed = false;
+            // The sentinel's fetch is one cycle, not part of the sequence
+            const s32 Used = Cpu.Execute(MAX_CYCLES, *Memory) - 1;
+            return { Cpu.A, Cpu.X, Cpu.Y, Cpu.PS, Cpu.PC, Cpu.Jammed, Used };
+        }
+
+        // Put the written pages back to the vector's initial state
+        void Undo(const TestSet& Tests)
+        {
+            const TestSet::Vector& Vec = Tests.Vectors[LoadedVector];
+            for (u32 Page = 0; Page < Mem::NUM_PAGES; Page++)
+            {
+                if (Memory->IsPageDirty(Page))
+                {
+                    memcpy(&Memory->Data[Page * Mem::PAGE_SIZE], Tests.InitialPage(Vec, Page), Mem::PAGE_SIZE);
+                }
+            }
+            memset(Memory->DirtyPages, 0, sizeof(Memory->DirtyPages));
+        }
+    };
+
+    TestSet BuildTests(const Sequence& Target, const Options& Opts)
+    {
+        TestSet Tests;
+        std::mt19937_64 Random(Opts.Seed);
+        Tests.Base = std::make_unique<Mem>();
+        for (u32 i = 0; i < Mem::MAX_MEM; i++)
+        {
+            Tests.Base->Data[i] = (Byte)Random();
+        }
+
+        // Zero page and stack, plus each absolute operand's page and the next (indexing)
+        std::fill(std::begin(Tests.OverlayIndex), std::end(Tests.OverlayIndex), -1);
+        auto AddPage = [&Tests](u32 Page)
+        {
+            Page &= Mem::NUM_PAGES - 1;
+            if (Tests.OverlayIndex[Page] < 0)
+            {
+                Tests.OverlayIndex[Page] = (s32)Tests.VariablePages.size();
+                Tests.VariablePages.push_back(Page);
+            }
+        };
+        AddPage(0);
+        AddPage(1);
+        for (const Instruction& Ins : Target)
+        {
+            if (OperandBytes(Ins.Info->AddrMode) == 2)
+            {
+                AddPage(Ins.Operand >> 8);
+                AddPage((Ins.Operand >> 8) + 1);
+            }
+        }
+        u32 CodePage = Mem::NUM_PAGES - 1;
+        while (Tests.OverlayIndex[CodePage] >= 0)
+        {
+            CodePage--;
+        }
+        Tests.CodeAddress = (Word)(CodePage * Mem::PAGE_SIZE);
+
+        Tests.Vectors.resize(Opts.Vectors);
+        for (TestSet::Vector& Vec : Tests.Vectors)
+        {
+            Vec.A = (Byte)Random();
+            Vec.X = (Byte)Random();
+            Vec.Y = (Byte)Random();
+            Vec.PS = (Byte)Random();
+            Vec.Overlay.resize(Tests.VariablePages.size() * Mem::PAGE_SIZE);
+            for (Byte& Value : Vec.Overlay)
+            {
+                Value = (Byte)Random();
+            }
+        }
+
+        Byte Code[MAX_CYCLES];
+        u32 Length = 0;
+        for (const Instruction& Ins : Target)
+        {
+            Length += Ins.Emit(Code + Length);
+        }
+        Worker Recorder(Tests);
+        for (u32 Index = 0; Index < Opts.Vectors; Index++)
+        {
+            TestSet::Vector& Vec = Tests.Vectors[Index];
+            Vec.Expected = Recorder.Run(Tests, Index, Code, Length);
+            for (u32 Page = 0; Page < Mem::NUM_PAGES; Page++)
+            {
+                if (Recorder.Memory->IsPageDirty(Page) && Page != CodePage)
+                {
+                    Vec.WrittenPages.push_back(Page);
+                    const Byte* Content = &Recorder.Memory->Data[Page * Mem::PAGE_SIZE];
+                    Vec.Written.insert(Vec.Written.end(), Content, Content + Mem::PAGE_SIZE);
+                }
+            }
+            Recorder.Undo(Tests);
+        }
+        return Tests;
+    }
+
+    /*
+     * Search state shared by the threads
+     */
+    struct Search
+    {
+        const TestSet& Tests;
+        const Sequence& Vocabulary;
+        const Options& Opts;
+        const u32 CodePage;
+
+        std::atomic<u32> NextFirst{ 0 };
+        std::atomic<u64> Candidates{ 0 };
+        std::atomic<u64> VectorRuns{ 0 };
+
+        std::mutex BestLock;
+        std::atomic<u64> BestCost;
+        Sequence Best;
+
+        Search(const TestSet& Tests, const Sequence& Vocabulary, const Options& Opts, u64 TargetCost)
+            : Tests(Tests), Vocabulary(Vocabulary), Opts(Opts), CodePage(Tests.CodeAddress / Mem::PAGE_SIZE), BestCost(TargetCost)
+        {
+        }
+
+        bool Matches(const Worker& W, const Result& Got, const TestSet::Vector& Vec) const
+        {
+            const Result& Want = Vec.Expected;
+            if ((Opts.LiveA && Got.A != Want.A) || (Opts.LiveX && Got.X != Want.X) || (Opts.LiveY && Got.Y != Want.Y)
+                || (Opts.LiveFlags && (Got.PS & FLAGS_NZ) != (Want.PS & FLAGS_NZ)))
+            {
+                return false;
+            }
+            const Byte* Data = W.Memory->Data;
+            for (size_t i = 0; i < Vec.WrittenPages.size(); i++)
+            {
+                if (memcmp(&Data[Vec.WrittenPages[i] * Mem::PAGE_SIZE], &Vec.Written[i * Mem::PAGE_SIZE], Mem::PAGE_SIZE) != 0)
+                {
+                    return false;
+                }
+            }
+            for (u32 Page = 0; Page < Mem::NUM_PAGES; Page++)
+            {
+                if (W.Memory->IsPageDirty(Page) && Page != CodePage
+                    && std::find(Vec.WrittenPages.begin(), Vec.WrittenPages.end(), Page) == Vec.WrittenPages.end()
+                    && memcmp(&Data[Page * Mem::PAGE_SIZE], Tests.InitialPage(Vec, Page), Mem::PAGE_SIZE) != 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Run one candidate, dropping it at the first mismatch or once it is too slow
+        void Try(Worker& W, const Sequence& Candidate, const Byte* Code, u32 Length)
+        {
+            Candidates.fetch_add(1, std::memory_order_relaxed);
+            if (!Opts.Fastest && Length >= BestCost.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            u64 Cycles = 0;
+            u32 Runs = 0;
+            bool Equivalent = true;
+            for (u32 Index = 0; Index < Tests.Vectors.size() && Equivalent; Index++)
+            {
+                const Result Got = W.Run(Tests, Index, Code, Length);
+                Runs++;
+                // Must have run off its end into the sentinel, not jammed on a rewritten opcode
+                Equivalent = Got.Jammed && Got.PC == Tests.CodeAddress + Length && Matches(W, Got, Tests.Vectors[Index]);
+                Cycles += Got.Cycles;
+                W.Undo(Tests);
+                if (Opts.Fastest && Cycles >= BestCost.load(std::memory_order_relaxed))
+                {
+                    Equivalent = false;
+                }
+            }
+            VectorRuns.fetch_add(Runs, std::memory_order_relaxed);
+            if (!Equivalent)
+            {
+                return;
+            }
+
+            const u64 Cost = Opts.Fastest ? Cycles : Length;
+            std::lock_guard<std::mutex> Guard(BestLock);
+            if (Cost < BestCost)
+            {
+                BestCost = Cost;
+                Best = Candidate;
+            }
+        }
+
+        void Enumerate(Worker& W, Sequence& Candidate, Byte* Code, u32 Length, u32 Remaining)
+        {
+            if (Remaining == 0)
+            {
+                Try(W, Candidate, Code, Length);
+                return;
+            }
+            for (const Instruction& Ins : Vocabulary)
+            {
+                Candidate.push_back(Ins);
+                Enumerate(W, Candidate, Code, Length + Ins.Emit(Code + Length), Remaining - 1);
+                Candidate.pop_back();
+            }
+        }
+
+        void RunThread(u32 NumInstructions)
+        {
+            Worker W(Tests);
+            Sequence Candidate;
+            Byte Code[3 * 16];
+            for (u32 First = NextFirst++; First < Vocabulary.size(); First = NextFirst++)
+            {
+                Candidate.assign(1, Vocabulary[First]);
+                Enumerate(W, Candidate, Code, Vocabulary[First].Emit(Code), NumInstructions - 1);
+            }
+        }
+    };
+
+    void Print(const char* Title, const Sequence& Seq)
+    {
+        printf("%s\n", Title);
+        for (const Instruction& Ins : Seq)
+        {
+            printf("    %s\n", Ins.Format().c_str());
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options Opts;
+    std::vector<Byte> TargetBytes;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            Opts.MaxLength = std::clamp(atoi(argv[++i]), 1, 16);
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            Opts.Threads = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc)
+        {
+            Opts.Vectors = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            Opts.Seed = strtoull(argv[++i], nullptr, 0);
+        }
+        else if (strcmp(argv[i], "-goal") == 0 && i + 1 < argc)
+        {
+            Opts.Fastest = strcmp(argv[++i], "cycles") == 0;
+        }
+        else if (strcmp(argv[i], "-live") == 0 && i + 1 < argc)
+        {
+            const char* Live = argv[++i];
+            Opts.LiveA = strchr(Live, 'a') != nullptr;
+            Opts.LiveX = strchr(Live, 'x') != nullptr;
+            Opts.LiveY = strchr(Live, 'y') != nullptr;
+            Opts.LiveFlags = strchr(Live, 'f') != nullptr;
+        }
+        else
+        {
+            TargetBytes.push_back((Byte)strtoul(argv[i], nullptr, 16));
+        }
+    }
+
+    Sequence Target;
+    if (TargetBytes.empty() || !Decode(TargetBytes, Target))
+    {
+        fprintf(stderr, "Usage: %s [-n length] [-j threads] [-v vectors] [-s seed] [-goal size|cycles] [-live axyf] <target bytes...>\n", argv[0]);
+        return 2;
+    }
+
+    const TestSet Tests = BuildTests(Target, Opts);
+    const Sequence Vocabulary = BuildVocabulary(Target);
+    u64 TargetCycles = 0;
+    for (const TestSet::Vector& Vec : Tests.Vectors)
+    {
+        TargetCycles += Vec.Expected.Cycles;
+    }
+    Print("target:", Target);
+    printf("%zu byte(s), %.2f cycles on average, %zu instructions in the vocabulary\n",
+           TargetBytes.size(), (double)TargetCycles / Opts.Vectors, Vocabulary.size());
+
+    Search Searcher(Tests, Vocabulary, Opts, Opts.Fastest ? TargetCycles : TargetBytes.size());
+    const auto Start = std::chrono::steady_clock::now();
+    for (u32 Length = 1; Length <= Opts.MaxLength; Length++)
+    {
+        Searcher.NextFirst = 0;
+        std::vector<std::thread> Threads;
+        for (u32 i = 0; i < Opts.Threads; i++)
+        {
+            Threads.emplace_back([&Searcher, Length] { Searcher.RunThread(Length); });
+        }
+        for (std::thread& Thread : Threads)
+        {
+            Thread.join();
+        }
+    }
+    const std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - Start;
+
+    printf("%llu candidates, %llu vector runs in %.2f s (%.1f M candidates/s, %.1f M runs/s)\n",
+           (unsigned long long)Searcher.Candidates, (unsigned long long)Searcher.VectorRuns, Elapsed.count(),
+           Searcher.Candidates / Elapsed.count() / 1e6, Searcher.VectorRuns / Elapsed.count() / 1e6);
+    if (Searcher.Best.empty())
+    {
+        printf("no %s equivalent up to %u instructions\n", Opts.Fastest ? "faster" : "smaller", Opts.MaxLength);
+        return 1;
+    }
+    Print(Opts.Fastest ? "fastest equivalent:" : "smallest equivalent:", Searcher.Best);
+    if (Opts.Fastest)
+    {
+        printf("%.2f cycles on average\n", (double)Searcher.BestCost / Opts.Vectors);
+    }
+    return 0;
+}
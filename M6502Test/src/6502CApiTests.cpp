@@ -0,0 +1,128 @@
+#include <vector>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_c.h"
+
+class M6502CApiTests : public testing::Test
+{
+public:
+    m6502_machine* machine = nullptr;
+
+    virtual void SetUp()
+    {
+        machine = m6502_create(M6502_VARIANT_NMOS6502);
+    }
+
+    virtual void TearDown()
+    {
+        m6502_destroy(machine);
+    }
+};
+
+TEST_F(M6502CApiTests, CanLoadRunAndReadBackState)
+{
+    // given:
+    using namespace m6502;
+    const uint8_t Program[] = { CPU::INS_LDA_IM, 0x42, CPU::INS_STA_ZP, 0x10 };
+    m6502_reset(machine, 0x0200);
+
+    // when:
+    const int Loaded = m6502_load(machine, 0x0200, Program, sizeof(Program));
+    const int32_t Used = m6502_run(machine, 2 + 3);
+    m6502_state State;
+    m6502_get_state(machine, &State);
+
+    // then:
+    EXPECT_EQ(Loaded, 0);
+    EXPECT_EQ(Used, 2 + 3);
+    EXPECT_EQ(State.a, 0x42);
+    EXPECT_EQ(State.pc, 0x0204);
+    EXPECT_EQ(State.jammed, 0);
+    EXPECT_EQ(m6502_read(machine, 0x0010), 0x42);
+}
+
+TEST_F(M6502CApiTests, RejectsImagesPastTheEndOfMemoryAndUnknownVariants)
+{
+    // given:
+    const uint8_t Image[4] = {};
+
+    // when/then:
+    EXPECT_EQ(m6502_load(machine, 0xFFFE, Image, sizeof(Image)), -1);
+    // address + size would wrap to 0xFFFE in 32 bits
+    EXPECT_EQ(m6502_load(machine, 0xFFFF, Image, 0xFFFFFFFFu), -1);
+    EXPECT_EQ(m6502_load(machine, 0x0000, Image, 0xFFFFFFFFu), -1);
+    EXPECT_EQ(m6502_load(machine, 0xFFFC, Image, sizeof(Image)), 0);
+    EXPECT_EQ(m6502_create(7), nullptr);
+    EXPECT_EQ(m6502_abi_version(), (uint32_t)M6502_ABI_VERSION);
+}
+
+TEST_F(M6502CApiTests, IllegalOpcodesJamInsteadOfThrowing)
+{
+    // given:
+    m6502_reset(machine, 0x0200);
+    m6502_write(machine, 0x0200, 0x02);
+
+    // when:
+    m6502_run(machine, 10);
+    m6502_state State;
+    m6502_get_state(machine, &State);
+
+    // then:
+    EXPECT_EQ(State.jammed, 1);
+    EXPECT_EQ(State.pc, 0x0200);
+}
+
+TEST_F(M6502CApiTests, MemoryViewIsZeroCopy)
+{
+    // given:
+    uint32_t Size = 0;
+    uint8_t* View = m6502_memory(machine, &Size);
+
+    // when:
+    View[0x1234] = 0x99;
+    m6502_write(machine, 0x4321, 0x77);
+
+    // then:
+    EXPECT_EQ(Size, 64u * 1024);
+    EXPECT_EQ(m6502_read(machine, 0x1234), 0x99);
+    EXPECT_EQ(View[0x4321], 0x77);
+}
+
+TEST_F(M6502CApiTests, BatchesRunAndInspectEveryMachine)
+{
+    // given:
+    using namespace m6502;
+    std::vector<m6502_machine*> Machines = { machine, m6502_create(M6502_VARIANT_CMOS65C02) };
+    std::vector<m6502_state> States(2);
+    m6502_get_state_batch(Machines.data(), 2, States.data());
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        States[i].pc = 0x0200;
+        States[i].x = i;
+    }
+    m6502_set_state_batch(Machines.data(), 2, States.data());
+    // LDA $10,X on both, STZ $20 is only legal on the 65C02
+    const uint8_t Program[] = { CPU::INS_LDA_ZPX, 0x10, CPU::INS_STZ_ZP, 0x20 };
+    const uint8_t Data[] = { 0x0A, 0x0B };
+    for (m6502_machine* Machine : Machines)
+    {
+        m6502_load(Machine, 0x0200, Program, sizeof(Program));
+        m6502_load(Machine, 0x0010, Data, sizeof(Data));
+        m6502_write(Machine, 0x0020, 0xFF);
+    }
+    std::vector<int32_t> Used(2);
+
+    // when:
+    m6502_run_batch(Machines.data(), 2, 4 + 3, Used.data());
+    m6502_get_state_batch(Machines.data(), 2, States.data());
+
+    // then:
+    EXPECT_EQ(States[0].a, 0x0A);
+    EXPECT_EQ(States[0].jammed, 1);
+    EXPECT_EQ(Used[0], 4 + 1);
+    EXPECT_EQ(States[1].a, 0x0B);
+    EXPECT_EQ(States[1].jammed, 0);
+    EXPECT_EQ(Used[1], 4 + 3);
+    EXPECT_EQ(m6502_read(Machines[1], 0x0020), 0x00);
+    m6502_destroy(Machines[1]);
+}
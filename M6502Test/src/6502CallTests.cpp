@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+
+class M6502CallTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0xFF00, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    // LDA #$42; STA $10; LDX $10; JSR $8100; RTS, with LDY #$07; RTS at $8100
+    void LoadRoutine()
+    {
+        using namespace m6502;
+        const Byte Routine[] =
+        {
+            CPU::INS_LDA_IM, 0x42,
+            CPU::INS_STA_ZP, 0x10,
+            CPU::INS_LDX_ZP, 0x10,
+            CPU::INS_JSR, 0x00, 0x81,
+            CPU::INS_RTS,
+        };
+        const Byte Inner[] = { CPU::INS_LDY_IM, 0x07, CPU::INS_RTS };
+        mem.Load(0x8000, Routine, sizeof(Routine));
+        mem.Load(0x8100, Inner, sizeof(Inner));
+    }
+};
+
+TEST_F(M6502CallTests, CallRunsTheRoutineUntilItsOwnRTS)
+{
+    // given:
+    using namespace m6502;
+    LoadRoutine();
+    const Byte SPBefore = cpu.SP;
+
+    // when:
+    const CPU::CallResult Result = cpu.Call(0x8000, {}, mem);
+
+    // then:
+    EXPECT_TRUE(Result.Returned);
+    EXPECT_EQ(Result.A, 0x42);
+    EXPECT_EQ(Result.X, 0x42);
+    EXPECT_EQ(Result.Y, 0x07);
+    EXPECT_EQ(Result.Cycles, 2 + 3 + 3 + 6 + 2 + 6 + 6);
+    EXPECT_EQ(mem[0x10], 0x42);
+    EXPECT_EQ(cpu.PC, 0xFF00);
+    EXPECT_EQ(cpu.SP, SPBefore);
+    EXPECT_EQ(cpu.CallReturnSP, -1);
+}
+
+TEST_F(M6502CallTests, CallPassesTheRegistersIn)
+{
+    // given:
+    using namespace m6502;
+    const Byte Routine[] = { CPU::INS_STA_ZPX, 0x10, CPU::INS_STY_ABS, 0x00, 0x20, CPU::INS_RTS };
+    mem.Load(0x8000, Routine, sizeof(Routine));
+    CPU::CallRegisters In;
+    In.A = 0x11;
+    In.X = 0x02;
+    In.Y = 0x33;
+
+    // when:
+    const CPU::CallResult Result = cpu.Call(0x8000, In, mem);
+
+    // then:
+    EXPECT_TRUE(Result.Returned);
+    EXPECT_EQ(mem[0x12], 0x11);
+    EXPECT_EQ(mem[0x2000], 0x33);
+    EXPECT_EQ(Result.X, 0x02);
+}
+
+TEST_F(M6502CallTests, CallGivesUpWhenTheBudgetRunsOut)
+{
+    // given:
+    using namespace m6502;
+    const Byte Routine[] = { CPU::INS_JMP_ABS, 0x00, 0x80 };
+    mem.Load(0x8000, Routine, sizeof(Routine));
+
+    // when:
+    const CPU::CallResult Result = cpu.Call(0x8000, {}, mem, 1000);
+
+    // then:
+    EXPECT_FALSE(Result.Returned);
+    EXPECT_GE(Result.Cycles, 1000);
+    EXPECT_EQ(cpu.CallReturnSP, -1);
+}
+
+TEST_F(M6502CallTests, CallStopsWhenTheRoutineJams)
+{
+    // given:
+    using namespace m6502;
+    cpu.ThrowOnIllegalOpcode = false;
+    mem[0x8000] = 0x02;
+
+    // when:
+    const CPU::CallResult Result = cpu.Call(0x8000, {}, mem);
+
+    // then:
+    EXPECT_FALSE(Result.Returned);
+    EXPECT_TRUE(cpu.Jammed);
+    EXPECT_EQ(cpu.PC, 0x8000);
+}
+
+TEST_F(M6502CallTests, CallPutsTheOuterCallBackWhenTheRoutineThrows)
+{
+    // given:
+    using namespace m6502;
+    mem[0x8000] = CPU::INS_LDA_IM;
+    mem[0x8001] = 0x01;
+    mem[0x8002] = 0x02;     // illegal
+    const Byte Caller[] = { CPU::INS_JSR, 0x00, 0x90, CPU::INS_LDA_IM, 0x33 };
+    const Byte Callee[] = { CPU::INS_RTS };
+    mem.Load(0xFEFD, Caller, sizeof(Caller));
+    mem.Load(0x9000, Callee, sizeof(Callee));
+    ASSERT_TRUE(cpu.ThrowOnIllegalOpcode);
+
+    // when:
+    EXPECT_THROW(cpu.Call(0x8000, {}, mem), int);
+    cpu.PC = 0xFEFD;
+    cpu.SP = 0xFF;
+    // The RTS comes back to $FF00 with SP $FF, what the failed call was waiting for
+    const s32 Used = cpu.Execute(6 + 6 + 2, mem);
+
+    // then:
+    EXPECT_EQ(cpu.CallReturnSP, -1);
+    EXPECT_EQ(cpu.Stopped, CPU::StopReason::None);
+    EXPECT_EQ(Used, 6 + 6 + 2);
+    EXPECT_EQ(cpu.A, 0x33);
+}
+
+TEST_F(M6502CallTests, CallReturnsTheSameResultsOnEveryVariant)
+{
+    // given:
+    using namespace m6502;
+    LoadRoutine();
+
+    // when:
+    const CPU::CallResult Nmos = cpu.Call<CPUVariant::NMOS6502>(0x8000, {}, mem);
+    const CPU::CallResult Cmos = cpu.Call<CPUVariant::CMOS65C02>(0x8000, {}, mem);
+    const CPU::CallResult Nes = cpu.Call<CPUVariant::RP2A03>(0x8000, {}, mem);
+
+    // then:
+    EXPECT_TRUE(Nmos.Returned && Cmos.Returned && Nes.Returned);
+    EXPECT_EQ(Nmos.Cycles, Cmos.Cycles);
+    EXPECT_EQ(Nmos.Cycles, Nes.Cycles);
+}
+
+TEST_F(M6502CallTests, AnRTSOutsideACallDoesNotStopExecute)
+{
+    // given:
+    using namespace m6502;
+    LoadRoutine();
+    mem[0xFF00] = CPU::INS_JSR;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0x81;
+    mem[0xFF03] = CPU::INS_LDA_IM;
+    mem[0xFF04] = 0x99;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(6 + 2 + 6 + 2, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 16);
+    EXPECT_EQ(cpu.A, 0x99);
+    EXPECT_EQ(cpu.Stopped, CPU::StopReason::None);
+}
@@ -0,0 +1,212 @@
+#include <coroutine>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_coroutine.h"
+
+class M6502CoroutineTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    struct CountingMapper : m6502::Mapper
+    {
+        std::vector<m6502::Byte> Values;
+        void Write(m6502::Mem&, m6502::Word, m6502::Byte Value) override { Values.push_back(Value); }
+    };
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0x0200, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+};
+
+TEST_F(M6502CoroutineTests, YieldsEveryQuantumUntilFinished)
+{
+    // given:
+    using namespace m6502;
+    mem[0x0200] = CPU::INS_LDA_IM;
+    mem[0x0201] = 0x42;
+    mem[0x0202] = CPU::INS_JMP_ABS;
+    mem[0x0203] = 0x00;
+    mem[0x0204] = 0x02;
+    ExecutionTask Task = RunAsCoroutine(cpu, mem, { .Quantum = 100, .TotalCycles = 1000 });
+
+    // when:
+    s64 Total = 0;
+    u32 Quanta = 0;
+    YieldPoint Point = Task.Resume();
+    while (Point.Reason == YieldReason::Quantum)
+    {
+        EXPECT_GE(Point.Cycles, 100);
+        EXPECT_LT(Point.Cycles, 100 + 3);
+        Total += Point.Cycles;
+        Quanta++;
+        Point = Task.Resume();
+    }
+
+    // then:
+    EXPECT_EQ(Point.Reason, YieldReason::Finished);
+    EXPECT_TRUE(Task.Done());
+    EXPECT_GE(Total, 1000);
+    EXPECT_LE(Quanta, 10u);
+    EXPECT_EQ(cpu.A, 0x42);
+    EXPECT_FALSE(cpu.StopOnMapperWrite);
+}
+
+TEST_F(M6502CoroutineTests, NonPositiveQuantumStillMakesProgress)
+{
+    // given:
+    using namespace m6502;
+    mem[0x0200] = CPU::INS_LDA_IM;
+    mem[0x0201] = 0x42;
+    mem[0x0202] = CPU::INS_JMP_ABS;
+    mem[0x0203] = 0x00;
+    mem[0x0204] = 0x02;
+    ExecutionTask Task = RunAsCoroutine(cpu, mem, { .Quantum = 0, .TotalCycles = 10 });
+
+    // when:
+    u32 Quanta = 0;
+    YieldPoint Point = Task.Resume();
+    while (Point.Reason == YieldReason::Quantum && Quanta < 100)
+    {
+        EXPECT_GT(Point.Cycles, 0);
+        Quanta++;
+        Point = Task.Resume();
+    }
+
+    // then:
+    EXPECT_EQ(Point.Reason, YieldReason::Finished);
+    EXPECT_EQ(Quanta, 4u);     // one instruction per slice
+    EXPECT_EQ(cpu.A, 0x42);
+}
+
+TEST_F(M6502CoroutineTests, YieldsAfterEachMapperWriteAndResumesWhereItLeftOff)
+{
+    // given:
+    using namespace m6502;
+    CountingMapper Device;
+    mem.AttachedMapper = &Device;
+    mem.MapWindow(0xD000 >> Mem::WINDOW_SHIFT, mem.Data + 0xD000, nullptr);
+    mem[0x0200] = CPU::INS_LDA_IM;
+    mem[0x0201] = 0x01;
+    mem[0x0202] = CPU::INS_STA_ABS;
+    mem[0x0203] = 0x00;
+    mem[0x0204] = 0xD0;
+    mem[0x0205] = CPU::INS_LDA_IM;
+    mem[0x0206] = 0x02;
+    mem[0x0207] = CPU::INS_STA_ABS;
+    mem[0x0208] = 0x01;
+    mem[0x0209] = 0xD0;
+    mem[0x020A] = CPU::INS_JMP_ABS;
+    mem[0x020B] = 0x0A;
+    mem[0x020C] = 0x02;
+    ExecutionTask Task = RunAsCoroutine(cpu, mem, { .Quantum = 1000, .YieldOnMapperWrite = true });
+
+    // when:
+    const YieldPoint First = Task.Resume();
+    const Word FirstPC = cpu.PC;
+    const YieldPoint Second = Task.Resume();
+    const Word SecondPC = cpu.PC;
+    const YieldPoint Third = Task.Resume();
+
+    // then:
+    EXPECT_EQ(First.Reason, YieldReason::MapperWrite);
+    EXPECT_EQ(First.Cycles, 2 + 4);
+    EXPECT_EQ(FirstPC, 0x0205);
+    EXPECT_EQ(Second.Reason, YieldReason::MapperWrite);
+    EXPECT_EQ(Second.Cycles, 2 + 4);
+    EXPECT_EQ(SecondPC, 0x020A);
+    EXPECT_EQ(Third.Reason, YieldReason::Quantum);
+    EXPECT_EQ(Device.Values, (std::vector<Byte>{ 0x01, 0x02 }));
+}
+
+TEST_F(M6502CoroutineTests, YieldsHaltWhenTheCPUJams)
+{
+    // given:
+    using namespace m6502;
+    cpu.ThrowOnIllegalOpcode = false;
+    mem[0x0200] = CPU::INS_LDA_IM;
+    mem[0x0201] = 0x01;
+    mem[0x0202] = 0x02;
+    ExecutionTask Task = RunAsCoroutine(cpu, mem, {});
+
+    // when:
+    const YieldPoint Halted = Task.Resume();
+    mem[0x0202] = CPU::INS_JMP_ABS;
+    mem[0x0203] = 0x02;
+    mem[0x0204] = 0x02;
+    const YieldPoint Resumed = Task.Resume();
+
+    // then:
+    EXPECT_EQ(Halted.Reason, YieldReason::Halt);
+    EXPECT_EQ(cpu.PC, 0x0202);
+    EXPECT_EQ(Resumed.Reason, YieldReason::Quantum);
+    EXPECT_FALSE(cpu.Jammed);
+}
+
+TEST_F(M6502CoroutineTests, ResumeRethrowsIllegalOpcodes)
+{
+    // given:
+    using namespace m6502;
+    mem[0x0200] = 0x02;
+    ExecutionTask Task = RunAsCoroutine(cpu, mem, {});
+
+    // when/then:
+    EXPECT_THROW(Task.Resume(), int);
+    EXPECT_TRUE(Task.Done());
+}
+
+namespace
+{
+    // Minimal host coroutine, runs eagerly and keeps its frame until destroyed
+    struct HostTask
+    {
+        struct promise_type
+        {
+            HostTask get_return_object() { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        std::coroutine_handle<promise_type> Handle;
+    };
+
+    HostTask AwaitMachine(m6502::ExecutionTask& Task, std::vector<m6502::YieldPoint>& Points)
+    {
+        while (!Task.Done())
+        {
+            Points.push_back(co_await Task);
+        }
+    }
+}
+
+TEST_F(M6502CoroutineTests, CanBeAwaitedFromAHostCoroutine)
+{
+    // given:
+    using namespace m6502;
+    mem[0x0200] = CPU::INS_JMP_ABS;
+    mem[0x0201] = 0x00;
+    mem[0x0202] = 0x02;
+    ExecutionTask Task = RunAsCoroutine(cpu, mem, { .Quantum = 30, .TotalCycles = 90 });
+    std::vector<YieldPoint> Points;
+
+    // when:
+    HostTask Host = AwaitMachine(Task, Points);
+
+    // then:
+    EXPECT_TRUE(Host.Handle.done());
+    ASSERT_EQ(Points.size(), 4u);
+    EXPECT_EQ(Points[0].Reason, YieldReason::Quantum);
+    EXPECT_EQ(Points[0].Cycles, 30);
+    EXPECT_EQ(Points[3].Reason, YieldReason::Finished);
+    Host.Handle.destroy();
+}
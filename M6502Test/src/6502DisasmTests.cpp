@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sstream>
+#include "../../M6502Lib/src/m6502_disasm.h"
+
+class M6502DisasmTests : public testing::Test
+{
+public:
+    m6502::Byte Image[m6502::Mem::MAX_MEM];
+    m6502::CodeMap Map;
+
+    virtual void SetUp()
+    {
+        memset(Image, 0, sizeof(Image));
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    void Put(m6502::Word Address, std::initializer_list<m6502::Byte> Bytes)
+    {
+        for (m6502::Byte Value : Bytes)
+        {
+            Image[Address++] = Value;
+        }
+    }
+
+    // @return the cycles one instruction took, the CPU is left jammed if it was illegal
+    template <m6502::CPUVariant Variant>
+    static m6502::s32 RunOne(m6502::Byte Opcode, m6502::CPU& cpu)
+    {
+        using namespace m6502;
+        Mem mem;
+        cpu.Reset(0x0200, mem);
+        cpu.ThrowOnIllegalOpcode = false;
+        cpu.X = cpu.Y = 0xFF;
+        mem[0x0200] = Opcode;
+        mem[0x0201] = 0x80;
+        mem[0x0202] = 0x40;
+        return cpu.Execute<Variant>(1, mem);
+    }
+
+    template <m6502::CPUVariant Variant>
+    static void ExpectTableMatchesExecute()
+    {
+        using namespace m6502;
+        for (u32 Opcode = 0; Opcode < 256; Opcode++)
+        {
+            const OpcodeInfo* Info = OpcodeInfo::Decode((Byte)Opcode, Variant);
+            CPU cpu;
+            const s32 Cycles = RunOne<Variant>((Byte)Opcode, cpu);
+            EXPECT_EQ(cpu.Jammed, Info == nullptr) << "opcode " << Opcode;
+            if (!Info)
+            {
+                continue;
+            }
+            EXPECT_LE(Cycles, Info->MaxCycles) << Info->Name;
+            if (Info->Type == OpcodeKind::Load || Info->Type == OpcodeKind::Store)
+            {
+                EXPECT_EQ(cpu.PC, 0x0200 + Info->Length()) << Info->Name;
+            }
+        }
+    }
+};
+
+TEST_F(M6502DisasmTests, OpcodeTableMatchesWhatEachVariantExecutes)
+{
+    // given:
+    using namespace m6502;
+
+    // when:
+    // then:
+    ExpectTableMatchesExecute<CPUVariant::NMOS6502>();
+    ExpectTableMatchesExecute<CPUVariant::CMOS65C02>();
+    ExpectTableMatchesExecute<CPUVariant::RP2A03>();
+}
+
+TEST_F(M6502DisasmTests, FormatUsesAssemblerSyntax)
+{
+    // given:
+    using namespace m6502;
+    char Text[32];
+
+    // when:
+    // then:
+    OpcodeInfo::Decode(CPU::INS_LDA_INDY)->Format(0x10, Text, sizeof(Text));
+    EXPECT_STREQ(Text, "LDA ($10),Y");
+    OpcodeInfo::Decode(CPU::INS_STA_ABSX)->Format(0x1234, Text, sizeof(Text));
+    EXPECT_STREQ(Text, "STA $1234,X");
+    OpcodeInfo::Decode(CPU::INS_JMP_ABSX_IND, CPUVariant::CMOS65C02)->Format(0x1234, Text, sizeof(Text));
+    EXPECT_STREQ(Text, "JMP ($1234,X)");
+    EXPECT_EQ(OpcodeInfo::Decode(CPU::INS_JMP_ABSX_IND), nullptr);
+}
+
+TEST_F(M6502DisasmTests, TracesCallsJumpsAndVectorsIntoBlocks)
+{
+    // given:
+    using namespace m6502;
+    Put(0x8000, { CPU::INS_LDA_IM, 0x01, CPU::INS_JSR, 0x00, 0x90, CPU::INS_STA_ZP, 0x10, CPU::INS_JMP_ABS, 0x00, 0x80 });
+    Put(0x800A, { 0xDE, 0xAD });                            // Never reached
+    Put(0x9000, { CPU::INS_LDX_ZP, 0x10, CPU::INS_RTS });
+    Put(0x9100, { CPU::INS_JMP_IND, 0x00, 0xA0 });          // The NMI and IRQ handler
+    Put(0xA000, { 0x00, 0x90 });
+    Put(0xFFFA, { 0x00, 0x91, 0x00, 0x80, 0x00, 0x91 });
+
+    // when:
+    Map.Analyse(Image, CodeMap::VectorEntries(Image), CPUVariant::NMOS6502, 0x8000);
+
+    // then:
+    ASSERT_EQ(Map.Blocks.size(), 4u);
+    const CodeMap::Block& Main = *Map.FindBlock(0x8003);
+    EXPECT_EQ(Main.Start, 0x8000);
+    EXPECT_EQ(Main.Instructions, 2u);
+    ASSERT_EQ(Main.Successors.size(), 2u);
+    EXPECT_EQ(Main.Successors[0].Target, 0x9000);
+    EXPECT_EQ(Main.Successors[0].Type, CodeMap::EdgeType::Call);
+    EXPECT_EQ(Main.Successors[1].Target, 0x8005);
+    EXPECT_EQ(Main.Successors[1].Type, CodeMap::EdgeType::FallThrough);
+
+    const CodeMap::Block& Loop = *Map.FindBlock(0x8005);
+    EXPECT_EQ(Loop.Size, 5u);
+    ASSERT_EQ(Loop.Successors.size(), 1u);
+    EXPECT_EQ(Loop.Successors[0].Type, CodeMap::EdgeType::Jump);
+    EXPECT_EQ(Loop.Successors[0].Target, 0x8000);
+
+    const CodeMap::Block& Handler = *Map.FindBlock(0x9100);
+    ASSERT_EQ(Handler.Successors.size(), 1u);
+    EXPECT_EQ(Handler.Successors[0].Type, CodeMap::EdgeType::Indirect);
+    EXPECT_EQ(Handler.Successors[0].Target, 0x9000);
+
+    EXPECT_TRUE(Map.IsSubroutine(0x9000));
+    EXPECT_EQ(Map.Subroutines.size(), 1u);
+    EXPECT_EQ(Map.Types[0x8000], CodeMap::ByteType::Opcode);
+    EXPECT_EQ(Map.Types[0x8001], CodeMap::ByteType::Operand);
+    EXPECT_EQ(Map.Types[0x800A], CodeMap::ByteType::Data);
+    EXPECT_EQ(Map.Types[0xA000], CodeMap::ByteType::Data);
+    EXPECT_EQ(Map.FindBlock(0x800A), nullptr);
+    EXPECT_EQ(Map.Overlaps, 0u);
+}
+
+TEST_F(M6502DisasmTests, IllegalOpcodesAndTheRegionEndBlocks)
+{
+    // given:
+    using namespace m6502;
+    Put(0x0200, { CPU::INS_LDA_IM, 0x01, 0x02, CPU::INS_JMP_ABS, 0x00, 0x30 });
+    Put(0x0210, { CPU::INS_STZ_ZP, 0x10, CPU::INS_JMP_ABS, 0x00, 0x30 });
+
+    // when:
+    Map.Analyse(Image, { 0x0200, 0x0210 }, CPUVariant::NMOS6502, 0x0200, 0x0300);
+    CodeMap Cmos;
+    Cmos.Analyse(Image, { 0x0210 }, CPUVariant::CMOS65C02, 0x0200, 0x0300);
+
+    // then:
+    ASSERT_EQ(Map.Blocks.size(), 1u);
+    EXPECT_TRUE(Map.Blocks[0].EndsIllegal);
+    EXPECT_EQ(Map.Blocks[0].Instructions, 1u);
+    EXPECT_EQ(Map.Types[0x0210], CodeMap::ByteType::Data);
+
+    ASSERT_EQ(Cmos.Blocks.size(), 1u);
+    EXPECT_FALSE(Cmos.Blocks[0].EndsIllegal);
+    ASSERT_EQ(Cmos.Blocks[0].Successors.size(), 1u);
+    EXPECT_EQ(Cmos.Blocks[0].Successors[0].Target, 0x3000);
+    EXPECT_EQ(Cmos.Types[0x3000], CodeMap::ByteType::Data);
+}
+
+TEST_F(M6502DisasmTests, RegionsAreClampedToTheImage)
+{
+    // given:
+    using namespace m6502;
+    Put(0x0200, { CPU::INS_RTS });
+    Put(0xFFF0, { CPU::INS_RTS });
+    CodeMap Empty, Inverted, Past;
+
+    // when:
+    Empty.Analyse(Image, { 0x0200 }, CPUVariant::NMOS6502, 0, 0);
+    Inverted.Analyse(Image, { 0x0200 }, CPUVariant::NMOS6502, 0x0300, 0x0100);
+    Past.Analyse(Image, { 0xFFF0 }, CPUVariant::NMOS6502, 0xFF00, 0x20000);
+
+    // then:
+    EXPECT_TRUE(Empty.Blocks.empty());
+    EXPECT_TRUE(Empty.Listing(Image).empty());
+    EXPECT_TRUE(Inverted.Blocks.empty());
+    EXPECT_EQ(Inverted.RegionStart, Inverted.RegionEnd);
+    EXPECT_EQ(Past.RegionEnd, Mem::MAX_MEM);
+    ASSERT_EQ(Past.Blocks.size(), 1u);
+    EXPECT_EQ(Past.Blocks[0].Start, 0xFFF0);
+}
+
+TEST_F(M6502DisasmTests, JumpsIntoAnInstructionCountAsOverlaps)
+{
+    // given:
+    using namespace m6502;
+    Put(0x0200, { CPU::INS_LDA_ABS, CPU::INS_RTS, 0x02, CPU::INS_JMP_ABS, 0x01, 0x02 });
+
+    // when:
+    Map.Analyse(Image, { 0x0200 });
+
+    // then:
+    EXPECT_EQ(Map.Overlaps, 1u);
+    ASSERT_EQ(Map.Blocks.size(), 1u);
+    EXPECT_EQ(Map.Blocks[0].Instructions, 2u);
+}
+
+TEST_F(M6502DisasmTests, LongBlocksAreSplitAtTheLimit)
+{
+    // given:
+    using namespace m6502;
+    Put(0x0200, { CPU::INS_LDA_IM, 1, CPU::INS_LDA_IM, 2, CPU::INS_LDA_IM, 3, CPU::INS_LDA_IM, 4, CPU::INS_LDA_IM, 5, CPU::INS_RTS });
+    Map.MaxBlockInstructions = 2;
+
+    // when:
+    Map.Analyse(Image, { 0x0200 });
+
+    // then:
+    ASSERT_EQ(Map.Blocks.size(), 3u);
+    for (Word i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(Map.Blocks[i].Start, 0x0200 + i * 4);
+        EXPECT_EQ(Map.Blocks[i].Instructions, 2u);
+    }
+    ASSERT_EQ(Map.Blocks[0].Successors.size(), 1u);
+    EXPECT_EQ(Map.Blocks[0].Successors[0].Target, 0x0204);
+    EXPECT_EQ(Map.Blocks[0].Successors[0].Type, CodeMap::EdgeType::FallThrough);
+    EXPECT_EQ(Map.Blocks[1].Successors[0].Target, 0x0208);
+    EXPECT_TRUE(Map.Blocks[2].Successors.empty());
+}
+
+TEST_F(M6502DisasmTests, ExcludedCodeIsLeftOutOfBlocks)
+{
+    // given:
+    using namespace m6502;
+    Put(0x0200, { CPU::INS_LDA_IM, 1, CPU::INS_JSR, 0x00, 0x03, CPU::INS_LDX_IM, 2, CPU::INS_LDY_IM, 3, CPU::INS_RTS });
+    Put(0x0300, { CPU::INS_RTS });
+    Map.Excluded.assign(Mem::MAX_MEM, false);
+    Map.Excluded[0x0203] = true;                            // The JSR target may be patched
+    Map.Excluded[0x0207] = true;                            // And so may the LDY opcode
+
+    // when:
+    Map.Analyse(Image, { 0x0200 });
+
+    // then:
+    ASSERT_EQ(Map.Blocks.size(), 2u);
+    EXPECT_EQ(Map.Blocks[0].Start, 0x0200);
+    EXPECT_EQ(Map.Blocks[0].Instructions, 1u);
+    EXPECT_TRUE(Map.Blocks[0].EndsExcluded);
+    EXPECT_EQ(Map.Blocks[1].Start, 0x0205);
+    EXPECT_TRUE(Map.Blocks[1].EndsIllegal);
+    EXPECT_EQ(Map.Types[0x0202], CodeMap::ByteType::Opcode);
+    EXPECT_EQ(Map.FindBlock(0x0202), nullptr);
+    EXPECT_EQ(Map.Types[0x0207], CodeMap::ByteType::Data);
+    EXPECT_EQ(Map.Types[0x0300], CodeMap::ByteType::Data);
+    EXPECT_TRUE(Map.Subroutines.empty());
+}
+
+TEST_F(M6502DisasmTests, ListingLabelsBlocksAndShowsDataAsBytes)
+{
+    // given:
+    using namespace m6502;
+    Put(0x0200, { CPU::INS_JSR, 0x08, 0x02, CPU::INS_JMP_ABS, 0x00, 0x02, 0x11, 0x22, CPU::INS_RTS });
+
+    // when:
+    Map.Analyse(Image, { 0x0200 }, CPUVariant::NMOS6502, 0x0200, 0x0209);
+    const std::string Listing = Map.Listing(Image);
+    std::ostringstream Graph;
+    Map.WriteGraph(Graph);
+
+    // then:
+    EXPECT_NE(Listing.find("L_0200:\n0200  20 08 02    JSR $0208\n"), std::string::npos);
+    EXPECT_NE(Listing.find("0206  .byte $11,$22\n"), std::string::npos);
+    EXPECT_NE(Listing.find("sub_0208:\n0208  60          RTS\n"), std::string::npos);
+    EXPECT_NE(Graph.str().find("b0200 -> b0208 [style=dashed]"), std::string::npos);
+}
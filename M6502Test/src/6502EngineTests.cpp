@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "../../M6502Lib/src/m6502_engines.h"
+#include "../../M6502Lib/src/m6502_mapper.h"
+
+class M6502EngineTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+    m6502::Mem ReferenceMem;
+    m6502::CPU Reference;
+
+    // A loop with fusable pairs and a call, run by the switch on mem and by plain Execute on ReferenceMem
+    virtual void SetUp()
+    {
+        using namespace m6502;
+        const Byte Program[] =
+        {
+            CPU::INS_LDA_IM, 0x01,          // 0200
+            CPU::INS_STA_ZP, 0x10,          // 0202
+            CPU::INS_LDX_IM, 0x02,          // 0204
+            CPU::INS_LDY_IM, 0x03,          // 0206
+            CPU::INS_JSR, 0x00, 0x03,       // 0208
+            CPU::INS_LDA_ZP, 0x11,          // 020B
+            CPU::INS_STA_ABSX, 0x00, 0x40,  // 020D
+            CPU::INS_JMP_ABS, 0x00, 0x02,   // 0210
+        };
+        const Byte Subroutine[] =
+        {
+            CPU::INS_LDA_ZP, 0x10,
+            CPU::INS_STA_ZP, 0x11,
+            CPU::INS_RTS,
+        };
+        for (auto [Cpu, Memory] : { std::pair(&cpu, &mem), std::pair(&Reference, &ReferenceMem) })
+        {
+            Cpu->Reset(0x0200, *Memory);
+            Memory->Load(0x0200, Program, sizeof(Program));
+            Memory->Load(0x0300, Subroutine, sizeof(Subroutine));
+        }
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    void ExpectSameState(const m6502::CPU& Actual, const m6502::Mem& ActualMem)
+    {
+        EXPECT_EQ(Actual.PC, Reference.PC);
+        EXPECT_EQ(Actual.SP, Reference.SP);
+        EXPECT_EQ(Actual.A, Reference.A);
+        EXPECT_EQ(Actual.X, Reference.X);
+        EXPECT_EQ(Actual.Y, Reference.Y);
+        EXPECT_EQ(Actual.PS, Reference.PS);
+        EXPECT_EQ(Actual.Jammed, Reference.Jammed);
+        EXPECT_EQ(memcmp(ActualMem.Data, ReferenceMem.Data, m6502::Mem::MAX_MEM), 0);
+    }
+};
+
+TEST_F(M6502EngineTests, SwitchingAtAPCLeavesTheStateExecuteWouldHave)
+{
+    // given:
+    using namespace m6502;
+    EngineSwitch Machine(cpu, mem, Engine::Fast);
+    Machine.SwitchAtPC(Engine::Exact, 0x0204);
+
+    // when:
+    const s32 Used = Machine.Run(200);
+
+    // then:
+    EXPECT_EQ(Machine.Current, Engine::Exact);
+    EXPECT_EQ(Machine.Switches, 1u);
+    EXPECT_EQ(Machine.Cycles, (u64)Used);
+    EXPECT_EQ(mem[0x0204], CPU::INS_LDX_IM);
+    // The first pass reaches $0204 after LDA # and STA zp
+    EXPECT_EQ(Machine.LastSwitchCycle, 2u + 3u);
+    EXPECT_EQ(Reference.Execute(Used, ReferenceMem), Used);
+    ExpectSameState(Machine.Cpu, mem);
+}
+
+TEST_F(M6502EngineTests, SwitchingAtAPCLeavesBankedMemoryAlone)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] =
+    {
+        CPU::INS_LDA_IM, 0x01,          // 0200
+        CPU::INS_STA_ABS, 0x61, 0x9F,   // 0202 bank 1
+        CPU::INS_LDA_IM, 0x02,          // 0205
+        CPU::INS_STA_ABS, 0x00, 0xA0,   // 0207 store to the switch PC in bank 1
+        CPU::INS_LDA_IM, 0x00,          // 020A
+        CPU::INS_STA_ABS, 0x61, 0x9F,   // 020C bank 0
+        CPU::INS_LDA_ABS, 0x00, 0xA0,   // 020F read the switch PC as data
+        CPU::INS_STA_ZP, 0x10,          // 0212
+        CPU::INS_JMP_ABS, 0x00, 0xA0,   // 0214
+    };
+    const Byte Banked[] = { CPU::INS_LDX_IM, 0x55, CPU::INS_JMP_ABS, 0x00, 0xA0 };
+    RamBankMapper Mapper(2), ReferenceMapper(2);
+    for (auto [Memory, Banks] : { std::pair(&mem, &Mapper), std::pair(&ReferenceMem, &ReferenceMapper) })
+    {
+        Banks->Attach(*Memory);
+        Memory->Load(0x0200, Program, sizeof(Program));
+        Memory->Load(0xA000, Banked, sizeof(Banked));
+    }
+    EngineSwitch Machine(cpu, mem, Engine::Fast);
+    Machine.SwitchAtPC(Engine::Exact, 0xA000);
+
+    // when:
+    const s32 Used = Machine.Run(100);
+
+    // then:
+    EXPECT_EQ(Machine.Current, Engine::Exact);
+    EXPECT_EQ(Machine.LastSwitchCycle, (2u + 4u) * 3u + 4u + 3u + 3u);
+    EXPECT_EQ(Mapper.Ram[0], CPU::INS_LDX_IM);
+    EXPECT_EQ(Mapper.Ram[RamBankMapper::BANK_SIZE], 0x02);
+    EXPECT_EQ(mem[0x10], CPU::INS_LDX_IM);
+    EXPECT_EQ(Machine.Cpu.X, 0x55);
+    EXPECT_EQ(Reference.Execute(Used, ReferenceMem), Used);
+    ExpectSameState(Machine.Cpu, mem);
+    EXPECT_EQ(Mapper.Ram, ReferenceMapper.Ram);
+#ifdef M6502_STATE_HASH
+    const u64 Hash = mem.Hash;
+    mem.RecomputeHash();
+    EXPECT_EQ(Hash, mem.Hash);
+#endif
+}
+
+TEST_F(M6502EngineTests, SwitchingAtACycleMatchesExecuteFromEveryEngine)
+{
+    // given:
+    using namespace m6502;
+    for (Engine From : { Engine::Fast, Engine::Exact, Engine::Ticked })
+    {
+        for (Engine To : { Engine::Fast, Engine::Exact, Engine::Ticked })
+        {
+            SetUp();
+            EngineSwitch Machine(cpu, mem, From);
+            Machine.SwitchAtCycle(To, 333);
+
+            // when:
+            u64 Used = 0;
+            for (s32 Slice : { 100, 250, 7, 1000 })
+            {
+                Used += Machine.Run(Slice);
+            }
+
+            // then:
+            EXPECT_EQ(Machine.Current, To);
+            EXPECT_GE(Machine.LastSwitchCycle, 333u);
+            EXPECT_LT(Machine.LastSwitchCycle, 333u + 7u);
+            EXPECT_EQ(Machine.Cycles, Used);
+            // The ticked engine can end a slice halfway through an instruction, finish it
+            s32 Owed = 0;
+            for (; !Machine.Cpu.AtInstructionBoundary(); Owed++)
+            {
+                Machine.Cpu.Tick(mem);
+            }
+            EXPECT_EQ((u64)Reference.Execute((s32)Used, ReferenceMem), Used + Owed);
+            ExpectSameState(Machine.Cpu, mem);
+        }
+    }
+}
+
+TEST_F(M6502EngineTests, LeavingTheTickedEngineHalfwayPaysTheRestOfTheInstruction)
+{
+    // given:
+    using namespace m6502;
+    EngineSwitch Machine(cpu, mem, Engine::Ticked);
+    Machine.Run(3);     // LDA # and the first cycle of STA zp
+    ASSERT_FALSE(Machine.Cpu.AtInstructionBoundary());
+
+    // when:
+    Machine.SwitchNow(Engine::Exact);
+    const s32 Used = Machine.Run(1);
+
+    // then:
+    EXPECT_EQ(Machine.Current, Engine::Exact);
+    EXPECT_EQ(Machine.LastSwitchCycle, 5u);
+    EXPECT_TRUE(Machine.Cpu.AtInstructionBoundary());
+    EXPECT_EQ(Used, 2);
+    EXPECT_EQ(Machine.Cycles, 5u);
+    Reference.Execute(5, ReferenceMem);
+    ExpectSameState(Machine.Cpu, mem);
+}
+
+TEST_F(M6502EngineTests, QueuedInputCarriesAcrossASwitch)
+{
+    // given:
+    using namespace m6502;
+    InputQueue Queue;
+    ASSERT_TRUE(Queue.Push({ 40, 0x0050, 0x77 }));
+    ASSERT_TRUE(Queue.Push({ 120, 0x0051, 0x99 }));
+    EngineSwitch Machine(cpu, mem, Engine::Fast);
+    Machine.Input = &Queue;
+    Machine.SwitchAtPC(Engine::Ticked, 0x020B);
+
+    // when:
+    const s32 Used = Machine.Run(60);
+    Machine.Run(100);
+
+    // then:
+    EXPECT_EQ(Machine.Current, Engine::Ticked);
+    EXPECT_EQ(Queue.CurrentCycle(), Machine.Cycles);
+    EXPECT_GE(Used, 60);
+    EXPECT_EQ(mem[0x0050], 0x77);
+    EXPECT_EQ(mem[0x0051], 0x99);
+}
+
+TEST_F(M6502EngineTests, IllegalOpcodesStillThrowWhileASwitchIsPending)
+{
+    // given:
+    using namespace m6502;
+    mem[0x0210] = 0xFF;
+    EngineSwitch Machine(cpu, mem, Engine::Fast);
+    Machine.SwitchAtPC(Engine::Exact, 0x0300);
+
+    // when:
+    // then:
+    EXPECT_THROW(Machine.Run(1000), int);
+    EXPECT_EQ(mem[0x0300], CPU::INS_LDA_ZP);
+    EXPECT_TRUE(Machine.Cpu.ThrowOnIllegalOpcode);
+}
+
+TEST_F(M6502EngineTests, AFastEngineCanBeSwappedIn)
+{
+    // given:
+    using namespace m6502;
+    static u32 Calls;
+    Calls = 0;
+    EngineSwitch Machine(cpu, mem, Engine::Fast);
+    Machine.SetFastEngine([](CPU& Cpu, Mem& Memory, s32 Cycles)
+    {
+        Calls++;
+        return Cpu.Execute(Cycles, Memory);
+    });
+    Machine.SwitchAtCycle(Engine::Exact, 50);
+
+    // when:
+    Machine.Run(100);
+
+    // then:
+    EXPECT_EQ(Calls, 1u);
+    EXPECT_EQ(Machine.Current, Engine::Exact);
+}
@@ -0,0 +1,163 @@
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_opcodeprofile.h"
+
+class M6502FusionTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0x0200, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    /*
+     * Run the program fused and unfused with every budget up to past its end,
+     * so fusions that get cut off by the budget are covered too
+     */
+    void VerifyFusedMatchesUnfused(const std::vector<m6502::Byte>& Program, m6502::s32 TotalCycles)
+    {
+        using namespace m6502;
+        mem.Load(0x0200, Program.data(), (u32)Program.size());
+        cpu.X = 0x04;
+        cpu.Y = 0xFF;
+        mem[0x0014] = 0x80;
+        mem[0x4400] = 0x37;
+
+        for (s32 Budget = 1; Budget <= TotalCycles; Budget++)
+        {
+            // given:
+            CPU Unfused = cpu;
+            CPU Fused = cpu;
+            Mem UnfusedMem = mem;
+            Mem FusedMem = mem;
+
+            // when:
+            const s32 UnfusedCycles = Unfused.Execute(Budget, UnfusedMem);
+            const s32 FusedCycles = Fused.ExecuteFused(Budget, FusedMem);
+
+            // then:
+            EXPECT_EQ(FusedCycles, UnfusedCycles) << "budget " << Budget;
+            EXPECT_EQ(Fused.PC, Unfused.PC) << "budget " << Budget;
+            EXPECT_EQ(Fused.SP, Unfused.SP) << "budget " << Budget;
+            EXPECT_EQ(Fused.A, Unfused.A) << "budget " << Budget;
+            EXPECT_EQ(Fused.X, Unfused.X) << "budget " << Budget;
+            EXPECT_EQ(Fused.Y, Unfused.Y) << "budget " << Budget;
+            EXPECT_EQ(Fused.PS, Unfused.PS) << "budget " << Budget;
+            EXPECT_EQ(memcmp(FusedMem.Data, UnfusedMem.Data, Mem::MAX_MEM), 0) << "budget " << Budget;
+        }
+    }
+};
+
+TEST_F(M6502FusionTests, LDAImmediateSTAAbsoluteMatchesUnfused)
+{
+    using namespace m6502;
+    VerifyFusedMatchesUnfused({ CPU::INS_LDA_IM, 0x80, CPU::INS_STA_ABS, 0x00, 0x30, CPU::INS_LDA_IM, 0x00 }, 2 + 4 + 2);
+}
+
+TEST_F(M6502FusionTests, LDAImmediateSTAZeroPageMatchesUnfused)
+{
+    using namespace m6502;
+    VerifyFusedMatchesUnfused({ CPU::INS_LDA_IM, 0x00, CPU::INS_STA_ZP, 0x20, CPU::INS_LDA_IM, 0x42, CPU::INS_STA_ZP, 0x21 }, (2 + 3) * 2);
+}
+
+TEST_F(M6502FusionTests, LDAZeroPageXSTAAbsoluteYMatchesUnfused)
+{
+    using namespace m6502;
+    // 0x4401 + 0xFF crosses a page, STA abs,Y always takes 5 cycles
+    VerifyFusedMatchesUnfused({ CPU::INS_LDA_ZPX, 0x10, CPU::INS_STA_ABSY, 0x01, 0x44 }, 4 + 5);
+}
+
+TEST_F(M6502FusionTests, LDAAbsoluteSTAAbsoluteMatchesUnfused)
+{
+    using namespace m6502;
+    VerifyFusedMatchesUnfused({ CPU::INS_LDA_ABS, 0x00, 0x44, CPU::INS_STA_ABS, 0x00, 0x45 }, 4 + 4);
+}
+
+TEST_F(M6502FusionTests, LDXLDYJSRTripleMatchesUnfused)
+{
+    using namespace m6502;
+    mem[0x8000] = CPU::INS_STX_ZP;
+    mem[0x8001] = 0x30;
+    mem[0x8002] = CPU::INS_RTS;
+    VerifyFusedMatchesUnfused({ CPU::INS_LDX_IM, 0x01, CPU::INS_LDY_IM, 0x02, CPU::INS_JSR, 0x00, 0x80, CPU::INS_LDA_IM, 0x00 }, 2 + 2 + 6 + 3 + 6 + 2);
+}
+
+TEST_F(M6502FusionTests, FusedPairAtTheEndOfMemoryWrapsLikeExecute)
+{
+    // given:
+    using namespace m6502;
+    cpu.PC = 0xFFFE;
+    mem[0xFFFE] = CPU::INS_LDA_IM;
+    mem[0xFFFF] = 0x42;
+    mem[0x0000] = CPU::INS_STA_ZP;
+    mem[0x0001] = 0x10;
+    CPU Unfused = cpu;
+    Mem UnfusedMem = mem;
+
+    // when:
+    const s32 FusedCycles = cpu.ExecuteFused(2 + 3, mem);
+    const s32 UnfusedCycles = Unfused.Execute(2 + 3, UnfusedMem);
+
+    // then:
+    EXPECT_EQ(FusedCycles, UnfusedCycles);
+    EXPECT_EQ(cpu.PC, Unfused.PC);
+    EXPECT_EQ(mem[0x0010], 0x42);
+}
+
+TEST_F(M6502FusionTests, ExecuteFusedToStopsOnEveryInstructionOfAFusedRun)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] = { CPU::INS_LDX_IM, 0x01, CPU::INS_LDY_IM, 0x02, CPU::INS_JSR, 0x00, 0x80 };
+    mem.Load(0x0200, Program, sizeof(Program));
+    const Byte Original = mem[0x0204];
+    const std::pair<Word, s32> Stops[] = { { 0x0200, 0 }, { 0x0202, 2 }, { 0x0204, 2 + 2 }, { 0x8000, 2 + 2 + 6 } };
+    for (auto [StopPC, Cycles] : Stops)
+    {
+        CPU Fused = cpu;
+        CPU Exact = cpu;
+
+        // when:
+        const s32 FusedCycles = Fused.ExecuteFusedTo(StopPC, 100, mem);
+        const s32 ExactCycles = Exact.ExecuteTo(StopPC, 100, mem);
+
+        // then:
+        EXPECT_EQ(FusedCycles, Cycles) << StopPC;
+        EXPECT_EQ(ExactCycles, Cycles) << StopPC;
+        EXPECT_EQ(Fused.PC, StopPC);
+        EXPECT_EQ(Exact.PC, StopPC);
+        EXPECT_EQ(Fused.Stopped, CPU::StopReason::ReachedPC);
+        EXPECT_EQ(Exact.Stopped, CPU::StopReason::ReachedPC);
+    }
+    EXPECT_EQ(mem[0x0204], Original);
+}
+
+TEST_F(M6502FusionTests, OpcodeProfileCountsAdjacentPairs)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] = { CPU::INS_LDA_IM, 0x01, CPU::INS_STA_ZP, 0x10, CPU::INS_JMP_ABS, 0x00, 0x02 };
+    mem.Load(0x0200, Program, sizeof(Program));
+    auto Profile = std::make_unique<OpcodeProfile>();
+
+    // when:
+    Profile->Record(cpu, mem, (2 + 3 + 3) * 10);
+
+    // then:
+    EXPECT_EQ(Profile->Count[CPU::INS_LDA_IM], 10u);
+    EXPECT_EQ(Profile->Pairs[CPU::INS_LDA_IM][CPU::INS_STA_ZP], 10u);
+    EXPECT_EQ(Profile->Pairs[CPU::INS_JMP_ABS][CPU::INS_LDA_IM], 9u);
+    const auto Top = Profile->TopPairs(1);
+    ASSERT_EQ(Top.size(), 1u);
+    EXPECT_EQ(Top[0].Count, 10u);
+}
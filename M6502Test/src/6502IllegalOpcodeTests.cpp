@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+
+class M6502IllegalOpcodeTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0xFFFC, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+};
+
+TEST_F(M6502IllegalOpcodeTests, IllegalOpcodeThrowsByDefault)
+{
+    // given:
+    using namespace m6502;
+    mem[0xFFFC] = 0x02;
+
+    // when/then:
+    EXPECT_ANY_THROW(cpu.Execute(2, mem));
+}
+
+TEST_F(M6502IllegalOpcodeTests, IllegalOpcodeJamsTheCPUWhenThrowingIsDisabled)
+{
+    // given:
+    using namespace m6502;
+    cpu.ThrowOnIllegalOpcode = false;
+    mem[0xFFFC] = CPU::INS_LDA_IM;
+    mem[0xFFFD] = 0x42;
+    mem[0xFFFE] = 0x02;
+    constexpr s32 EXPECTED_CYCLES = 2 + 1;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(100, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, EXPECTED_CYCLES);
+    EXPECT_TRUE(cpu.Jammed);
+    EXPECT_EQ(cpu.PC, 0xFFFE);
+    EXPECT_EQ(cpu.A, 0x42);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <thread>
+#include "../../M6502Lib/src/m6502_input.h"
+
+class M6502InputTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+    m6502::InputQueue Queue;
+
+    // Copies the byte at 0x4000 to 0x5000 in an 11 cycle loop
+    static void Boot(m6502::CPU& Cpu, m6502::Mem& Memory)
+    {
+        using namespace m6502;
+        const Byte Program[] =
+        {
+            CPU::INS_LDA_ABS, 0x00, 0x40,
+            CPU::INS_STA_ABS, 0x00, 0x50,
+            CPU::INS_JMP_ABS, 0x00, 0x02,
+        };
+        Cpu.Reset(0x0200, Memory);
+        Memory.Load(0x0200, Program, sizeof(Program));
+    }
+
+    virtual void SetUp()
+    {
+        Boot(cpu, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+};
+
+TEST_F(M6502InputTests, EventsApplyAtTheFirstInstructionBoundaryFromTheirCycle)
+{
+    // given:
+    using namespace m6502;
+    ASSERT_TRUE(Queue.Push({ 110, 0x4000, 7 }));
+    ASSERT_TRUE(Queue.Push({ 112, 0x4000, 9 }));
+    std::vector<InputQueue::Event> Log;
+
+    // when:
+    const s32 Used = Queue.Execute(cpu, mem, 1000, &Log);
+
+    // then:
+    EXPECT_GE(Used, 1000);
+    EXPECT_EQ(Queue.CurrentCycle(), (u64)Used);
+    ASSERT_EQ(Log.size(), 2u);
+    EXPECT_EQ(Log[0].Cycle, 110u);
+    EXPECT_EQ(Log[0].Value, 7);
+    EXPECT_EQ(Log[1].Cycle, 114u);
+    EXPECT_EQ(Log[1].Value, 9);
+    EXPECT_EQ(mem[0x5000], 9);
+}
+
+TEST_F(M6502InputTests, ResultsDoNotDependOnTheSliceSize)
+{
+    // given:
+    using namespace m6502;
+    Mem OtherMem;
+    CPU OtherCpu;
+    Boot(OtherCpu, OtherMem);
+    InputQueue OtherQueue;
+    for (u64 i = 1; i <= 50; i++)
+    {
+        Queue.Push({ i * 97, (Word)(0x4000 + (i & 1)), (Byte)i });
+        OtherQueue.Push({ i * 97, (Word)(0x4000 + (i & 1)), (Byte)i });
+    }
+    std::vector<InputQueue::Event> Log, OtherLog;
+
+    // when:
+    while (Queue.CurrentCycle() < 6000)
+    {
+        Queue.Execute(cpu, mem, 1000, &Log);
+    }
+    while (OtherQueue.CurrentCycle() < Queue.CurrentCycle())
+    {
+        OtherQueue.Execute(OtherCpu, OtherMem, std::min<s32>(37, (s32)(Queue.CurrentCycle() - OtherQueue.CurrentCycle())), &OtherLog);
+    }
+
+    // then:
+    EXPECT_EQ(OtherQueue.CurrentCycle(), Queue.CurrentCycle());
+    EXPECT_EQ(OtherCpu.PC, cpu.PC);
+    EXPECT_EQ(OtherCpu.A, cpu.A);
+    EXPECT_EQ(memcmp(OtherMem.Data, mem.Data, Mem::MAX_MEM), 0);
+    ASSERT_EQ(OtherLog.size(), Log.size());
+    for (size_t i = 0; i < Log.size(); i++)
+    {
+        EXPECT_EQ(OtherLog[i].Cycle, Log[i].Cycle);
+    }
+}
+
+TEST_F(M6502InputTests, LateEventsApplyAtTheStartOfTheNextSlice)
+{
+    // given:
+    using namespace m6502;
+    Queue.Execute(cpu, mem, 500);
+    const u64 Now = Queue.CurrentCycle();
+    Queue.Push({ 0, 0x4000, 5 });
+    std::vector<InputQueue::Event> Log;
+
+    // when:
+    Queue.Execute(cpu, mem, 100, &Log);
+
+    // then:
+    ASSERT_EQ(Log.size(), 1u);
+    EXPECT_EQ(Log[0].Cycle, Now);
+    EXPECT_EQ(mem[0x5000], 5);
+}
+
+TEST_F(M6502InputTests, PushFailsWhenTheQueueIsFull)
+{
+    // given:
+    using namespace m6502;
+    for (u32 i = 0; i < InputQueue::CAPACITY; i++)
+    {
+        ASSERT_TRUE(Queue.Push({ i, 0x4000, (Byte)i }));
+    }
+
+    // when:
+    const bool Pushed = Queue.Push({ 0, 0x4000, 0 });
+    Queue.Execute(cpu, mem, 11);
+
+    // then:
+    EXPECT_FALSE(Pushed);
+    EXPECT_TRUE(Queue.Push({ 0, 0x4000, 0 }));
+}
+
+TEST_F(M6502InputTests, EventsFromAnotherThreadArriveInOrder)
+{
+    // given:
+    using namespace m6502;
+    constexpr u32 Events = 20000;
+    std::thread Producer([this]
+    {
+        for (u32 i = 0; i < Events; i++)
+        {
+            while (!Queue.Push({ i * 5, (Word)(0x4000 + (i & 0xFF)), (Byte)i }))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::vector<InputQueue::Event> Log;
+
+    // when:
+    while (Log.size() < Events)
+    {
+        Queue.Execute(cpu, mem, 1000, &Log);
+    }
+    Producer.join();
+
+    // then:
+    for (u32 i = 0; i < Events; i++)
+    {
+        ASSERT_EQ(Log[i].Value, (Byte)i);
+        ASSERT_EQ(Log[i].Address, 0x4000 + (i & 0xFF));
+        ASSERT_GE(Log[i].Cycle, i * 5u);
+    }
+}
@@ -127,4 +127,180 @@ TEST_F(M6502JumpsAndCallsTests, JumpIndirectCanJumpToANewLocationInTheProgram)
     EXPECT_EQ(cpu.PS, CPUCopy.PS);
     EXPECT_EQ(cpu.SP, CPUCopy.SP);
     EXPECT_EQ(cpu.PC, 0x9000);
-}
\ No newline at end of file
+}
+
+TEST_F(M6502JumpsAndCallsTests, JSRAndRTSWrapTheStackAroundPageOne)
+{
+    // given:
+    using namespace m6502;
+    cpu.Reset(0xFF00, mem);
+    cpu.SP = 0x00;
+    mem[0xFF00] = CPU::INS_JSR;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0x80;
+    mem[0x8000] = CPU::INS_RTS;
+    constexpr s32 EXPECTED_CYCLES = 6 + 6;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(EXPECTED_CYCLES, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, EXPECTED_CYCLES);
+    EXPECT_EQ(mem[0x0100], 0xFF);
+    EXPECT_EQ(mem[0x01FF], 0x02);
+    EXPECT_EQ(mem[0x00FF], 0x00);
+    EXPECT_EQ(cpu.SP, 0x00);
+    EXPECT_EQ(cpu.PC, 0xFF03);
+}
+
+TEST_F(M6502JumpsAndCallsTests, JMPToItselfFastForwardsButUsesTheSameCycles)
+{
+    // given:
+    using namespace m6502;
+    cpu.Reset(0xFF00, mem);
+    mem[0xFF00] = CPU::INS_JMP_ABS;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0xFF;
+    CPU CPUCopy = cpu;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(1000000, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 1000002);
+    EXPECT_EQ(cpu.PC, 0xFF00);
+    EXPECT_EQ(cpu.A, CPUCopy.A);
+    EXPECT_EQ(cpu.PS, CPUCopy.PS);
+    EXPECT_EQ(cpu.SP, CPUCopy.SP);
+}
+
+TEST_F(M6502JumpsAndCallsTests, JMPIndirectToItselfFastForwardsButUsesTheSameCycles)
+{
+    // given:
+    using namespace m6502;
+    cpu.Reset(0xFF00, mem);
+    mem[0xFF00] = CPU::INS_JMP_IND;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0x80;
+    mem[0x8000] = 0x00;
+    mem[0x8001] = 0xFF;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(1001, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 1005);
+    EXPECT_EQ(cpu.PC, 0xFF00);
+}
+
+/*
+ * Execute(1) never fast-forwards (each call drops the loop snapshot), so
+ * stepping gives the reference result for idle loops
+ */
+static void ExpectIdleLoopMatchesStepping(m6502::CPU cpu, const m6502::Mem& mem, m6502::s32 Budget)
+{
+    using namespace m6502;
+    CPU Stepped = cpu;
+    Mem SteppedMem = mem;
+    Mem FastMem = mem;
+    s32 SteppedCycles = 0;
+    while (SteppedCycles < Budget)
+    {
+        SteppedCycles += Stepped.Execute(1, SteppedMem);
+    }
+
+    const s32 FastCycles = cpu.Execute(Budget, FastMem);
+
+    EXPECT_EQ(FastCycles, SteppedCycles) << "budget " << Budget;
+    EXPECT_EQ(cpu.PC, Stepped.PC) << "budget " << Budget;
+    EXPECT_EQ(cpu.A, Stepped.A) << "budget " << Budget;
+    EXPECT_EQ(cpu.X, Stepped.X) << "budget " << Budget;
+    EXPECT_EQ(cpu.Y, Stepped.Y) << "budget " << Budget;
+    EXPECT_EQ(cpu.PS, Stepped.PS) << "budget " << Budget;
+}
+
+TEST_F(M6502JumpsAndCallsTests, PollingLoopFastForwardMatchesStepping)
+{
+    // given:
+    using namespace m6502;
+    cpu.Reset(0x0200, mem);
+    cpu.X = 0x01;
+    // LDA zp,X depends on the X loaded in the previous pass, the loop only
+    // settles on its second pass
+    mem[0x0200] = CPU::INS_LDA_ZPX;
+    mem[0x0201] = 0x10;
+    mem[0x0202] = CPU::INS_LDX_ABS;
+    mem[0x0203] = 0x00;
+    mem[0x0204] = 0x40;
+    mem[0x0205] = CPU::INS_LDY_ABSX;
+    mem[0x0206] = 0xFF;
+    mem[0x0207] = 0x40;
+    mem[0x0208] = CPU::INS_JMP_ABS;
+    mem[0x0209] = 0x00;
+    mem[0x020A] = 0x02;
+    mem[0x4000] = 0x03;
+    mem[0x0011] = 0x80;
+    mem[0x0013] = 0x00;
+
+    // when/then:
+    for (s32 Budget = 1; Budget < 80; Budget++)
+    {
+        ExpectIdleLoopMatchesStepping(cpu, mem, Budget);
+    }
+    ExpectIdleLoopMatchesStepping(cpu, mem, 100000);
+}
+
+TEST_F(M6502JumpsAndCallsTests, LoadLoopThatNeverSettlesIsNotSkipped)
+{
+    // given:
+    using namespace m6502;
+    cpu.Reset(0x0200, mem);
+    // X walks the cycle 0 -> 1 -> 2 -> 0, no two passes end alike
+    mem[0x0200] = CPU::INS_LDX_ABSY;
+    mem[0x0201] = 0x00;
+    mem[0x0202] = 0x40;
+    mem[0x0203] = CPU::INS_LDY_ABSX;
+    mem[0x0204] = 0x00;
+    mem[0x0205] = 0x40;
+    mem[0x0206] = CPU::INS_JMP_ABS;
+    mem[0x0207] = 0x00;
+    mem[0x0208] = 0x02;
+    mem[0x4000] = 0x01;
+    mem[0x4001] = 0x02;
+    mem[0x4002] = 0x00;
+
+    // when/then:
+    for (s32 Budget = 1; Budget < 60; Budget++)
+    {
+        ExpectIdleLoopMatchesStepping(cpu, mem, Budget);
+    }
+    ExpectIdleLoopMatchesStepping(cpu, mem, 10007);
+}
+
+TEST_F(M6502JumpsAndCallsTests, LoopWithAStoreIsNotSkipped)
+{
+    // given:
+    using namespace m6502;
+    struct CountingMapper : Mapper
+    {
+        u32 Writes = 0;
+        void Write(Mem&, Word, Byte) override { Writes++; }
+    } Device;
+    cpu.Reset(0x0200, mem);
+    mem.AttachedMapper = &Device;
+    mem.MapWindow(0xD000 >> Mem::WINDOW_SHIFT, mem.Data + 0xD000, nullptr);
+    mem[0x0200] = CPU::INS_STA_ABS;
+    mem[0x0201] = 0x00;
+    mem[0x0202] = 0xD0;
+    mem[0x0203] = CPU::INS_JMP_ABS;
+    mem[0x0204] = 0x00;
+    mem[0x0205] = 0x02;
+    constexpr u32 PASSES = 1000;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute((4 + 3) * PASSES, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, (4 + 3) * PASSES);
+    EXPECT_EQ(Device.Writes, PASSES);
+}
@@ -478,6 +478,45 @@ TEST_F(M6502LoadRegisterTests, LDAIndirectXCanLoadAValueIntoTheARegister)
     VerifyUnmodifiedFlagsFromLoadRegister(cpu, CPUCopy);
 }
 
+TEST_F(M6502LoadRegisterTests, LDAIndirectXWrapsThePointerAroundTheZeroPage)
+{
+    // given:
+    using namespace m6502;
+    cpu.X = 0x04;
+    mem[0xFFFC] = CPU::INS_LDA_INDX;
+    mem[0xFFFD] = 0xFB;
+    mem[0x00FF] = 0x00; // 0xFB + 0x4
+    mem[0x0000] = 0x80; // not 0x0100
+    mem[0x8000] = 0x37;
+    constexpr s32 EXPECTED_CYCLES = 6;
+
+    // when:
+    s32 CyclesUsed = cpu.Execute(EXPECTED_CYCLES, mem);
+
+    // then:
+    EXPECT_EQ(cpu.A, 0x37);
+    EXPECT_EQ(CyclesUsed, EXPECTED_CYCLES);
+}
+
+TEST_F(M6502LoadRegisterTests, LDAAbsoluteXDoesNotTakeAnExtraCycleWithinAPage)
+{
+    // given:
+    using namespace m6502;
+    cpu.X = 0xFF;
+    mem[0xFFFC] = CPU::INS_LDA_ABSX;
+    mem[0xFFFD] = 0x00;
+    mem[0xFFFE] = 0x44; // 0x4400
+    mem[0x44FF] = 0x37; // 0x4400 + 0xFF (same page)
+    constexpr s32 EXPECTED_CYCLES = 4;
+
+    // when:
+    s32 CyclesUsed = cpu.Execute(EXPECTED_CYCLES, mem);
+
+    // then:
+    EXPECT_EQ(cpu.A, 0x37);
+    EXPECT_EQ(CyclesUsed, EXPECTED_CYCLES);
+}
+
 TEST_F(M6502LoadRegisterTests, LDAIndirectYCanLoadAValueIntoTheARegister)
 {
     // given:
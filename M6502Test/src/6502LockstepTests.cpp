@@ -0,0 +1,261 @@
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_lockstep.h"
+
+class M6502LockstepTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+
+    virtual void SetUp()
+    {
+        mem.Initialise();
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    m6502::CPU CPUAt(m6502::Word PC)
+    {
+        m6502::CPU cpu;
+        cpu.PC = PC;
+        cpu.SP = 0xFF;
+        cpu.PS = 0;
+        cpu.A = cpu.X = cpu.Y = 0;
+        return cpu;
+    }
+
+    // Takes every write to a snapshot, in order
+    struct StoreRecorder : m6502::Mapper
+    {
+        std::vector<std::pair<m6502::Word, m6502::Byte>> Stores;
+
+        void Write(m6502::Mem& memory, m6502::Word Address, m6502::Byte Value) override
+        {
+            memory.StoreData(Address, Value);
+            Stores.push_back({ Address, Value });
+        }
+    };
+
+    /*
+     * The lockstep semantics done the slow, obvious way: each quantum every
+     * CPU executes on a whole snapshot of the shared RAM, then every store
+     * is replayed onto it in CPU order and program order
+     */
+    static void RunReference(m6502::Mem& Shared, std::vector<m6502::CPU>& Cpus, m6502::s32 Quantum, m6502::u32 Quanta)
+    {
+        using namespace m6502;
+        std::vector<s32> Carry(Cpus.size());
+        auto Snapshot = std::make_unique<Mem>();
+        for (u32 Step = 0; Step < Quanta; Step++)
+        {
+            std::vector<StoreRecorder> Recorders(Cpus.size());
+            for (u32 Index = 0; Index < Cpus.size(); Index++)
+            {
+                *Snapshot = Shared;
+                Snapshot->MapRange(0, Mem::MAX_MEM, Snapshot->Data, nullptr);
+                Snapshot->AttachedMapper = &Recorders[Index];
+                const s32 Budget = Quantum + Carry[Index];
+                const s32 Used = Cpus[Index].Execute(Budget, *Snapshot);
+                Carry[Index] = Cpus[Index].Jammed ? 0 : Budget - Used;
+            }
+            for (const StoreRecorder& Recorder : Recorders)
+            {
+                for (const auto& [Address, Value] : Recorder.Stores)
+                {
+                    Shared[Address] = Value;
+                }
+            }
+        }
+    }
+
+    // Each CPU keeps copying the byte the CPU before it writes to its own byte
+    void LoadRelayPrograms(m6502::u32 NumCpus)
+    {
+        using namespace m6502;
+        for (u32 Index = 0; Index < NumCpus; Index++)
+        {
+            const Byte Program[] =
+            {
+                CPU::INS_LDX_ZP, (Byte)(0x20 + Index),
+                CPU::INS_STX_ZP, (Byte)(0x21 + Index),
+                CPU::INS_STX_ABS, (Byte)Index, 0x30,
+                CPU::INS_LDA_ABS, 0x00, 0x30,
+                CPU::INS_STA_ZPX, 0x40,
+                CPU::INS_JMP_ABS, 0x00, (Byte)(0x10 + Index),
+            };
+            mem.Load((Word)((0x10 + Index) << 8), Program, sizeof(Program));
+        }
+        mem[0x20] = 0x5A;
+    }
+};
+
+TEST_F(M6502LockstepTests, WritesAreSeenByTheOtherCPUsFromTheNextQuantum)
+{
+    // given:
+    using namespace m6502;
+    const Byte Writer[] = { CPU::INS_LDA_IM, 0xAA, CPU::INS_STA_ZP, 0x10, CPU::INS_JMP_ABS, 0x04, 0x02 };
+    const Byte Reader[] = { CPU::INS_LDX_ZP, 0x10, CPU::INS_STX_ZP, 0x11, CPU::INS_JMP_ABS, 0x00, 0x04 };
+    mem.Load(0x0200, Writer, sizeof(Writer));
+    mem.Load(0x0400, Reader, sizeof(Reader));
+    LockstepSystem System(mem, 100);
+    System.Add(CPUAt(0x0200));
+    System.Add(CPUAt(0x0400));
+
+    // when:
+    System.RunSerial(1);
+    const Byte AfterFirst = mem[0x11];
+    System.RunSerial(1);
+
+    // then:
+    EXPECT_EQ(mem[0x10], 0xAA);
+    EXPECT_EQ(AfterFirst, 0x00);
+    EXPECT_EQ(mem[0x11], 0xAA);
+}
+
+TEST_F(M6502LockstepTests, ConflictingWritesGoInCPUOrder)
+{
+    // given:
+    using namespace m6502;
+    const Byte First[] = { CPU::INS_LDA_IM, 0x01, CPU::INS_STA_ABS, 0x00, 0x30, CPU::INS_JMP_ABS, 0x05, 0x02 };
+    const Byte Second[] = { CPU::INS_LDA_IM, 0x02, CPU::INS_STA_ABS, 0x00, 0x30, CPU::INS_JMP_ABS, 0x05, 0x04 };
+    mem.Load(0x0200, First, sizeof(First));
+    mem.Load(0x0400, Second, sizeof(Second));
+    LockstepSystem System(mem, 50);
+    System.Add(CPUAt(0x0200));
+    System.Add(CPUAt(0x0400));
+
+    // when:
+    System.Run(3);
+
+    // then:
+    EXPECT_EQ(mem[0x3000], 0x02);
+    EXPECT_EQ(System.QuantaRun, 3u);
+}
+
+TEST_F(M6502LockstepTests, AHigherCPUStoringTheValueAlreadyThereStillWins)
+{
+    // given:
+    using namespace m6502;
+    const Byte First[] = { CPU::INS_LDA_IM, 0x01, CPU::INS_STA_ABS, 0x00, 0x30, CPU::INS_JMP_ABS, 0x00, 0x02 };
+    const Byte Second[] = { CPU::INS_LDA_IM, 0x02, CPU::INS_STA_ABS, 0x00, 0x30, CPU::INS_JMP_ABS, 0x00, 0x04 };
+    mem.Load(0x0200, First, sizeof(First));
+    mem.Load(0x0400, Second, sizeof(Second));
+    mem[0x3000] = 0x02;
+    LockstepSystem System(mem, 50);
+    System.Add(CPUAt(0x0200));
+    System.Add(CPUAt(0x0400));
+
+    // when:
+    System.Run(1);
+
+    // then:
+    EXPECT_EQ(mem[0x3000], 0x02);
+}
+
+TEST_F(M6502LockstepTests, ThreadedRunsMatchSerialRunsBitForBit)
+{
+    // given:
+    using namespace m6502;
+    constexpr u32 NUM_CPUS = 4;
+    LoadRelayPrograms(NUM_CPUS);
+    Mem SerialMem = mem;
+    LockstepSystem Threaded(mem, 37);
+    LockstepSystem Serial(SerialMem, 37);
+    for (u32 Index = 0; Index < NUM_CPUS; Index++)
+    {
+        Threaded.Add(CPUAt((Word)((0x10 + Index) << 8)));
+        Serial.Add(CPUAt((Word)((0x10 + Index) << 8)));
+    }
+
+    // when:
+    Threaded.Run(500);
+    Serial.RunSerial(500);
+
+    // then:
+    EXPECT_EQ(memcmp(mem.Data, SerialMem.Data, Mem::MAX_MEM), 0);
+    EXPECT_EQ(mem[0x20 + NUM_CPUS], 0x5A);
+    for (u32 Index = 0; Index < NUM_CPUS; Index++)
+    {
+        const CPU& A = Threaded.Cpus[Index];
+        const CPU& B = Serial.Cpus[Index];
+        EXPECT_EQ(A.PC, B.PC);
+        EXPECT_EQ(A.A, B.A);
+        EXPECT_EQ(A.X, B.X);
+        EXPECT_EQ(A.PS, B.PS);
+        EXPECT_EQ(Threaded.Carry[Index], Serial.Carry[Index]);
+    }
+}
+
+TEST_F(M6502LockstepTests, ThreadedRunsMatchTheNaiveReference)
+{
+    // given:
+    using namespace m6502;
+    constexpr u32 NUM_CPUS = 4;
+    LoadRelayPrograms(NUM_CPUS);
+    // CPU 3 also sweeps a whole page, over the bytes the others write
+    const Byte Sweep[] =
+    {
+        CPU::INS_LDA_ZP, 0x20,
+        CPU::INS_LDX_IM, 0x00,
+        CPU::INS_STA_ABSX, 0x00, 0x30,
+        CPU::INS_LDY_ABSX, 0x00, 0x31,  // Y = X + 1
+        CPU::INS_STA_ABSY, 0x00, 0x30,
+        CPU::INS_LDX_ABSY, 0x00, 0x31,  // X = Y + 1
+        CPU::INS_JMP_ABS, 0x04, 0x18,
+    };
+    mem.Load(0x1800, Sweep, sizeof(Sweep));
+    Mem ReferenceMem = mem;
+    LockstepSystem Threaded(mem, 37);
+    std::vector<CPU> Reference;
+    for (u32 Index = 0; Index < NUM_CPUS; Index++)
+    {
+        const Word Start = Index == NUM_CPUS - 1 ? 0x1800 : (Word)((0x10 + Index) << 8);
+        Threaded.Add(CPUAt(Start));
+        Reference.push_back(CPUAt(Start));
+        Reference.back().ThrowOnIllegalOpcode = false;
+    }
+    for (u32 i = 0; i < 0x100; i++)
+    {
+        mem[0x3100 + i] = ReferenceMem[0x3100 + i] = (Byte)(i + 1);
+    }
+
+    // when:
+    Threaded.Run(500);
+    RunReference(ReferenceMem, Reference, 37, 500);
+
+    // then:
+    EXPECT_EQ(memcmp(mem.Data, ReferenceMem.Data, Mem::MAX_MEM), 0);
+    for (u32 Index = 0; Index < NUM_CPUS; Index++)
+    {
+        const CPU& A = Threaded.Cpus[Index];
+        const CPU& B = Reference[Index];
+        EXPECT_EQ(A.PC, B.PC);
+        EXPECT_EQ(A.A, B.A);
+        EXPECT_EQ(A.X, B.X);
+        EXPECT_EQ(A.PS, B.PS);
+    }
+}
+
+TEST_F(M6502LockstepTests, AJammedCPUDoesNotHoldTheOthersUp)
+{
+    // given:
+    using namespace m6502;
+    const Byte Writer[] = { CPU::INS_LDA_IM, 0x77, CPU::INS_STA_ZP, 0x10, CPU::INS_JMP_ABS, 0x04, 0x02 };
+    mem.Load(0x0200, Writer, sizeof(Writer));
+    mem[0x0400] = 0x02;
+    LockstepSystem System(mem, 100);
+    System.Add(CPUAt(0x0200));
+    System.Add(CPUAt(0x0400));
+
+    // when:
+    System.Run(2);
+
+    // then:
+    EXPECT_TRUE(System.Cpus[1].Jammed);
+    EXPECT_EQ(mem[0x10], 0x77);
+}
@@ -0,0 +1,149 @@
+#include <memory>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_memdiff.h"
+
+class M6502MemDiffTests : public testing::Test
+{
+public:
+    std::unique_ptr<m6502::Mem> A = std::make_unique<m6502::Mem>();
+    std::unique_ptr<m6502::Mem> B = std::make_unique<m6502::Mem>();
+
+    virtual void SetUp()
+    {
+        A->Initialise();
+        B->Initialise();
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    // Every kernel this machine can run
+    std::vector<m6502::MemDiff::Kernel> Kernels() const
+    {
+        using Kernel = m6502::MemDiff::Kernel;
+        std::vector<Kernel> Supported = { Kernel::Scalar };
+        if (m6502::MemDiff::Best() >= Kernel::SSE2)
+        {
+            Supported.push_back(Kernel::SSE2);
+        }
+        if (m6502::MemDiff::Best() == Kernel::AVX2)
+        {
+            Supported.push_back(Kernel::AVX2);
+        }
+        return Supported;
+    }
+
+    // The byte loop the kernels replace
+    static std::vector<m6502::MemDiff::Range> Reference(const m6502::Mem& A, const m6502::Mem& B)
+    {
+        std::vector<m6502::MemDiff::Range> Result;
+        for (m6502::u32 i = 0; i < m6502::Mem::MAX_MEM; i++)
+        {
+            if (A.Data[i] == B.Data[i])
+            {
+                continue;
+            }
+            if (!Result.empty() && Result.back().Start + Result.back().Length == i)
+            {
+                Result.back().Length++;
+            }
+            else
+            {
+                Result.push_back({ (m6502::Word)i, 1 });
+            }
+        }
+        return Result;
+    }
+
+    static void ExpectSameRanges(const std::vector<m6502::MemDiff::Range>& Actual, const std::vector<m6502::MemDiff::Range>& Expected)
+    {
+        ASSERT_EQ(Actual.size(), Expected.size());
+        for (size_t i = 0; i < Actual.size(); i++)
+        {
+            EXPECT_EQ(Actual[i].Start, Expected[i].Start) << "range " << i;
+            EXPECT_EQ(Actual[i].Length, Expected[i].Length) << "range " << i;
+        }
+    }
+};
+
+TEST_F(M6502MemDiffTests, IdenticalImagesHaveNoDifferences)
+{
+    // given:
+    using namespace m6502;
+    A->Data[0x1234] = B->Data[0x1234] = 0x42;
+
+    for (MemDiff::Kernel Use : Kernels())
+    {
+        // when:
+        u64 Changed[MemDiff::BITMAP_WORDS];
+        MemDiff::Pages(*A, *B, Changed, nullptr, Use);
+
+        // then:
+        EXPECT_TRUE(MemDiff::Ranges(*A, *B, nullptr, Use).empty());
+        for (u64 Bits : Changed)
+        {
+            EXPECT_EQ(Bits, 0u);
+        }
+    }
+}
+
+TEST_F(M6502MemDiffTests, RangesMatchTheByteLoopForEveryKernel)
+{
+    // given:
+    using namespace m6502;
+    std::mt19937 Random(6502);
+    for (int i = 0; i < 2000; i++)
+    {
+        B->Data[Random() % Mem::MAX_MEM] ^= (Byte)(1 + Random() % 255);
+    }
+    // Runs across a page boundary, a 64 byte word boundary and the end of memory
+    for (u32 Address = 0x30F0; Address < 0x3110; Address++)
+    {
+        B->Data[Address] = ~A->Data[Address];
+    }
+    for (u32 Address = 0x403E; Address < 0x4042; Address++)
+    {
+        B->Data[Address] = ~A->Data[Address];
+    }
+    B->Data[0xFFFF] = ~A->Data[0xFFFF];
+    const std::vector<MemDiff::Range> Expected = Reference(*A, *B);
+
+    for (MemDiff::Kernel Use : Kernels())
+    {
+        // when:
+        const std::vector<MemDiff::Range> Actual = MemDiff::Ranges(*A, *B, nullptr, Use);
+
+        // then:
+        ExpectSameRanges(Actual, Expected);
+    }
+}
+
+TEST_F(M6502MemDiffTests, PagesCanBeRestrictedToDirtyPages)
+{
+    // given:
+    using namespace m6502;
+    B->Data[0x0010] = 1;
+    B->Data[0x2000] = 1;
+    B->Data[0x20FF] = 1;
+    B->MarkDirty(0x2000);
+
+    for (MemDiff::Kernel Use : Kernels())
+    {
+        // when:
+        u64 All[MemDiff::BITMAP_WORDS];
+        u64 Dirty[MemDiff::BITMAP_WORDS];
+        MemDiff::Pages(*A, *B, All, nullptr, Use);
+        MemDiff::Pages(*A, *B, Dirty, B->DirtyPages, Use);
+        const std::vector<MemDiff::Range> DirtyRanges = MemDiff::Ranges(*A, *B, B->DirtyPages, Use);
+
+        // then:
+        EXPECT_EQ(All[0], (1ull << 0x00) | (1ull << 0x20));
+        EXPECT_EQ(Dirty[0], 1ull << 0x20);
+        ExpectSameRanges(DirtyRanges, { { 0x2000, 1 }, { 0x20FF, 1 } });
+    }
+}
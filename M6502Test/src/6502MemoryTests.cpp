@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_mapper.h"
+#include "../../M6502Lib/src/m6502_mempool.h"
+
+class M6502MemoryTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0xFFFC, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+};
+
+TEST_F(M6502MemoryTests, ClearDirtyOnlyZeroesPagesWrittenByTheCPU)
+{
+    // given:
+    using namespace m6502;
+    cpu.A = 0x42;
+    mem[0xFFFC] = CPU::INS_STA_ABS;
+    mem[0xFFFD] = 0x10;
+    mem[0xFFFE] = 0x80;
+    mem[0x4000] = 0x37;
+    cpu.Execute(4, mem);
+
+    // when:
+    mem.ClearDirty();
+
+    // then:
+    EXPECT_EQ(mem[0x8010], 0x00);
+    EXPECT_EQ(mem[0x4000], 0x37);
+    EXPECT_FALSE(mem.IsPageDirty(0x80));
+}
+
+TEST_F(M6502MemoryTests, UxRomWriteSwitchesTheBankAtAddress8000)
+{
+    // given:
+    using namespace m6502;
+    std::vector<Byte> Rom(4 * UxRomMapper::BANK_SIZE);
+    for (u32 Bank = 0; Bank < 4; Bank++)
+    {
+        Rom[Bank * UxRomMapper::BANK_SIZE] = 0x10 + Bank;
+    }
+    UxRomMapper Mapper(Rom);
+    Mapper.Attach(mem);
+    cpu.Reset(0x0200, mem);
+    mem[0x0200] = CPU::INS_LDA_IM;
+    mem[0x0201] = 0x02;
+    mem[0x0202] = CPU::INS_STA_ABS;
+    mem[0x0203] = 0x00;
+    mem[0x0204] = 0x80;
+    mem[0x0205] = CPU::INS_LDX_ABS;
+    mem[0x0206] = 0x00;
+    mem[0x0207] = 0x80;
+    constexpr s32 EXPECTED_CYCLES = 2 + 4 + 4;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(EXPECTED_CYCLES, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, EXPECTED_CYCLES);
+    EXPECT_EQ(cpu.X, 0x12);
+    EXPECT_EQ(Mapper.Bank, 2u);
+    EXPECT_EQ(mem[0xC000], 0x13);
+    EXPECT_EQ(Mapper.Rom[0], 0x10);
+}
+
+TEST_F(M6502MemoryTests, RamBanksKeepTheirContentsWhenSwitchedOut)
+{
+    // given:
+    using namespace m6502;
+    RamBankMapper Mapper(4);
+    Mapper.Attach(mem);
+    cpu.Reset(0x0200, mem);
+    const Byte Program[] =
+    {
+        CPU::INS_LDA_IM, 0x01,
+        CPU::INS_STA_ABS, 0x61, 0x9F,   // bank 1
+        CPU::INS_LDA_IM, 0x42,
+        CPU::INS_STA_ABS, 0x00, 0xA0,
+        CPU::INS_LDA_IM, 0x00,
+        CPU::INS_STA_ABS, 0x61, 0x9F,   // bank 0
+        CPU::INS_LDY_ABS, 0x00, 0xA0,
+    };
+    for (u32 i = 0; i < sizeof(Program); i++)
+    {
+        mem[0x0200 + i] = Program[i];
+    }
+    constexpr s32 EXPECTED_CYCLES = (2 + 4) * 3 + 4;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(EXPECTED_CYCLES, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, EXPECTED_CYCLES);
+    EXPECT_EQ(cpu.Y, 0x00);
+    EXPECT_EQ(Mapper.Ram[RamBankMapper::BANK_SIZE], 0x42);
+    EXPECT_EQ(mem[0x9F61], 0x00);
+}
+
+TEST_F(M6502MemoryTests, UxRomShorterThanABankIsPaddedToOneFixedBank)
+{
+    // given:
+    using namespace m6502;
+    std::vector<Byte> Rom(100, 0xEA);
+
+    // when:
+    UxRomMapper Mapper(Rom);
+    Mapper.Attach(mem);
+
+    // then:
+    EXPECT_EQ(Mapper.NumBanks, 1u);
+    EXPECT_EQ(Mapper.Rom.size(), UxRomMapper::BANK_SIZE);
+    EXPECT_EQ(mem[0x8000], 0xEA);
+    EXPECT_EQ(mem[0xC063], 0xEA);
+    EXPECT_EQ(mem[0xC064], 0x00);
+}
+
+TEST_F(M6502MemoryTests, RamBankMapperRejectsBadBankCountsAndRegisters)
+{
+    using namespace m6502;
+    EXPECT_THROW(RamBankMapper(0), std::invalid_argument);
+    EXPECT_THROW(RamBankMapper(257), std::invalid_argument);
+    EXPECT_THROW(RamBankMapper(4, 0xA123), std::invalid_argument);
+    EXPECT_NO_THROW(RamBankMapper(256));
+}
+
+TEST_F(M6502MemoryTests, CopyingMemRebindsTheFlatWindowsToTheCopy)
+{
+    // given:
+    using namespace m6502;
+    mem[0x1234] = 0x42;
+
+    // when:
+    Mem Copy = mem;
+    Copy[0x1234] = 0x37;
+
+    // then:
+    EXPECT_EQ(mem[0x1234], 0x42);
+    EXPECT_EQ(Copy[0x1234], 0x37);
+}
+
+TEST_F(M6502MemoryTests, MemPoolRecyclesImagesWithTheirDirtyPagesCleared)
+{
+    // given:
+    using namespace m6502;
+    MemPool Pool(2);
+    Mem* Image = Pool.Acquire();
+    const Byte Program[] = { CPU::INS_LDA_IM, 0x42, CPU::INS_STA_ABS, 0x00, 0x80 };
+    Image->Load(0x0200, Program, sizeof(Program));
+    cpu.PC = 0x0200;
+    cpu.Execute(2 + 4, *Image);
+    ASSERT_EQ((*Image)[0x8000], 0x42);
+
+    // when:
+    Pool.Release(Image);
+    Mem* Recycled = Pool.Acquire();
+
+    // then:
+    EXPECT_EQ(Recycled, Image);
+    EXPECT_EQ((*Recycled)[0x8000], 0x00);
+    EXPECT_EQ((*Recycled)[0x0202], 0x00);
+    EXPECT_EQ((u64)Recycled % MemPool::SLOT_ALIGNMENT, 0u);
+}
+
+TEST_F(M6502MemoryTests, MemPoolReturnsNullWhenExhausted)
+{
+    // given:
+    using namespace m6502;
+    MemPool Pool(2);
+
+    // when:
+    Mem* First = Pool.Acquire();
+    Mem* Second = Pool.Acquire();
+    Mem* Third = Pool.Acquire();
+
+    // then:
+    EXPECT_NE(First, nullptr);
+    EXPECT_NE(Second, nullptr);
+    EXPECT_NE(First, Second);
+    EXPECT_EQ(Third, nullptr);
+    EXPECT_EQ(Pool.NumFree(), 0u);
+}
+
+#ifdef M6502_STATE_HASH
+TEST_F(M6502MemoryTests, StateHashIsKeptUpToDateByCPUWrites)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] =
+    {
+        CPU::INS_LDA_IM, 0x42,
+        CPU::INS_STA_ABS, 0x00, 0x80,
+        CPU::INS_JSR, 0x00, 0x90,
+    };
+    mem.Load(0x0200, Program, sizeof(Program));
+    cpu.PC = 0x0200;
+
+    // when:
+    cpu.Execute(2 + 4 + 6, mem);
+
+    // then:
+    const u64 Incremental = mem.Hash;
+    mem.RecomputeHash();
+    EXPECT_NE(Incremental, 0u);
+    EXPECT_EQ(Incremental, mem.Hash);
+}
+
+TEST_F(M6502MemoryTests, StateHashMatchesForEqualStatesReachedDifferently)
+{
+    // given:
+    using namespace m6502;
+    Mem Other;
+    Other.Initialise();
+    CPU OtherCPU = cpu;
+    const Byte First[] = { CPU::INS_LDA_IM, 0x37, CPU::INS_STA_ZP, 0x10, CPU::INS_LDA_IM, 0x42 };
+    const Byte Second[] = { CPU::INS_LDA_IM, 0x37, CPU::INS_STA_ZP, 0x10, CPU::INS_LDA_IM, 0x42 };
+    mem.Load(0x0200, First, sizeof(First));
+    Other.Load(0x0200, Second, sizeof(Second));
+    cpu.PC = OtherCPU.PC = 0x0200;
+
+    // when:
+    cpu.Execute(2 + 3 + 2, mem);
+    OtherCPU.Execute(2, Other);
+    const u64 Midway = OtherCPU.StateHash(Other);
+    OtherCPU.Execute(3 + 2, Other);
+
+    // then:
+    EXPECT_EQ(cpu.StateHash(mem), OtherCPU.StateHash(Other));
+    EXPECT_NE(Midway, OtherCPU.StateHash(Other));
+}
+#endif
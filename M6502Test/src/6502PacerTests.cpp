@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include "../../M6502Lib/src/m6502_pacer.h"
+
+class M6502PacerTests : public testing::Test
+{
+public:
+    std::vector<m6502::Mem> Memories;
+    m6502::Pacer pacer;
+
+    // Adds machines spinning on a JMP to themselves
+    void AddSpinners(m6502::u32 Count, double Hz)
+    {
+        using namespace m6502;
+        const Byte Program[] = { CPU::INS_JMP_ABS, 0x00, 0x02 };
+        Memories.resize(Count);
+        for (Mem& memory : Memories)
+        {
+            CPU cpu;
+            cpu.Reset(0x0200, memory);
+            memory.Load(0x0200, Program, sizeof(Program));
+            pacer.Add(cpu, memory, Hz);
+        }
+    }
+};
+
+TEST_F(M6502PacerTests, MachinesRunAtTheirClockRate)
+{
+    // given:
+    using namespace m6502;
+    using namespace std::chrono;
+    AddSpinners(2, Pacer::APPLE_II_HZ);
+    pacer.Machines[1].Hz = Pacer::NES_NTSC_HZ;
+
+    // when:
+    pacer.RunFor(milliseconds(200));
+
+    // then:
+    const double Slack = duration<double>(Pacer::MAX_PERIOD).count() * 2;
+    EXPECT_NEAR(pacer.Drift(0), 0, Slack);
+    EXPECT_NEAR(pacer.Drift(1), 0, Slack);
+    EXPECT_GT(pacer.Machines[1].Cycles, pacer.Machines[0].Cycles);
+    EXPECT_EQ(pacer.Machines[0].DroppedCycles, 0u);
+    EXPECT_GT(pacer.Wakeups, 0u);
+}
+
+TEST_F(M6502PacerTests, StallsLongerThanMaxCatchUpDropCycles)
+{
+    // given:
+    using namespace m6502;
+    using namespace std::chrono;
+    AddSpinners(1, Pacer::APPLE_II_HZ);
+    pacer.MaxCatchUp = milliseconds(10);
+    pacer.RunFor(milliseconds(20));
+
+    // when:
+    std::this_thread::sleep_for(milliseconds(100));
+    pacer.RunFor(milliseconds(20));
+
+    // then:
+    const u64 Stall = (u64)(0.08 * Pacer::APPLE_II_HZ);
+    EXPECT_GT(pacer.Machines[0].DroppedCycles, Stall);
+    EXPECT_NEAR(pacer.Drift(0), 0, duration<double>(Pacer::MAX_PERIOD).count() * 2);
+}
+
+TEST_F(M6502PacerTests, HundredsOfMachinesAllAdvance)
+{
+    // given:
+    using namespace m6502;
+    using namespace std::chrono;
+    AddSpinners(300, Pacer::APPLE_II_HZ);
+
+    // when:
+    pacer.RunFor(milliseconds(50));
+
+    // then:
+    for (const Pacer::Machine& M : pacer.Machines)
+    {
+        EXPECT_GT(M.Cycles, 0u);
+        EXPECT_EQ(M.Cpu.PC, 0x0200);
+    }
+    EXPECT_GT(pacer.Utilisation(), 0);
+    EXPECT_LE(pacer.Utilisation(), 1);
+}
+
+TEST_F(M6502PacerTests, ReportCoversEveryWakeup)
+{
+    // given:
+    using namespace m6502;
+    using namespace std::chrono;
+    AddSpinners(1, Pacer::APPLE_II_HZ);
+
+    // when:
+    pacer.RunFor(milliseconds(20));
+    std::ostringstream Report;
+    pacer.WriteReport(Report);
+
+    // then:
+    u64 Bucketed = 0;
+    for (u64 Count : pacer.Lateness)
+    {
+        Bucketed += Count;
+    }
+    EXPECT_EQ(Bucketed, pacer.Wakeups);
+    EXPECT_NE(Report.str().find("utilisation"), std::string::npos);
+}
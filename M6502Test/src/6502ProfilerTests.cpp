@@ -0,0 +1,116 @@
+#include <sstream>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_profiler.h"
+
+class M6502ProfilerTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0x0200, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+};
+
+TEST_F(M6502ProfilerTests, ParsesViceLabels)
+{
+    // given:
+    using namespace m6502;
+    std::istringstream Input("al C:0810 .main\nal 0900 .draw\nbreak 0810\n");
+    SymbolTable Symbols;
+
+    // when:
+    Symbols.ParseViceLabels(Input);
+
+    // then:
+    EXPECT_EQ(Symbols.Labels.size(), 2u);
+    EXPECT_EQ(Symbols.Name(0x0810), "main");
+    EXPECT_EQ(Symbols.Name(0x08FF), "main");
+    EXPECT_EQ(Symbols.Name(0x0905), "draw");
+    EXPECT_EQ(Symbols.Name(0x0100), "$0100");
+}
+
+TEST_F(M6502ProfilerTests, ParsesCa65DebugSymbolsButNotEquates)
+{
+    // given:
+    using namespace m6502;
+    std::istringstream Input(
+        "version\tmajor=2,minor=0\n"
+        "sym\tid=0,name=\"main\",addrsize=absolute,scope=0,def=1,val=0x810,seg=0,type=lab\n"
+        "sym\tid=1,name=\"SCREEN_W\",addrsize=zeropage,scope=0,def=2,val=0x28,type=equ\n"
+        "sym\tid=2,name=\"draw\",addrsize=absolute,scope=0,def=3,val=0x900,seg=0,type=lab\n");
+    SymbolTable Symbols;
+
+    // when:
+    Symbols.ParseCa65Dbg(Input);
+
+    // then:
+    EXPECT_EQ(Symbols.Labels.size(), 2u);
+    EXPECT_EQ(Symbols.Name(0x0810), "main");
+    EXPECT_EQ(Symbols.Name(0x0901), "draw");
+}
+
+TEST_F(M6502ProfilerTests, ShadowStackFollowsJSRAndRTS)
+{
+    // given:
+    using namespace m6502;
+    Profiler Prof;
+    Prof.Attach(cpu);
+    mem[0x0200] = CPU::INS_JSR;
+    mem[0x0201] = 0x00;
+    mem[0x0202] = 0x80;
+    mem[0x8000] = CPU::INS_JSR;
+    mem[0x8001] = 0x00;
+    mem[0x8002] = 0x90;
+    mem[0x9000] = CPU::INS_RTS;
+
+    // when:
+    cpu.Execute(6 + 6, mem);
+    const size_t DepthInside = Prof.Stack.size();
+    cpu.Execute(6, mem);
+
+    // then:
+    EXPECT_EQ(DepthInside, 2u);
+    ASSERT_EQ(Prof.Stack.size(), 1u);
+    EXPECT_EQ(Prof.Stack[0].Target, 0x8000);
+    EXPECT_EQ(cpu.PC, 0x8003);
+}
+
+TEST_F(M6502ProfilerTests, WritesFoldedStacksWeightedByCycles)
+{
+    // given:
+    using namespace m6502;
+    // main calls draw forever, draw spins in a load loop
+    mem[0x0200] = CPU::INS_JSR;
+    mem[0x0201] = 0x00;
+    mem[0x0202] = 0x09;
+    mem[0x0900] = CPU::INS_LDA_ABS;
+    mem[0x0901] = 0x00;
+    mem[0x0902] = 0x40;
+    mem[0x0903] = CPU::INS_JMP_ABS;
+    mem[0x0904] = 0x00;
+    mem[0x0905] = 0x09;
+    SymbolTable Symbols;
+    Symbols.Labels[0x0200] = "main";
+    Symbols.Labels[0x0900] = "draw";
+    Profiler Prof(100);
+
+    // when:
+    const s32 Used = Prof.Run(cpu, mem, 10000);
+    std::ostringstream Output;
+    Prof.WriteFolded(Output, Symbols);
+
+    // then:
+    EXPECT_GE(Used, 10000);
+    EXPECT_EQ(Prof.SampledCycles, (u64)Used);
+    EXPECT_EQ(cpu.CallProfiler, &Prof);
+    EXPECT_EQ(Output.str(), "main;draw " + std::to_string(Used) + "\n");
+}
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_scheduler.h"
+
+class M6502SchedulerTests : public testing::Test
+{
+public:
+    std::vector<std::unique_ptr<m6502::Mem>> Memories;
+
+    // A machine spinning on LDA abs; STA zp; JMP, storing its own id
+    m6502::u32 AddMachine(m6502::Scheduler& Sched, m6502::Byte Id)
+    {
+        using namespace m6502;
+        Memories.push_back(std::make_unique<Mem>());
+        Mem& mem = *Memories.back();
+        CPU cpu;
+        cpu.Reset(0x0200, mem);
+        const Byte Program[] = { CPU::INS_LDA_IM, Id, CPU::INS_STA_ZP, 0x10, CPU::INS_JMP_ABS, 0x00, 0x02 };
+        mem.Load(0x0200, Program, sizeof(Program));
+        return Sched.Add(cpu, mem);
+    }
+};
+
+TEST_F(M6502SchedulerTests, ARoundRunsEveryMachineOnce)
+{
+    // given:
+    using namespace m6502;
+    Scheduler Sched;
+    for (Byte Id = 1; Id <= 3; Id++)
+    {
+        AddMachine(Sched, Id);
+    }
+
+    // when:
+    Sched.RunRound();
+
+    // then:
+    for (u32 Machine = 0; Machine < 3; Machine++)
+    {
+        EXPECT_EQ(Sched.Stats[Machine].Slices, 1u);
+        EXPECT_GE(Sched.Stats[Machine].Cycles, (u64)Scheduler::INITIAL_QUANTUM);
+        EXPECT_EQ((*Memories[Machine])[0x0010], Machine + 1);
+    }
+}
+
+TEST_F(M6502SchedulerTests, JammedMachinesAreSkipped)
+{
+    // given:
+    using namespace m6502;
+    Scheduler Sched;
+    AddMachine(Sched, 1);
+    const u32 Jammed = AddMachine(Sched, 2);
+    Sched.Cpus[Jammed].ThrowOnIllegalOpcode = false;
+    (*Memories[Jammed]).Data[0x0200] = 0x02;
+
+    // when:
+    Sched.RunRound();
+    Sched.RunRound();
+
+    // then:
+    EXPECT_EQ(Sched.Stats[0].Slices, 2u);
+    EXPECT_TRUE(Sched.Cpus[Jammed].Jammed);
+    EXPECT_EQ(Sched.Stats[Jammed].Slices, 1u);
+    EXPECT_EQ(Sched.Stats[Jammed].Cycles, 1u);
+}
+
+TEST_F(M6502SchedulerTests, QuantaShrinkToMeetATightLatency)
+{
+    // given:
+    using namespace m6502;
+    Scheduler Sched(std::chrono::nanoseconds(1));
+    AddMachine(Sched, 1);
+    AddMachine(Sched, 2);
+
+    // when:
+    for (int Round = 0; Round < 20; Round++)
+    {
+        Sched.RunRound();
+    }
+
+    // then:
+    EXPECT_EQ(Sched.Quanta[0], Scheduler::MIN_QUANTUM);
+    EXPECT_EQ(Sched.Quanta[1], Scheduler::MIN_QUANTUM);
+    EXPECT_EQ(Sched.Stats[1].Slices, 20u);
+    EXPECT_GT(Sched.Stats[1].MeanDelayMicroseconds(), 0.0);
+    EXPECT_GE(Sched.Stats[1].MaxDelay.count(), 0);
+}
+
+TEST_F(M6502SchedulerTests, QuantaGrowToMeetALooseLatency)
+{
+    // given:
+    using namespace m6502;
+    Scheduler Sched(std::chrono::seconds(10));
+    AddMachine(Sched, 1);
+
+    // when:
+    Sched.RunRound();
+    Sched.RunRound();
+
+    // then:
+    EXPECT_GT(Sched.Quanta[0], Scheduler::INITIAL_QUANTUM);
+    EXPECT_GT(Sched.Stats[0].BusyMHz(), 0.0);
+    EXPECT_GT(Sched.AchievedMHz(0), 0.0);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+#include "../../M6502Lib/src/m6502_shared.h"
+#include "../../M6502Lib/src/m6502_pacer.h"
+
+class M6502SharedTests : public testing::Test
+{
+public:
+    std::string Name;
+
+    virtual void SetUp()
+    {
+        Name = "/m6502test." + std::to_string(getpid()) + "."
+               + testing::UnitTest::GetInstance()->current_test_info()->name();
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+};
+
+TEST_F(M6502SharedTests, ViewSeesTheMachinesWritesWithoutCopies)
+{
+    // given:
+    using namespace m6502;
+    SharedMachine Machine(Name);
+    CPU cpu;
+    cpu.Reset(0xFF00, *Machine.Memory);
+    const Byte Program[] = { CPU::INS_LDA_IM, 0x42, CPU::INS_STA_ABS, 0x34, 0x12 };
+    Machine.Memory->Load(0xFF00, Program, sizeof(Program));
+    SharedMachineView View(Name);
+
+    // when:
+    const s32 Cycles = cpu.Execute(2 + 4, *Machine.Memory);
+    Machine.Publish(cpu, Cycles);
+
+    // then:
+    EXPECT_EQ(View.Data[0x1234], 0x42);
+    EXPECT_EQ(View.Data[0xFF00], CPU::INS_LDA_IM);
+    SharedMachine::Registers Registers;
+    ASSERT_TRUE(View.Read(Registers));
+    EXPECT_EQ(Registers.PC, 0xFF05);
+    EXPECT_EQ(Registers.A, 0x42);
+    EXPECT_EQ(Registers.SP, cpu.SP);
+    EXPECT_EQ(Registers.PS, cpu.PS);
+    EXPECT_FALSE(Registers.Jammed);
+    EXPECT_EQ(Registers.Cycles, 6u);
+    EXPECT_EQ(Registers.Publishes, 1u);
+}
+
+TEST_F(M6502SharedTests, ReadsAreNeverTornByConcurrentPublishes)
+{
+    // given:
+    using namespace m6502;
+    SharedMachine Machine(Name);
+    SharedMachineView View(Name);
+    std::atomic<bool> Done{ false };
+    std::thread Writer([&]
+    {
+        CPU cpu;
+        cpu.PC = 0;
+        cpu.SP = cpu.PS = 0;
+        for (u64 i = 1; i <= 200000; i++)
+        {
+            // Every register and the cycles agree, a torn read would not
+            cpu.A = cpu.X = cpu.Y = (Byte)i;
+            cpu.PC = (Word)i;
+            Machine.Publish(cpu, i);
+        }
+        Done = true;
+    });
+
+    // when:
+    u64 Reads = 0, Failures = 0;
+    SharedMachine::Registers Registers;
+    while (!Done)
+    {
+        if (!View.Read(Registers))
+        {
+            continue;
+        }
+        Reads++;
+        Failures += Registers.A != (Byte)Registers.Cycles || Registers.X != Registers.A || Registers.Y != Registers.A
+                    || Registers.PC != (Word)Registers.Cycles || Registers.Publishes != Registers.Cycles;
+    }
+    Writer.join();
+
+    // then:
+    EXPECT_GT(Reads, 0u);
+    EXPECT_EQ(Failures, 0u);
+    ASSERT_TRUE(View.Read(Registers));
+    EXPECT_EQ(Registers.Cycles, 200000u);
+}
+
+TEST_F(M6502SharedTests, SegmentsAreRemovedWithTheirOwner)
+{
+    // given:
+    using namespace m6502;
+    {
+        SharedMachine Machine(Name);
+        EXPECT_THROW(SharedMachine Again(Name), std::system_error);
+    }
+
+    // when:
+    // then:
+    EXPECT_THROW(SharedMachineView View(Name), std::system_error);
+}
+
+TEST_F(M6502SharedTests, PacerPublishesAfterEverySlice)
+{
+    // given:
+    using namespace m6502;
+    SharedMachine Machine(Name);
+    CPU cpu;
+    cpu.Reset(0x0200, *Machine.Memory);
+    const Byte Program[] = { CPU::INS_JMP_ABS, 0x00, 0x02 };
+    Machine.Memory->Load(0x0200, Program, sizeof(Program));
+    Pacer pacer;
+    pacer.Machines[pacer.Add(cpu, *Machine.Memory, Pacer::APPLE_II_HZ)].Export = &Machine;
+    SharedMachineView View(Name);
+
+    // when:
+    pacer.RunFor(std::chrono::milliseconds(20));
+
+    // then:
+    SharedMachine::Registers Registers;
+    ASSERT_TRUE(View.Read(Registers));
+    EXPECT_EQ(Registers.Cycles, pacer.Machines[0].Cycles);
+    EXPECT_EQ(Registers.PC, 0x0200);
+    EXPECT_EQ(Registers.Publishes, pacer.Wakeups);
+}
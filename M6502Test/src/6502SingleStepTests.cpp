@@ -0,0 +1,100 @@
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502ProcessorTests/src/single_step.h"
+
+class M6502SingleStepTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        mem.Initialise();
+        cpu.ThrowOnIllegalOpcode = false;
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    static std::string ReadFixture(const char* Name)
+    {
+        std::ifstream File(std::string(M6502_TEST_FIXTURES) + "/" + Name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+    }
+
+    // @return the name and the failure of each case, as the runner sees them
+    std::vector<std::pair<std::string, std::string>> RunAll(const std::string& Json, bool& Ok)
+    {
+        using namespace m6502tests;
+        std::vector<std::pair<std::string, std::string>> Results;
+        JsonCursor Cursor(Json.data(), Json.data() + Json.size());
+        TestCase Case;
+        Cursor.Expect('[');
+        while (Cursor.Ok && ParseCase(Cursor, Case))
+        {
+            Results.push_back({ std::string(Case.Name), RunCase(Case, cpu, mem, false) });
+        }
+        Ok = Cursor.Ok;
+        return Results;
+    }
+};
+
+TEST_F(M6502SingleStepTests, FixtureCasesPassOrFailForTheRightReason)
+{
+    // given:
+    const std::string Json = ReadFixture("single_step.json");
+    ASSERT_FALSE(Json.empty());
+
+    // when:
+    bool Ok = false;
+    const auto Results = RunAll(Json, Ok);
+
+    // then:
+    EXPECT_TRUE(Ok);
+    ASSERT_EQ(Results.size(), 5u);
+    EXPECT_EQ(Results[0].first, "a9 42 pass");
+    EXPECT_EQ(Results[0].second, "");
+    EXPECT_EQ(Results[1].first, "85 10 pass");
+    EXPECT_EQ(Results[1].second, "");
+    EXPECT_EQ(Results[2].second.rfind("registers ", 0), 0u) << Results[2].second;
+    EXPECT_EQ(Results[3].second, "cycles 2, expected 3");
+    EXPECT_EQ(Results[4].second, "bus cycle 2: 0010 42 write, expected 0010 42 read");
+}
+
+TEST_F(M6502SingleStepTests, CasesLeaveMemoryAsTheyFoundIt)
+{
+    // given:
+    const std::string Json = ReadFixture("single_step.json");
+
+    // when:
+    bool Ok = false;
+    RunAll(Json, Ok);
+
+    // then:
+    for (m6502::u32 Address = 0; Address < m6502::Mem::MAX_MEM; Address++)
+    {
+        ASSERT_EQ(mem[Address], 0) << Address;
+    }
+}
+
+TEST_F(M6502SingleStepTests, TruncatedFilesAreParseErrors)
+{
+    // given:
+    std::string Json = ReadFixture("single_step.json");
+    Json.resize(Json.find("\"final\""));
+
+    // when:
+    bool Ok = true;
+    const auto Results = RunAll(Json, Ok);
+
+    // then:
+    EXPECT_FALSE(Ok);
+    EXPECT_TRUE(Results.empty());
+}
@@ -121,6 +121,27 @@ TEST_F(M6502StoreRegisterTests, STYZeroPageXCanStoreTheARegisterIntoMemory)
     TestStoreRegisterZeroPageX(CPU::INS_STY_ZPX, &CPU::Y);
 }
 
+TEST_F(M6502StoreRegisterTests, STXZeroPageYCanStoreTheXRegisterIntoMemory)
+{
+    // given:
+    using namespace m6502;
+    cpu.X = 0x42;
+    cpu.Y = 0x0F;
+    mem[0xFFFC] = CPU::INS_STX_ZPY;
+    mem[0xFFFD] = 0x80;
+    mem[0x008F] = 0x00;
+    constexpr s32 EXPECTED_CYCLES = 4;
+    CPU CPUCopy = cpu;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(EXPECTED_CYCLES, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, EXPECTED_CYCLES);
+    EXPECT_EQ(mem[0x008F], 0x42);
+    VerifyUnmodifiedFlagsFromStoreRegister(cpu, CPUCopy);
+}
+
 TEST_F(M6502StoreRegisterTests, STAAbsoluteCanStoreTheARegisterIntoMemory)
 {
     using namespace m6502;
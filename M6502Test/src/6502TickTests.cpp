@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+
+class M6502TickTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0xFF00, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    // @return the ticks until the CPU is back on an instruction boundary
+    m6502::u32 TickToBoundary()
+    {
+        m6502::u32 Ticks = 0;
+        do
+        {
+            cpu.Tick(mem);
+            Ticks++;
+        } while (!cpu.AtInstructionBoundary());
+        return Ticks;
+    }
+};
+
+TEST_F(M6502TickTests, EachInstructionTakesAsManyTicksAsExecuteCycles)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] =
+    {
+        CPU::INS_LDA_IM, 0x42,
+        CPU::INS_STA_ABS, 0x00, 0x40,
+        CPU::INS_LDX_IM, 0x10,
+        CPU::INS_LDA_ABSX, 0xF8, 0x40,   // Crosses a page
+        CPU::INS_JSR, 0x00, 0x80,
+    };
+    mem.Load(0xFF00, Program, sizeof(Program));
+
+    // when:
+    const u32 Lda = TickToBoundary();
+    const u32 Sta = TickToBoundary();
+    const u32 Ldx = TickToBoundary();
+    const u32 LdaAbsX = TickToBoundary();
+    const u32 Jsr = TickToBoundary();
+
+    // then:
+    EXPECT_EQ(Lda, 2u);
+    EXPECT_EQ(Sta, 4u);
+    EXPECT_EQ(Ldx, 2u);
+    EXPECT_EQ(LdaAbsX, 5u);
+    EXPECT_EQ(Jsr, 6u);
+    EXPECT_EQ(mem[0x4000], 0x42);
+    EXPECT_EQ(cpu.PC, 0x8000);
+}
+
+TEST_F(M6502TickTests, AStoreLandsOnItsLastTick)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] = { CPU::INS_LDA_IM, 0x42, CPU::INS_STA_ABS, 0x00, 0x40 };
+    mem.Load(0xFF00, Program, sizeof(Program));
+    TickToBoundary();
+
+    // when:
+    Word PCs[3];
+    Byte Stored[3];
+    for (u32 i = 0; i < 3; i++)
+    {
+        cpu.Tick(mem);
+        PCs[i] = cpu.PC;
+        Stored[i] = mem[0x4000];
+    }
+    cpu.Tick(mem);
+
+    // then:
+    EXPECT_EQ(PCs[0], 0xFF03);
+    EXPECT_EQ(PCs[1], 0xFF04);
+    EXPECT_EQ(PCs[2], 0xFF05);
+    EXPECT_EQ(Stored[0], 0);
+    EXPECT_EQ(Stored[1], 0);
+    EXPECT_EQ(Stored[2], 0);
+    EXPECT_EQ(mem[0x4000], 0x42);
+    EXPECT_EQ(cpu.Bus.Address, 0x4000);
+    EXPECT_EQ(cpu.Bus.Data, 0x42);
+    EXPECT_TRUE(cpu.Bus.Write);
+    EXPECT_TRUE(cpu.AtInstructionBoundary());
+}
+
+TEST_F(M6502TickTests, AnOperandChangedBetweenTicksIsSeen)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] = { CPU::INS_LDA_ABS, 0x00, 0x40 };
+    mem.Load(0xFF00, Program, sizeof(Program));
+    mem[0x4000] = 0x11;
+    mem[0x5000] = 0x77;
+    cpu.Tick(mem);
+    cpu.Tick(mem);
+
+    // when:
+    mem[0xFF02] = 0x50;
+    TickToBoundary();
+
+    // then:
+    EXPECT_EQ(cpu.A, 0x77);
+}
+
+TEST_F(M6502TickTests, TheBusShowsEveryCycleIncludingDummyReads)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] =
+    {
+        CPU::INS_LDX_IM, 0x10,
+        CPU::INS_LDA_ABSX, 0xF8, 0x40,   // Crosses a page
+        CPU::INS_JSR, 0x00, 0x80,
+    };
+    mem.Load(0xFF00, Program, sizeof(Program));
+    mem[0x4108] = 0x99;
+    TickToBoundary();
+    const CPU::BusCycle Expected[] =
+    {
+        { 0xFF02, CPU::INS_LDA_ABSX, false },
+        { 0xFF03, 0xF8, false },
+        { 0xFF04, 0x40, false },
+        { 0x4008, 0x00, false },    // The address before the high byte is fixed
+        { 0x4108, 0x99, false },
+        { 0xFF05, CPU::INS_JSR, false },
+        { 0xFF06, 0x00, false },
+        { 0x01FF, 0x00, false },    // The stack, while the CPU is busy
+        { 0x01FF, 0xFF, true },
+        { 0x01FE, 0x07, true },
+        { 0xFF07, 0x80, false },
+    };
+
+    // when:
+    std::vector<CPU::BusCycle> Cycles;
+    for (u32 i = 0; i < std::size(Expected); i++)
+    {
+        cpu.Tick(mem);
+        Cycles.push_back(cpu.Bus);
+    }
+
+    // then:
+    for (u32 i = 0; i < std::size(Expected); i++)
+    {
+        EXPECT_EQ(Cycles[i].Address, Expected[i].Address) << "cycle " << i;
+        EXPECT_EQ(Cycles[i].Data, Expected[i].Data) << "cycle " << i;
+        EXPECT_EQ(Cycles[i].Write, Expected[i].Write) << "cycle " << i;
+    }
+    EXPECT_EQ(cpu.A, 0x99);
+    EXPECT_EQ(cpu.PC, 0x8000);
+    EXPECT_TRUE(cpu.AtInstructionBoundary());
+}
+
+TEST_F(M6502TickTests, TickingMatchesExecuteOverALoop)
+{
+    // given:
+    using namespace m6502;
+    const Byte Program[] =
+    {
+        CPU::INS_LDX_ZP, 0x10,
+        CPU::INS_STX_ZP, 0x11,
+        CPU::INS_LDA_ABSX, 0xF0, 0x40,
+        CPU::INS_STA_ZPX, 0x20,
+        CPU::INS_LDY_ZPX, 0x20,
+        CPU::INS_STY_ZP, 0x10,
+        CPU::INS_JMP_ABS, 0x00, 0xFF,
+    };
+    mem.Load(0xFF00, Program, sizeof(Program));
+    mem[0x4100] = 0x33;
+    mem[0x10] = 0x20;
+    Mem Reference = mem;
+    CPU Stepped = cpu;
+
+    // when:
+    const s32 Cycles = Stepped.Execute(10000, Reference);
+    for (s32 i = 0; i < Cycles; i++)
+    {
+        cpu.Tick(mem);
+    }
+
+    // then:
+    EXPECT_TRUE(cpu.AtInstructionBoundary());
+    EXPECT_EQ(cpu.PC, Stepped.PC);
+    EXPECT_EQ(cpu.A, Stepped.A);
+    EXPECT_EQ(cpu.X, Stepped.X);
+    EXPECT_EQ(cpu.Y, Stepped.Y);
+    EXPECT_EQ(cpu.PS, Stepped.PS);
+    EXPECT_EQ(memcmp(mem.Data, Reference.Data, Mem::MAX_MEM), 0);
+}
+
+TEST_F(M6502TickTests, AJammedCPUTicksWithoutDoingAnything)
+{
+    // given:
+    using namespace m6502;
+    cpu.ThrowOnIllegalOpcode = false;
+    mem[0xFF00] = 0x02;
+
+    // when:
+    for (u32 i = 0; i < 10; i++)
+    {
+        cpu.Tick(mem);
+    }
+
+    // then:
+    EXPECT_TRUE(cpu.Jammed);
+    EXPECT_EQ(cpu.PC, 0xFF00);
+}
+
+TEST_F(M6502TickTests, AStoppingWriteStopsOnItsOwnCycle)
+{
+    // given:
+    using namespace m6502;
+    struct NullMapper : Mapper
+    {
+        void Write(Mem&, Word, Byte) override {}
+    } Io;
+    mem.MapWindow(0x4000 >> Mem::WINDOW_SHIFT, mem.Data + 0x4000, nullptr);
+    mem.AttachedMapper = &Io;
+    cpu.StopOnMapperWrite = true;
+    const Byte Program[] = { CPU::INS_STA_ABS, 0x00, 0x40, CPU::INS_LDA_IM, 0x01 };
+    mem.Load(0xFF00, Program, sizeof(Program));
+
+    // when:
+    cpu.Tick(mem);
+    cpu.Tick(mem);
+    cpu.Tick(mem);
+    const CPU::StopReason BeforeWrite = cpu.Stopped;
+    cpu.Tick(mem);
+
+    // then:
+    EXPECT_EQ(BeforeWrite, CPU::StopReason::None);
+    EXPECT_EQ(cpu.Stopped, CPU::StopReason::MapperWrite);
+    EXPECT_TRUE(cpu.AtInstructionBoundary());
+    EXPECT_EQ(cpu.StoppedCycles, 0);
+}
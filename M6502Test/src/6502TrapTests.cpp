@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+#include "../../M6502Lib/src/m6502_traps.h"
+
+class M6502TrapTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+    m6502::TrapTable Traps;
+
+    static constexpr m6502::s32 MULTIPLY_CYCLES = 120;
+
+    virtual void SetUp()
+    {
+        using namespace m6502;
+        cpu.Reset(0xFF00, mem);
+        cpu.Traps = &Traps;
+
+        // A * X, low byte in A and high byte in Y
+        Traps.Add(0x8000, [](CPU& cpu, Mem&)
+        {
+            const u32 Product = cpu.A * cpu.X;
+            cpu.A = (Byte)Product;
+            cpu.Y = (Byte)(Product >> 8);
+            return MULTIPLY_CYCLES;
+        });
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    // LDA #A; LDX #X; JSR $8000
+    void LoadMultiplyCall(m6502::Byte A, m6502::Byte X)
+    {
+        using namespace m6502;
+        const Byte Program[] = { CPU::INS_LDA_IM, A, CPU::INS_LDX_IM, X, CPU::INS_JSR, 0x00, 0x80 };
+        mem.Load(0xFF00, Program, sizeof(Program));
+    }
+};
+
+TEST_F(M6502TrapTests, JSRToATrappedAddressRunsTheNativeHandler)
+{
+    // given:
+    using namespace m6502;
+    LoadMultiplyCall(200, 3);
+    mem[0x8000] = 0x02;  // The guest routine would jam
+    const Byte SPBefore = cpu.SP;
+    constexpr s32 EXPECTED_CYCLES = 2 + 2 + 6 + MULTIPLY_CYCLES;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(EXPECTED_CYCLES, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, EXPECTED_CYCLES);
+    EXPECT_EQ(cpu.A, (Byte)600);
+    EXPECT_EQ(cpu.Y, 600 >> 8);
+    EXPECT_EQ(cpu.PC, 0xFF07);
+    EXPECT_EQ(cpu.SP, SPBefore);
+}
+
+TEST_F(M6502TrapTests, RemovedTrapsRunTheGuestRoutineAgain)
+{
+    // given:
+    using namespace m6502;
+    LoadMultiplyCall(2, 3);
+    mem[0x8000] = CPU::INS_LDY_IM;
+    mem[0x8001] = 0x55;
+    Traps.Remove(0x8000);
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(2 + 2 + 6 + 2, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 12);
+    EXPECT_EQ(cpu.A, 2);
+    EXPECT_EQ(cpu.Y, 0x55);
+    EXPECT_EQ(cpu.PC, 0x8002);
+    EXPECT_FALSE(Traps.Contains(0x8000));
+}
+
+TEST_F(M6502TrapTests, HandlersCanWorkOnMemory)
+{
+    // given:
+    using namespace m6502;
+    // Copy X bytes from the page in A to the page in Y
+    Traps.Add(0x9000, [](CPU& cpu, Mem& memory)
+    {
+        for (u32 i = 0; i < cpu.X; i++)
+        {
+            memory.Write((Word)((cpu.Y << 8) + i), memory[(cpu.A << 8) + i]);
+        }
+        return (s32)(cpu.X * 14 + 12);
+    });
+    const Byte Source[] = { 1, 2, 3, 4 };
+    mem.Load(0x3000, Source, sizeof(Source));
+    const Byte Program[] =
+    {
+        CPU::INS_LDA_IM, 0x30,
+        CPU::INS_LDX_IM, 0x04,
+        CPU::INS_LDY_IM, 0x40,
+        CPU::INS_JSR, 0x00, 0x90,
+    };
+    mem.Load(0xFF00, Program, sizeof(Program));
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(2 + 2 + 2 + 6 + 4 * 14 + 12, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 80);
+    EXPECT_EQ(mem[0x4000], 1);
+    EXPECT_EQ(mem[0x4003], 4);
+    EXPECT_EQ(mem[0x4004], 0);
+}
+
+TEST_F(M6502TrapTests, CallToATrappedAddressRunsTheNativeHandler)
+{
+    // given:
+    using namespace m6502;
+    CPU::CallRegisters In;
+    In.A = 16;
+    In.X = 16;
+
+    // when:
+    const CPU::CallResult Result = cpu.Call(0x8000, In, mem);
+
+    // then:
+    EXPECT_TRUE(Result.Returned);
+    EXPECT_EQ(Result.A, 0x00);
+    EXPECT_EQ(Result.Y, 0x01);
+    EXPECT_EQ(Result.Cycles, MULTIPLY_CYCLES);
+    EXPECT_EQ(cpu.PC, 0xFF00);
+}
+
+TEST_F(M6502TrapTests, OnlyJSRIsTrapped)
+{
+    // given:
+    using namespace m6502;
+    mem[0xFF00] = CPU::INS_JMP_ABS;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0x80;
+    mem[0x8000] = CPU::INS_LDY_IM;
+    mem[0x8001] = 0x66;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute(3 + 2, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 5);
+    EXPECT_EQ(cpu.Y, 0x66);
+}
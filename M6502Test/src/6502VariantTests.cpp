@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "../../M6502Lib/src/m6502.h"
+
+class M6502VariantTests : public testing::Test
+{
+public:
+    m6502::Mem mem;
+    m6502::CPU cpu;
+
+    virtual void SetUp()
+    {
+        cpu.Reset(0xFF00, mem);
+    }
+
+    virtual void TearDown()
+    {
+
+    }
+
+    // JMP ($30FF), with different values at $3100 and $3000 for the MSB
+    void SetUpJumpThroughPageBoundary()
+    {
+        using namespace m6502;
+        mem[0xFF00] = CPU::INS_JMP_IND;
+        mem[0xFF01] = 0xFF;
+        mem[0xFF02] = 0x30;
+        mem[0x30FF] = 0x34;
+        mem[0x3100] = 0x12;
+        mem[0x3000] = 0x56;
+    }
+};
+
+TEST_F(M6502VariantTests, NMOSJMPIndirectWrapsWithinTheVectorsPage)
+{
+    // given:
+    using namespace m6502;
+    SetUpJumpThroughPageBoundary();
+
+    // when:
+    const s32 ActualCycles = cpu.Execute<CPUVariant::NMOS6502>(5, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 5);
+    EXPECT_EQ(cpu.PC, 0x5634);
+}
+
+TEST_F(M6502VariantTests, RP2A03JMPIndirectHasTheNMOSBug)
+{
+    // given:
+    using namespace m6502;
+    SetUpJumpThroughPageBoundary();
+
+    // when:
+    const s32 ActualCycles = cpu.Execute<CPUVariant::RP2A03>(5, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 5);
+    EXPECT_EQ(cpu.PC, 0x5634);
+}
+
+TEST_F(M6502VariantTests, CMOSJMPIndirectCrossesThePageInSixCycles)
+{
+    // given:
+    using namespace m6502;
+    SetUpJumpThroughPageBoundary();
+
+    // when:
+    const s32 ActualCycles = cpu.Execute<CPUVariant::CMOS65C02>(6, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 6);
+    EXPECT_EQ(cpu.PC, 0x1234);
+}
+
+TEST_F(M6502VariantTests, CMOSCanLoadAndStoreThroughAZeroPagePointer)
+{
+    // given:
+    using namespace m6502;
+    mem[0xFF00] = CPU::INS_LDA_INDZP;
+    mem[0xFF01] = 0x20;
+    mem[0xFF02] = CPU::INS_STA_INDZP;
+    mem[0xFF03] = 0xFF;
+    mem[0x0020] = 0x00;
+    mem[0x0021] = 0x80;
+    mem[0x8000] = 0x84;
+    // The pointer at $FF wraps to $00 for its MSB
+    mem[0x00FF] = 0x10;
+    mem[0x0000] = 0x40;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute<CPUVariant::CMOS65C02>(5 + 5, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 5 + 5);
+    EXPECT_EQ(cpu.A, 0x84);
+    EXPECT_TRUE(cpu.Flag.N);
+    EXPECT_FALSE(cpu.Flag.Z);
+    EXPECT_EQ(mem[0x4010], 0x84);
+}
+
+TEST_F(M6502VariantTests, CMOSCanStoreZeroInEveryMode)
+{
+    // given:
+    using namespace m6502;
+    cpu.X = 0x02;
+    mem[0xFF00] = CPU::INS_STZ_ZP;
+    mem[0xFF01] = 0x10;
+    mem[0xFF02] = CPU::INS_STZ_ZPX;
+    mem[0xFF03] = 0x10;
+    mem[0xFF04] = CPU::INS_STZ_ABS;
+    mem[0xFF05] = 0x00;
+    mem[0xFF06] = 0x80;
+    mem[0xFF07] = CPU::INS_STZ_ABSX;
+    mem[0xFF08] = 0x00;
+    mem[0xFF09] = 0x80;
+    mem[0x0010] = mem[0x0012] = mem[0x8000] = mem[0x8002] = 0xAA;
+    CPU CPUCopy = cpu;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute<CPUVariant::CMOS65C02>(3 + 4 + 4 + 5, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 3 + 4 + 4 + 5);
+    EXPECT_EQ(mem[0x0010], 0x00);
+    EXPECT_EQ(mem[0x0012], 0x00);
+    EXPECT_EQ(mem[0x8000], 0x00);
+    EXPECT_EQ(mem[0x8002], 0x00);
+    EXPECT_EQ(cpu.PS, CPUCopy.PS);
+}
+
+TEST_F(M6502VariantTests, CMOSCanJumpThroughAnIndexedVector)
+{
+    // given:
+    using namespace m6502;
+    cpu.X = 0x04;
+    mem[0xFF00] = CPU::INS_JMP_ABSX_IND;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0x80;
+    mem[0x8004] = 0x00;
+    mem[0x8005] = 0x90;
+
+    // when:
+    const s32 ActualCycles = cpu.Execute<CPUVariant::CMOS65C02>(6, mem);
+
+    // then:
+    EXPECT_EQ(ActualCycles, 6);
+    EXPECT_EQ(cpu.PC, 0x9000);
+}
+
+TEST_F(M6502VariantTests, CMOSOpcodesAreIllegalOnNMOS)
+{
+    // given:
+    using namespace m6502;
+    cpu.ThrowOnIllegalOpcode = false;
+    mem[0xFF00] = CPU::INS_STZ_ZP;
+    mem[0xFF01] = 0x10;
+
+    // when:
+    cpu.Execute<CPUVariant::NMOS6502>(3, mem);
+
+    // then:
+    EXPECT_TRUE(cpu.Jammed);
+    EXPECT_EQ(cpu.PC, 0xFF00);
+}